@@ -35,6 +35,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <climits>
 #include <cstring>
 
 #include <typeinfo>
@@ -43,15 +44,143 @@
 using namespace std;
 
 
+//--------------------------------------------------------------------------------------------------
+// CAstArena
+//
+thread_local CAstArena* CAstArena::_current = NULL;
+
+CAstArena::CAstArena(size_t blocksize)
+	: _blocksize(blocksize), _top(NULL), _end(NULL), _size(0),
+	  _nodes(NULL), _first(NULL), _numnodes(0)
+{
+}
+
+CAstArena::~CAstArena(void)
+{
+	Reset();
+
+	for (size_t i = 0; i < _blocks.size(); i++) delete [] _blocks[i];
+}
+
+void* CAstArena::Allocate(size_t size)
+{
+	// nodes hold pointers, integers and strings; none requires more than 8-byte alignment
+	const size_t align = 8;
+	size = (size + align - 1) & ~(align - 1);
+
+	if ((size_t)(_end - _top) < size)
+	{
+		// oversized requests get a block of their own; the current block stays in use
+		if (size > _blocksize / 4)
+		{
+			char *b = new char[size];
+			_blocks.push_back(b);
+			_size += size;
+			return b;
+		}
+
+		_top = new char[_blocksize];
+		_end = _top + _blocksize;
+		_blocks.push_back(_top);
+	}
+
+	void *p = _top;
+	_top += size;
+	_size += size;
+	return p;
+}
+
+void CAstArena::Register(CAstNode *node)
+{
+	const size_t n = sizeof(_nodes->node) / sizeof(_nodes->node[0]);
+
+	if ((_nodes == NULL) || (_nodes->count == n))
+	{
+		SNodes *c = static_cast<SNodes*>(Allocate(sizeof(SNodes)));
+		c->prev = _nodes;
+		c->count = 0;
+		if (_nodes == NULL) _first = c;
+		_nodes = c;
+	}
+
+	_nodes->node[_nodes->count++] = node;
+	_numnodes++;
+}
+
+void CAstArena::Merge(CAstArena *arena)
+{
+	assert(arena != this);
+
+	_blocks.insert(_blocks.end(), arena->_blocks.begin(), arena->_blocks.end());
+	_size += arena->_size;
+
+	// the merged nodes are destroyed before our own
+	if (arena->_nodes != NULL)
+	{
+		arena->_first->prev = _nodes;
+		if (_nodes == NULL) _first = arena->_first;
+		_nodes = arena->_nodes;
+		_numnodes += arena->_numnodes;
+	}
+
+	arena->_blocks.clear();
+	arena->_top = arena->_end = NULL;
+	arena->_size = 0;
+	arena->_nodes = arena->_first = NULL;
+	arena->_numnodes = 0;
+}
+
+void CAstArena::Reset(void)
+{
+	// destroy nodes before the memory holding them; nodes do not reference each other on
+	// destruction, the reverse order only mirrors construction
+	for (SNodes *c = _nodes; c != NULL; c = c->prev)
+	{
+		for (size_t i = c->count; i > 0; i--) c->node[i-1]->~CAstNode();
+	}
+
+	// oversized requests never become the current block
+	char *keep = _end != NULL ? _end - _blocksize : NULL;
+	for (size_t i = 0; i < _blocks.size(); i++)
+	{
+		if (_blocks[i] != keep) delete [] _blocks[i];
+	}
+	_blocks.clear();
+	if (keep != NULL) _blocks.push_back(keep);
+
+	_top = keep;
+	_size = 0;
+	_nodes = _first = NULL;
+	_numnodes = 0;
+}
+
+CAstArena* CAstArena::SetCurrent(CAstArena *arena)
+{
+	CAstArena *prev = _current;
+	_current = arena;
+	return prev;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 // CAstNode
 //
-int CAstNode::_global_id = 0;
+atomic<int> CAstNode::_global_id(0);
 
 CAstNode::CAstNode(CToken token)
 	: _token(token), _addr(NULL)
 {
 	_id = _global_id++;
+
+	CAstArena *arena = CAstArena::GetCurrent();
+	if (arena != NULL) arena->Register(this);
+}
+
+void* CAstNode::operator new(size_t size)
+{
+	CAstArena *arena = CAstArena::GetCurrent();
+	if (arena != NULL) return arena->Allocate(size);
+	else return ::operator new(size);
 }
 
 CAstNode::~CAstNode(void)
@@ -120,7 +249,6 @@ CAstScope::CAstScope(CToken t, const string name, CAstScope *parent)
 CAstScope::~CAstScope(void)
 {
 	delete _symtab;
-	delete _statseq;
 	delete _cb;
 }
 
@@ -258,6 +386,14 @@ void CAstScope::toDot(ostream &out, int indent) const
 CTacAddr* CAstScope::ToTac(CCodeBlock *cb)
 {
 	assert(cb != NULL);
+
+	// nodes created while lowering (e.g., DIM/DOFS calls) belong to the module
+	const CAstScope *m = this;
+	while (m->GetParent() != NULL) m = m->GetParent();
+	const CAstModule *module = dynamic_cast<const CAstModule*>(m);
+	CAstArena *prev = CAstArena::GetCurrent();
+	if (module != NULL) CAstArena::SetCurrent(module->GetArena());
+
 	CAstStatement *s = GetStatementSequence();
 	while (s != NULL) {
 		CTacLabel *next = cb->CreateLabel();
@@ -267,6 +403,8 @@ CTacAddr* CAstScope::ToTac(CCodeBlock *cb)
 	}
 
 	cb->CleanupControlFlow();
+
+	CAstArena::SetCurrent(prev);
 	return NULL;
 }
 
@@ -294,6 +432,17 @@ CAstModule::CAstModule(CToken t, const string name)
 	: CAstScope(t, name, NULL)
 {
 	SetSymbolTable(new CSymtab());
+	_arena = new CAstArena();
+}
+
+CAstModule::~CAstModule(void)
+{
+	delete _arena;
+}
+
+CAstArena* CAstModule::GetArena(void) const
+{
+	return _arena;
 }
 
 CSymbol* CAstModule::CreateVar(const string ident, const CType *type)
@@ -373,7 +522,6 @@ CAstStatement::CAstStatement(CToken token)
 
 CAstStatement::~CAstStatement(void)
 {
-	delete _next;
 }
 
 void CAstStatement::SetNext(CAstStatement *next)
@@ -553,7 +701,7 @@ CTacAddr* CAstStatCall::ToTac(CCodeBlock *cb, CTacLabel *next)
 	// Tac for every arg
 	for (int i = nbarg; i>=0; i--){
 		CTacAddr *tacArg = _call->GetArg(i)->ToTac(cb);
-		cb->AddInstr(new CTacInstr(opParam, new CTacConst(i, GetType()), tacArg, nullptr));
+		cb->AddInstr(new CTacInstr(opParam, cb->CreateConst(i, GetType()), tacArg, nullptr));
 	}
 
 	CTacTemp *tactmp = nullptr;
@@ -959,10 +1107,19 @@ CTacAddr* CAstStatWhile::ToTac(CCodeBlock *cb, CTacLabel *next)
 // CAstExpression
 //
 CAstExpression::CAstExpression(CToken t)
-	: CAstNode(t)
+	: CAstNode(t), _type_cache(NULL), _typed(false), _folded(false)
 {
 }
 
+const CType* CAstExpression::GetType(void) const
+{
+	if (!_typed) {
+		_type_cache = ComputeType();
+		_typed = true;
+	}
+	return _type_cache;
+}
+
 void CAstExpression::SetParenthesized(bool parenthesized)
 {
 	_parenthesized = parenthesized;
@@ -973,11 +1130,40 @@ bool CAstExpression::GetParenthesized(void) const
 	return _parenthesized;
 }
 
+const SConstValue& CAstExpression::Fold(void) const
+{
+	if (!_folded) {
+		_fold = ComputeValue();
+		_folded = true;
+	}
+	return _fold;
+}
+
+SConstValue CAstExpression::ComputeValue(void) const
+{
+	SConstValue v = { NULL, 0 };
+	return v;
+}
+
 const CDataInitializer* CAstExpression::Evaluate(void) const
 {
+	const SConstValue &v = Fold();
+
+	if (v.type == NULL) return NULL;
+	if (v.type->IsLongint()) return new CDataInitLongint(v.value);
+	if (v.type->IsInteger()) return new CDataInitInteger((int)v.value);
+	if (v.type->IsBoolean()) return new CDataInitBoolean(v.value != 0);
+	if (v.type->IsChar()) return new CDataInitChar((char)v.value);
 	return NULL;
 }
 
+/// @brief wrap the result of an integer operation to the range of its type
+static long long Wrap(const CType *type, unsigned long long value)
+{
+	if (type->IsInteger()) return (int)value;
+	return (long long)value;
+}
+
 CTacAddr* CAstExpression::ToTac(CCodeBlock *cb)
 {
 	return NULL;
@@ -1132,7 +1318,7 @@ bool CAstBinaryOp::TypeCheck(CToken *t, string *msg) const
 	return true;
 }
 
-const CType* CAstBinaryOp::GetType(void) const
+const CType* CAstBinaryOp::ComputeType(void) const
 {
 //	// binary operators
 //	// dst = src1 op src2
@@ -1170,13 +1356,82 @@ const CType* CAstBinaryOp::GetType(void) const
 	return result;
 }
 
-const CDataInitializer* CAstBinaryOp::Evaluate(void) const
+SConstValue CAstBinaryOp::ComputeValue(void) const
 {
-//	if (GetType()->IsBoolean())	return new CDataInitBoolean((bool) GetData());
+	SConstValue v = { NULL, 0 };
+	const SConstValue &l = _left->Fold();
+	const SConstValue &r = _right->Fold();
 
-	// TODO (phase 3)
+	// types are hash-consed; operands of different types are left to the type checker
+	if ((l.type == NULL) || (l.type != r.type)) return v;
 
-	return NULL;
+	CTypeManager* tm = CTypeManager::Get();
+	bool numeric = l.type->IsInteger() || l.type->IsLongint();
+	unsigned long long a = l.value, b = r.value;
+
+	switch (GetOperation())
+	{
+	case opAdd:
+	case opSub:
+	case opMul:
+	case opDiv:
+		if (!numeric) return v;
+		v.type = l.type;
+		switch (GetOperation())
+		{
+		case opAdd: v.value = Wrap(v.type, a + b); break;
+		case opSub: v.value = Wrap(v.type, a - b); break;
+		case opMul: v.value = Wrap(v.type, a * b); break;
+		default:
+			// division by zero is a run-time error; the minimum of the type divided by -1
+			// overflows (and traps at run time)
+			if ((r.value == 0) ||
+			    ((l.value == (v.type->IsInteger() ? INT_MIN : LLONG_MIN)) && (r.value == -1))) {
+				v.type = NULL;
+				return v;
+			}
+			v.value = Wrap(v.type, l.value / r.value);
+			break;
+		}
+		break;
+
+	case opAnd:
+	case opOr:
+		if (!l.type->IsBoolean()) return v;
+		v.type = tm->GetBool();
+		v.value = GetOperation() == opAnd ? (l.value && r.value) : (l.value || r.value);
+		break;
+
+	case opEqual:
+		v.type = tm->GetBool();
+		v.value = l.value == r.value;
+		break;
+
+	case opNotEqual:
+		v.type = tm->GetBool();
+		v.value = l.value != r.value;
+		break;
+
+	case opLessThan:
+	case opLessEqual:
+	case opBiggerThan:
+	case opBiggerEqual:
+		if (!numeric) return v;
+		v.type = tm->GetBool();
+		switch (GetOperation())
+		{
+		case opLessThan:   v.value = l.value <  r.value; break;
+		case opLessEqual:  v.value = l.value <= r.value; break;
+		case opBiggerThan: v.value = l.value >  r.value; break;
+		default:           v.value = l.value >= r.value; break;
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	return v;
 }
 
 ostream& CAstBinaryOp::print(ostream &out, int indent) const
@@ -1250,12 +1505,12 @@ CTacAddr* CAstBinaryOp::ToTac(CCodeBlock *cb)
 
 	cb->AddInstr(lbl_true);
 	// If true
-	cb->AddInstr(new CTacInstr(opAssign, result, new CTacConst(1, CTypeManager::Get()->GetBool()), nullptr));
+	cb->AddInstr(new CTacInstr(opAssign, result, cb->CreateConst(1, CTypeManager::Get()->GetBool()), nullptr));
 	cb->AddInstr(new CTacInstr(opGoto, lbl_end, nullptr, nullptr));
 
 	cb->AddInstr(lbl_false);
 	// If false
-	cb->AddInstr(new CTacInstr(opAssign, result, new CTacConst(0, CTypeManager::Get()->GetBool()), nullptr));
+	cb->AddInstr(new CTacInstr(opAssign, result, cb->CreateConst(0, CTypeManager::Get()->GetBool()), nullptr));
 	cb->AddInstr(new CTacInstr(opGoto, lbl_end, nullptr, nullptr));			// Useless
 
 	cb->AddInstr(lbl_end);
@@ -1335,7 +1590,7 @@ bool CAstUnaryOp::TypeCheck(CToken *t, string *msg) const
 	return true;
 }
 
-const CType* CAstUnaryOp::GetType(void) const
+const CType* CAstUnaryOp::ComputeType(void) const
 {
 //	// unary operators
 //	// dst = op src1
@@ -1358,20 +1613,32 @@ const CType* CAstUnaryOp::GetType(void) const
 	return result;
 }
 
-const CDataInitializer* CAstUnaryOp::Evaluate(void) const
+SConstValue CAstUnaryOp::ComputeValue(void) const
 {
-	EOperation operati = GetOperation();
-	switch (operati)
+	SConstValue v = _operand->Fold();
+	if (v.type == NULL) return v;
+
+	bool numeric = v.type->IsInteger() || v.type->IsLongint();
+
+	switch (GetOperation())
 	{
 	case opNeg:
-		// We should use FoldNeg
-		return new CDataInitLongint(-reinterpret_cast<long>(GetOperand()));
+		if (!numeric) break;
+		v.value = Wrap(v.type, -(unsigned long long)v.value);
+		return v;
 	case opPos:
-		return new CDataInitLongint(reinterpret_cast<long>(GetOperand()));
-	case opNop:
-		return NULL;
+		if (!numeric) break;
+		return v;
+	case opNot:
+		if (!v.type->IsBoolean()) break;
+		v.value = !v.value;
+		return v;
+	default:
+		break;
 	}
-	return NULL;
+
+	v.type = NULL;
+	return v;
 }
 
 ostream& CAstUnaryOp::print(ostream &out, int indent) const
@@ -1425,7 +1692,7 @@ CTacAddr* CAstUnaryOp::ToTac(CCodeBlock *cb)
 			long long valeur = number->GetValue();
 			if (oper == opNeg)
 				valeur = -valeur;
-			CTacConst* numTac = new CTacConst(valeur, GetType());
+			CTacConst* numTac = cb->CreateConst(valeur, GetType());
 			return numTac;
 		}
 	}
@@ -1438,11 +1705,11 @@ CTacAddr* CAstUnaryOp::ToTac(CCodeBlock *cb)
 		valeur = cb->CreateTemp(type->GetBool());
 
 		cb->AddInstr(ltrue);
-		cb->AddInstr(new CTacInstr(opAssign, valeur, new CTacConst(1, GetType()), NULL));
+		cb->AddInstr(new CTacInstr(opAssign, valeur, cb->CreateConst(1, GetType()), NULL));
 		cb->AddInstr(new CTacInstr(opGoto, lend, NULL, NULL));
 
 		cb->AddInstr(lfalse);
-		cb->AddInstr(new CTacInstr(opAssign, valeur, new CTacConst(0, GetType()), NULL));
+		cb->AddInstr(new CTacInstr(opAssign, valeur, cb->CreateConst(0, GetType()), NULL));
 		cb->AddInstr(lend);
 	}
 	return valeur;
@@ -1507,7 +1774,7 @@ bool CAstSpecialOp::TypeCheck(CToken *t, string *msg) const
 	return true;
 }
 
-const CType* CAstSpecialOp::GetType(void) const
+const CType* CAstSpecialOp::ComputeType(void) const
 {
 //	// special and pointer operations
 //	opAddress,                        ///< reference: dst = &src1
@@ -1651,7 +1918,7 @@ bool CAstFunctionCall::TypeCheck(CToken *t, string *msg) const
 	return true;
 }
 
-const CType* CAstFunctionCall::GetType(void) const
+const CType* CAstFunctionCall::ComputeType(void) const
 {
 	return GetSymbol()->GetDataType();
 }
@@ -1697,7 +1964,7 @@ CTacAddr* CAstFunctionCall::ToTac(CCodeBlock *cb)
 
 	for (int i = n - 1; i >= 0; i--) {
 		CTacAddr *argument = GetArg(i)->ToTac(cb);
-		cb->AddInstr(new CTacInstr(opParam, new CTacConst(i, GetType()), argument, NULL));
+		cb->AddInstr(new CTacInstr(opParam, cb->CreateConst(i, GetType()), argument, NULL));
 	}
 
 	CTacTemp* valeurs = cb->CreateTemp(GetType());
@@ -1710,7 +1977,7 @@ CTacAddr* CAstFunctionCall::ToTac(CCodeBlock *cb, CTacLabel *ltrue, CTacLabel *l
 {
 	CTacAddr* valeur = ToTac(cb);
 
-	cb->AddInstr(new CTacInstr(opEqual, ltrue, valeur, new CTacConst(1, GetType())));
+	cb->AddInstr(new CTacInstr(opEqual, ltrue, valeur, cb->CreateConst(1, GetType())));
 	cb->AddInstr(new CTacInstr(opGoto, lfalse, NULL, NULL));
 
 	return NULL;
@@ -1754,19 +2021,29 @@ bool CAstDesignator::TypeCheck(CToken *t, string *msg) const
 	return true;
 }
 
-const CType* CAstDesignator::GetType(void) const
+const CType* CAstDesignator::ComputeType(void) const
 {
 	return GetSymbol()->GetDataType();
 }
 
-const CDataInitializer* CAstDesignator::Evaluate(void) const
+SConstValue CAstDesignator::ComputeValue(void) const
 {
-//	if (GetType()->IsInt())
-//		return new CDataInitInteger((int)(GetSymbol()->GetData()));
+	SConstValue v = { NULL, 0 };
 
-	// TODO (phase 3)
+	// the initializer of a named constant holds the value folded for its definition. Array
+	// designators have the element type and are never folded.
+	const CDataInitializer *d = _symbol->GetData();
+	if ((_symbol->GetSymbolType() != stConstant) || (d == NULL) ||
+		(GetType() != _symbol->GetDataType())) return v;
 
-	return NULL;
+	if (const CDataInitLongint *l = dynamic_cast<const CDataInitLongint*>(d)) v.value = l->GetData();
+	else if (const CDataInitInteger *i = dynamic_cast<const CDataInitInteger*>(d)) v.value = i->GetData();
+	else if (const CDataInitBoolean *b = dynamic_cast<const CDataInitBoolean*>(d)) v.value = b->GetData();
+	else if (const CDataInitChar *c = dynamic_cast<const CDataInitChar*>(d)) v.value = c->GetData();
+	else return v;
+
+	v.type = GetType();
+	return v;
 }
 
 ostream& CAstDesignator::print(ostream &out, int indent) const
@@ -1800,6 +2077,9 @@ void CAstDesignator::toDot(ostream &out, int indent) const
 
 CTacAddr* CAstDesignator::ToTac(CCodeBlock *cb)
 {
+	// named constants have no storage; use their folded value
+	const SConstValue &v = Fold();
+	if (v.type != NULL) return cb->CreateConst(v.value, v.type);
 
 	return new CTacName(GetSymbol());
 }
@@ -1808,7 +2088,7 @@ CTacAddr* CAstDesignator::ToTac(CCodeBlock *cb, CTacLabel *ltrue, CTacLabel *lfa
 {
 	CTacAddr* valeur = ToTac(cb);
 
-	cb->AddInstr(new CTacInstr(opEqual, ltrue, valeur, new CTacConst(1, GetType())));
+	cb->AddInstr(new CTacInstr(opEqual, ltrue, valeur, cb->CreateConst(1, GetType())));
 	cb->AddInstr(new CTacInstr(opGoto, lfalse, NULL, NULL));
 
 	return NULL;
@@ -1819,7 +2099,7 @@ CTacAddr* CAstDesignator::ToTac(CCodeBlock *cb, CTacLabel *ltrue, CTacLabel *lfa
 // CAstArrayDesignator
 //
 CAstArrayDesignator::CAstArrayDesignator(CToken t, const CSymbol *symbol)
-	: CAstDesignator(t, symbol), _done(false), _offset(NULL)
+	: CAstDesignator(t, symbol), _done(false), _offset(NULL), _dim(NULL), _dofs(NULL)
 {
 }
 
@@ -1829,10 +2109,12 @@ void CAstArrayDesignator::AddIndex(CAstExpression *idx)
 	_idx.push_back(idx);
 }
 
-void CAstArrayDesignator::IndicesComplete(void)
+void CAstArrayDesignator::IndicesComplete(const CSymProc *dim, const CSymProc *dofs)
 {
 	assert(!_done);
 	_done = true;
+	_dim = dim;
+	_dofs = dofs;
 }
 
 unsigned CAstArrayDesignator::GetNIndices(void) const
@@ -1880,7 +2162,7 @@ bool CAstArrayDesignator::TypeCheck(CToken *t, string *msg) const
 	return result;
 }
 
-const CType* CAstArrayDesignator::GetType(void) const
+const CType* CAstArrayDesignator::ComputeType(void) const
 {
 	const CType *type = GetSymbol()->GetDataType();
 	// If it is a pointer, then dereferencing it
@@ -1940,13 +2222,10 @@ void CAstArrayDesignator::toDot(ostream &out, int indent) const
 
 CTacAddr* CAstArrayDesignator::ToTac(CCodeBlock* cb)
 {
-	CSymtab* symbolTable = cb->GetOwner()->GetSymbolTable();
 	CToken t;
 	CTypeManager* typeManager = CTypeManager::Get();
+	assert((_dim != NULL) && (_dofs != NULL));
 
-	const CSymbol* DOFS_SYM = symbolTable->FindSymbol("DOFS");
-
-	const CSymbol* DIM_SYM = symbolTable->FindSymbol("DIM");
 	CAstConstant* DIM_VAL = new CAstConstant(t, typeManager->GetInteger(), 0);
 
 	CAstExpression* indice_Expr = new CAstDesignator(GetToken(), GetSymbol());
@@ -1976,7 +2255,7 @@ CTacAddr* CAstArrayDesignator::ToTac(CCodeBlock* cb)
 		}
 		else
 		{
-			CTacAddr* precedent = new CTacConst(0, GetType());
+			CTacAddr* precedent = cb->CreateConst(0, GetType());
 
 			if (i < GetNIndices()) {
 				precedent = GetIndex(i)->ToTac(cb);
@@ -1989,7 +2268,7 @@ CTacAddr* CAstArrayDesignator::ToTac(CCodeBlock* cb)
 		if (i == count - 1)
 			break;
 
-		CAstFunctionCall* DIM_FUN = new CAstFunctionCall(t, dynamic_cast<const CSymProc*>(DIM_SYM));
+		CAstFunctionCall* DIM_FUN = new CAstFunctionCall(t, _dim);
 
 		DIM_FUN->AddArg(indice_Expr);
 		DIM_VAL = new CAstConstant(t, typeManager->GetInteger(), i + 2);
@@ -2000,12 +2279,12 @@ CTacAddr* CAstArrayDesignator::ToTac(CCodeBlock* cb)
 		cb->AddInstr(new CTacInstr(opMul, suivant, index, tailleEntrees));
 		index = suivant;
 	}
-	CAstFunctionCall* DOFS_FUN = new CAstFunctionCall(t, dynamic_cast<const CSymProc*>(DOFS_SYM));
+	CAstFunctionCall* DOFS_FUN = new CAstFunctionCall(t, _dofs);
 	DOFS_FUN->AddArg(indice_Expr);
 	CTacAddr* ofs = DOFS_FUN->ToTac(cb);
 
 	CTacTemp* temporaire = cb->CreateTemp(typeManager->GetInteger());
-	cb->AddInstr(new CTacInstr(opMul, temporaire, index, new CTacConst(dataSize, GetType())));
+	cb->AddInstr(new CTacInstr(opMul, temporaire, index, cb->CreateConst(dataSize, GetType())));
 	index = temporaire;
 
 	temporaire = cb->CreateTemp(typeManager->GetInteger());
@@ -2015,7 +2294,7 @@ CTacAddr* CAstArrayDesignator::ToTac(CCodeBlock* cb)
 	temporaire = cb->CreateTemp(typeManager->GetInteger());
 	cb->AddInstr(new CTacInstr(opAdd, temporaire, id, index));
 
-	return new CTacReference(temporaire->GetSymbol(), nullptr);
+	return new CTacReference(temporaire, nullptr);
 }
 
 CTacAddr* CAstArrayDesignator::ToTac(CCodeBlock* cb,
@@ -2023,7 +2302,7 @@ CTacAddr* CAstArrayDesignator::ToTac(CCodeBlock* cb,
 {
 	CTacAddr* valeur = ToTac(cb);
 
-	cb->AddInstr(new CTacInstr(opEqual, ltrue, valeur, new CTacConst(1, GetType())));
+	cb->AddInstr(new CTacInstr(opEqual, ltrue, valeur, cb->CreateConst(1, GetType())));
 	cb->AddInstr(new CTacInstr(opGoto, lfalse, NULL, NULL));
 
 	return NULL;
@@ -2087,18 +2366,15 @@ bool CAstConstant::TypeCheck(CToken *t, string *msg) const
 	return true;
 }
 
-const CType* CAstConstant::GetType(void) const
+const CType* CAstConstant::ComputeType(void) const
 {
 	return _type;
 }
 
-const CDataInitializer* CAstConstant::Evaluate(void) const
+SConstValue CAstConstant::ComputeValue(void) const
 {
-	if (_type->IsLongint()) return new CDataInitLongint((long long)GetValue());
-	if (_type->IsInteger()) return new CDataInitInteger((int)GetValue());
-	if (_type->IsBoolean()) return new CDataInitBoolean((bool)GetValue());
-	if (_type->IsChar()) return new CDataInitChar((char)GetValue());
-	return NULL;
+	SConstValue v = { _type, GetValue() };
+	return v;
 }
 
 ostream& CAstConstant::print(ostream &out, int indent) const
@@ -2124,7 +2400,7 @@ string CAstConstant::dotAttr(void) const
 
 CTacAddr* CAstConstant::ToTac(CCodeBlock *cb)
 {
-	return new CTacConst(GetValue(), GetType());
+	return cb->CreateConst(GetValue(), GetType());
 }
 
 CTacAddr* CAstConstant::ToTac(CCodeBlock *cb, CTacLabel *ltrue, CTacLabel *lfalse)
@@ -2142,7 +2418,7 @@ CTacAddr* CAstConstant::ToTac(CCodeBlock *cb, CTacLabel *ltrue, CTacLabel *lfals
 //--------------------------------------------------------------------------------------------------
 // CAstStringConstant
 //
-int CAstStringConstant::_idx = 0;
+thread_local int CAstStringConstant::_idx = 0;
 
 CAstStringConstant::CAstStringConstant(CToken t, const string value, CAstScope *s)
 	: CAstOperand(t)
@@ -2179,19 +2455,24 @@ const string CAstStringConstant::GetValueStr(void) const
 	return GetValue();
 }
 
+const CSymGlobal* CAstStringConstant::GetSymbol(void) const
+{
+	return _sym;
+}
+
 bool CAstStringConstant::TypeCheck(CToken *t, string *msg) const
 {
 	return true;
 }
 
-const CType* CAstStringConstant::GetType(void) const
+const CType* CAstStringConstant::ComputeType(void) const
 {
 	return _type;
 }
 
 const CDataInitializer* CAstStringConstant::Evaluate(void) const
 {
-	return new CDataInitString(GetValue());
+	return _value;
 }
 
 ostream& CAstStringConstant::print(ostream &out, int indent) const
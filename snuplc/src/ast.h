@@ -35,6 +35,7 @@
 #ifndef __SnuPL_AST_H__
 #define __SnuPL_AST_H__
 
+#include <atomic>
 #include <istream>
 #include <ostream>
 #include <sstream>
@@ -49,11 +50,114 @@
 #include "ir.h"
 using namespace std;
 
+class CAstNode;
 class CAstStatement;
 class CAstExpression;
 class CAstFunctionCall;
 class CAstDesignator;
 
+//--------------------------------------------------------------------------------------------------
+/// @brief AST node arena
+///
+/// bump-pointer allocator that owns all nodes of a module's AST. Nodes are allocated from the
+/// current arena of the calling thread (see SetCurrent()) and register themselves with it upon
+/// construction. Deleting the arena destroys all registered nodes in reverse order of their
+/// construction and releases the memory in one go; individual nodes are never freed.
+///
+/// Every CAstModule owns an arena. The parser makes it current while building the AST and
+/// CAstScope::ToTac() while lowering it, so nodes created during TAC generation are released with
+/// the module as well.
+///
+
+class CAstArena {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @param blocksize size of a memory block in bytes
+    CAstArena(size_t blocksize=64*1024);
+
+    /// @brief destructor. Destroys all registered nodes and releases the memory.
+    ~CAstArena(void);
+
+    /// @}
+
+    /// @name allocation
+    /// @{
+
+    /// @brief allocate @a size bytes aligned for any node type
+    /// @param size number of bytes
+    /// @retval pointer to uninitialized memory owned by the arena
+    void* Allocate(size_t size);
+
+    /// @brief register a node for destruction with the arena
+    /// @param node constructed node
+    void Register(CAstNode *node);
+
+    /// @brief take over all memory blocks and nodes of another arena
+    ///
+    /// used to collect the nodes built by worker threads in the module's arena. @a arena is empty
+    /// afterwards and can be reused or deleted.
+    ///
+    /// @param arena arena to merge into this one
+    void Merge(CAstArena *arena);
+
+    /// @brief destroy all registered nodes
+    ///
+    /// the current memory block is kept for reuse, all other blocks are released. Used by the
+    /// single-pass compiler (CParser::Compile()) to discard each statement once it is lowered.
+    void Reset(void);
+
+    /// @}
+
+    /// @name statistics
+    /// @{
+
+    /// @brief return the number of registered nodes
+    size_t GetNumNodes(void) const { return _numnodes; };
+
+    /// @brief return the number of memory blocks
+    size_t GetNumBlocks(void) const { return _blocks.size(); };
+
+    /// @brief return the number of bytes allocated from the arena
+    size_t GetSize(void) const { return _size; };
+
+    /// @}
+
+    /// @name current arena
+    /// @{
+
+    /// @brief return the current arena of the calling thread (or NULL)
+    static CAstArena* GetCurrent(void) { return _current; };
+
+    /// @brief set the current arena of the calling thread
+    /// @param arena new current arena (or NULL)
+    /// @retval previous current arena
+    static CAstArena* SetCurrent(CAstArena *arena);
+
+    /// @}
+
+  private:
+    /// @brief chunk of registered nodes (allocated from the arena itself)
+    struct SNodes {
+      SNodes   *prev;               ///< previous (older) chunk
+      size_t   count;               ///< number of used entries
+      CAstNode *node[254];          ///< nodes in construction order
+    };
+
+    size_t _blocksize;              ///< default size of a memory block
+    vector<char*> _blocks;          ///< memory blocks
+    char      *_top;                ///< next free byte in current block
+    char      *_end;                ///< end of current block
+    size_t    _size;                ///< number of bytes allocated
+    SNodes    *_nodes;              ///< newest chunk of registered nodes
+    SNodes    *_first;              ///< oldest chunk of registered nodes
+    size_t    _numnodes;            ///< number of registered nodes
+
+    static thread_local CAstArena *_current; ///< current arena (per thread)
+};
+
+
 //--------------------------------------------------------------------------------------------------
 /// @brief AST base node
 ///
@@ -71,6 +175,19 @@ class CAstNode {
 
     /// @}
 
+    /// @name memory management
+    /// @{
+
+    /// @brief allocate a node from the current arena (see CAstArena)
+    ///
+    /// nodes created while no arena is current are allocated on the heap and never released.
+    static void* operator new(size_t size);
+
+    /// @brief nodes are released by their arena; only modules may be deleted explicitly
+    static void operator delete(void *ptr) {};
+
+    /// @}
+
     /// @name properties
     /// @{
 
@@ -126,7 +243,7 @@ class CAstNode {
                                     ///< the creation of the node. Used for
                                     ///< error reporting purposes)
     int        _id;                 ///< id of the node
-    static int _global_id;          ///< holds the (global) next id
+    static atomic<int> _global_id;  ///< holds the (global) next id
 
   protected:
     CTacAddr   *_addr;              ///< result of this node in three-address
@@ -284,6 +401,23 @@ class CAstModule : public CAstScope {
     /// @param name module name
     CAstModule(CToken t, const string name);
 
+    /// @brief destructor. Releases the module's AST.
+    virtual ~CAstModule(void);
+
+    /// @}
+
+    /// @name memory management
+    /// @{
+
+    /// @brief modules own the arena of their AST and are allocated on the heap
+    static void* operator new(size_t size) { return ::operator new(size); };
+
+    /// @brief release a module
+    static void operator delete(void *ptr) { ::operator delete(ptr); };
+
+    /// @brief return the arena holding the module's AST
+    CAstArena* GetArena(void) const;
+
     /// @}
 
     /// @name scope manipulation/querying
@@ -302,6 +436,9 @@ class CAstModule : public CAstScope {
     virtual string dotAttr(void) const;
 
     /// @}
+
+  private:
+    CAstArena *_arena;              ///< arena holding the AST
 };
 
 
@@ -845,6 +982,19 @@ class CAstStatWhile : public CAstStatement {
 };
 
 
+//--------------------------------------------------------------------------------------------------
+/// @brief value of a constant expression
+///
+/// result of the numerical evaluation of an expression (see CAstExpression::Fold()), stored by
+/// value. The type acts as the tag: integer, longint, boolean and char values are held in
+/// @a value; a NULL type indicates that the expression is not constant.
+///
+struct SConstValue {
+  const CType *type;                ///< type of the value (NULL if not constant)
+  long long    value;               ///< value (integer, longint, boolean or char)
+};
+
+
 //--------------------------------------------------------------------------------------------------
 /// @brief AST expression node
 ///
@@ -872,8 +1022,16 @@ class CAstExpression : public CAstNode {
     /// @retval false otherwise
     virtual bool TypeCheck(CToken *t, string *msg) const = 0;
 
-    /// @brief return (compute) the type of the expression.
-    virtual const CType* GetType(void) const = 0;
+    /// @brief return the type of the expression
+    ///
+    /// The type is computed by ComputeType() when it is requested for the first time and cached
+    /// in the node. ComputeType() obtains the types of the operands through GetType(), so the
+    /// types of an expression tree are computed bottom-up, once per node, and GetType() is O(1)
+    /// afterwards.
+    virtual const CType* GetType(void) const;
+
+    /// @brief compute the type of the expression (use GetType() to query it)
+    virtual const CType* ComputeType(void) const = 0;
 
     /// @}
 
@@ -895,8 +1053,23 @@ class CAstExpression : public CAstNode {
     /// @name numerical evaluation
     /// @{
 
-    /// @brief performs numerical evaluation of a symbolic constant.
-    /// @retval NULL catch-all for classes that do not support evaluation
+    /// @brief return the value of the expression if it is constant
+    ///
+    /// The value is computed by ComputeValue() when it is requested for the first time and
+    /// cached in the node. Operands are folded through Fold() as well, so every node of an
+    /// expression tree is evaluated at most once, and designators of named constants use the
+    /// value folded for the constant's definition.
+    ///
+    /// @retval SConstValue value (type NULL if the expression is not constant)
+    const SConstValue& Fold(void) const;
+
+    /// @brief compute the value of the expression (use Fold() to query it)
+    /// @retval SConstValue value (type NULL if the expression is not constant)
+    virtual SConstValue ComputeValue(void) const;
+
+    /// @brief performs numerical evaluation of the expression
+    /// @retval CDataInitializer* initializer holding the folded value. Delete after use.
+    /// @retval NULL if numerical evaluation cannot be performed
     virtual const CDataInitializer* Evaluate(void) const;
 
     /// @}
@@ -912,6 +1085,10 @@ class CAstExpression : public CAstNode {
 
   private:
     bool       _parenthesized;      ///< expression was parenthesized
+    mutable const CType *_type_cache; ///< type of the expression (valid if _typed)
+    mutable bool _typed;            ///< _type_cache has been computed
+    mutable SConstValue _fold;      ///< value of the expression (valid if _folded)
+    mutable bool _folded;           ///< _fold has been computed
 };
 
 
@@ -984,8 +1161,8 @@ class CAstBinaryOp : public CAstOperation {
     /// @retval false otherwise
     virtual bool TypeCheck(CToken *t, string *msg) const;
 
-    /// @brief return (compute) the type of the expression.
-    virtual const CType* GetType(void) const;
+    /// @brief compute the type of the expression.
+    virtual const CType* ComputeType(void) const;
 
     /// @}
 
@@ -993,10 +1170,9 @@ class CAstBinaryOp : public CAstOperation {
     /// @name numerical evaluation
     /// @{
 
-    /// @brief performs numerical evaluation of a binary operation
-    /// @retval CDataInitializer* result of evaluation. Delete after use.
-    /// @retval NULL if numerical evaluation cannot be performed
-    virtual const CDataInitializer* Evaluate(void) const;
+    /// @brief fold a binary operation with constant operands
+    /// @retval SConstValue value (type NULL if the operation cannot be folded)
+    virtual SConstValue ComputeValue(void) const;
 
     /// @}
 
@@ -1073,8 +1249,8 @@ class CAstUnaryOp : public CAstOperation {
     /// @retval false otherwise
     virtual bool TypeCheck(CToken *t, string *msg) const;
 
-    /// @brief return (compute) the type of the expression.
-    virtual const CType* GetType(void) const;
+    /// @brief compute the type of the expression.
+    virtual const CType* ComputeType(void) const;
 
     /// @}
 
@@ -1082,10 +1258,9 @@ class CAstUnaryOp : public CAstOperation {
     /// @name numerical evaluation
     /// @{
 
-    /// @brief performs numerical evaluation of a unary operation
-    /// @retval CDataInitializer* result of evaluation. Delete after use.
-    /// @retval NULL if numerical evaluation cannot be performed
-    virtual const CDataInitializer* Evaluate(void) const;
+    /// @brief fold a unary operation with a constant operand
+    /// @retval SConstValue value (type NULL if the operation cannot be folded)
+    virtual SConstValue ComputeValue(void) const;
 
     /// @}
 
@@ -1165,8 +1340,8 @@ class CAstSpecialOp : public CAstOperation {
     /// @retval false otherwise
     virtual bool TypeCheck(CToken *t, string *msg) const;
 
-    /// @brief return (compute) the type of the expression.
-    virtual const CType* GetType(void) const;
+    /// @brief compute the type of the expression.
+    virtual const CType* ComputeType(void) const;
 
     /// @}
 
@@ -1250,8 +1425,8 @@ class CAstFunctionCall : public CAstExpression {
     /// @retval false otherwise
     virtual bool TypeCheck(CToken *t, string *msg) const;
 
-    /// @brief return the return type of the call
-    virtual const CType* GetType(void) const;
+    /// @brief compute the type of the call (the return type)
+    virtual const CType* ComputeType(void) const;
 
     /// @}
 
@@ -1346,8 +1521,8 @@ class CAstDesignator : public CAstOperand {
     /// @retval false otherwise
     virtual bool TypeCheck(CToken *t, string *msg) const;
 
-    /// @brief return (compute) the type of the designator.
-    virtual const CType* GetType(void) const;
+    /// @brief compute the type of the designator.
+    virtual const CType* ComputeType(void) const;
 
     /// @}
 
@@ -1355,10 +1530,9 @@ class CAstDesignator : public CAstOperand {
     /// @name numerical evaluation
     /// @{
 
-    /// @brief performs numerical evaluation of a designator
-    /// @retval CDataInitializer* result of evaluation. Delete after use.
-    /// @retval NULL if numerical evaluation cannot be performed
-    virtual const CDataInitializer* Evaluate(void) const;
+    /// @brief return the value of a designator of a scalar named constant
+    /// @retval SConstValue value (type NULL if the designator is not a scalar constant)
+    virtual SConstValue ComputeValue(void) const;
 
     /// @}
 
@@ -1428,7 +1602,10 @@ class CAstArrayDesignator : public CAstDesignator {
     /// for the access is generated.
     /// This function must only be called once, and no more indices can be
     /// added after calling IndicesComplete().
-    void IndicesComplete(void);
+    ///
+    /// @param dim runtime function DIM(array, dim) returning the size of a dimension
+    /// @param dofs runtime function DOFS(array) returning the offset of the data
+    void IndicesComplete(const CSymProc *dim, const CSymProc *dofs);
 
     /// @brief return the number of arguments
     unsigned int GetNIndices(void) const;
@@ -1436,6 +1613,12 @@ class CAstArrayDesignator : public CAstDesignator {
     /// @brief return the @a index-th index expression
     CAstExpression* GetIndex(unsigned int index) const;
 
+    /// @brief return the runtime function DIM
+    const CSymProc* GetDIM(void) const { return _dim; };
+
+    /// @brief return the runtime function DOFS
+    const CSymProc* GetDOFS(void) const { return _dofs; };
+
     /// @}
     /// @}
 
@@ -1449,8 +1632,8 @@ class CAstArrayDesignator : public CAstDesignator {
     /// @retval false otherwise
     virtual bool TypeCheck(CToken *t, string *msg) const;
 
-    /// @brief return (compute) the type of the designator.
-    virtual const CType* GetType(void) const;
+    /// @brief compute the type of the designator.
+    virtual const CType* ComputeType(void) const;
 
     /// @}
 
@@ -1489,6 +1672,8 @@ class CAstArrayDesignator : public CAstDesignator {
                                     ///< have been added
     vector<CAstExpression*> _idx;   ///< index expressions
     CAstExpression *_offset;        ///< address computation expression
+    const CSymProc *_dim;           ///< runtime function DIM
+    const CSymProc *_dofs;          ///< runtime function DOFS
 };
 
 
@@ -1535,8 +1720,8 @@ class CAstConstant : public CAstOperand {
     /// @retval false otherwise
     virtual bool TypeCheck(CToken *t, string *msg) const;
 
-    /// @brief return (compute) the type of the constant
-    virtual const CType* GetType(void) const;
+    /// @brief compute the type of the constant
+    virtual const CType* ComputeType(void) const;
 
     /// @}
 
@@ -1544,10 +1729,9 @@ class CAstConstant : public CAstOperand {
     /// @name numerical evaluation
     /// @{
 
-    /// @brief performs numerical evaluation of a constant
-    /// @retval CDataInitializer* result of evaluation. Delete after use.
-    /// @retval NULL if numerical evaluation cannot be performed
-    virtual const CDataInitializer* Evaluate(void) const;
+    /// @brief return the value of a constant
+    /// @retval SConstValue value
+    virtual SConstValue ComputeValue(void) const;
 
     /// @}
 
@@ -1613,6 +1797,27 @@ class CAstStringConstant : public CAstOperand {
     /// @brief return the constant value as a string
     const string GetValueStr(void) const;
 
+    /// @brief return the global symbol holding the string
+    const CSymGlobal* GetSymbol(void) const;
+
+    /// @}
+
+
+    /// @name symbol naming
+    /// @{
+
+    /// @brief return the number of the last string constant created by this thread
+    ///
+    /// String constants are stored in global symbols named "_str_<number>".
+    static int GetIndex(void) { return _idx; };
+
+    /// @brief set the number of the last string constant created by this thread
+    ///
+    /// Lets parsers running on several threads reproduce the numbering of the serial parser.
+    ///
+    /// @param idx number of the last string constant
+    static void SetIndex(int idx) { _idx = idx; };
+
     /// @}
 
 
@@ -1626,8 +1831,8 @@ class CAstStringConstant : public CAstOperand {
     /// @retval false otherwise
     virtual bool TypeCheck(CToken *t, string *msg) const;
 
-    /// @brief return (compute) the type of the constant
-    virtual const CType* GetType(void) const;
+    /// @brief compute the type of the constant
+    virtual const CType* ComputeType(void) const;
 
     /// @}
 
@@ -1667,7 +1872,7 @@ class CAstStringConstant : public CAstOperand {
 
 
   private:
-    static int       _idx;          ///< static counter
+    static thread_local int _idx;   ///< static counter (per thread)
     const CType     *_type;         ///< constant type
     CDataInitString *_value;        ///< data initializer (holds string data)
     CSymGlobal      *_sym;          ///< symbol holding the string
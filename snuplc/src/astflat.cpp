@@ -0,0 +1,850 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL flattened abstract syntax tree
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <cassert>
+#include <typeinfo>
+
+#include "astflat.h"
+using namespace std;
+
+
+/// @brief check whether a type is integer or longint
+static bool IsIntegral(const CType *t)
+{
+  CTypeManager *tm = CTypeManager::Get();
+  return t->Match(tm->GetInteger()) || t->Match(tm->GetLongint());
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CAstFlat
+//
+const unsigned int CAstFlat::None;
+
+CAstFlat::CAstFlat(const CAstModule *m)
+{
+  assert(m != NULL);
+
+  // the module's arena knows how many nodes there are (an upper bound for the flattened AST)
+  size_t n = m->GetArena()->GetNumNodes();
+  _kind.reserve(n); _op.reserve(n);
+  _a.reserve(n); _b.reserve(n); _next.reserve(n);
+  _value.reserve(n); _type.reserve(n); _sym.reserve(n); _node.reserve(n);
+
+  FlattenScope(m);
+}
+
+CAstScope* CAstFlat::GetScope(unsigned int n) const
+{
+  assert((_kind[n] == akModule) || (_kind[n] == akProcedure));
+  return _scopes[_value[n]];
+}
+
+unsigned int CAstFlat::FindScope(const CAstScope *s) const
+{
+  map<const CAstScope*, unsigned int>::const_iterator it = _scope_node.find(s);
+  return it != _scope_node.end() ? it->second : None;
+}
+
+unsigned int CAstFlat::Add(EAstKind kind, const CAstNode *n)
+{
+  unsigned int idx = _kind.size();
+  assert(idx != None);
+
+  _kind.push_back(kind);
+  _op.push_back(0);
+  _a.push_back(None);
+  _b.push_back(None);
+  _next.push_back(None);
+  _value.push_back(0);
+  _type.push_back(NULL);
+  _sym.push_back(NULL);
+  _node.push_back(n);
+
+  return idx;
+}
+
+unsigned int CAstFlat::FlattenScope(const CAstScope *s)
+{
+  const CAstProcedure *p = dynamic_cast<const CAstProcedure*>(s);
+  unsigned int n = Add(p != NULL ? akProcedure : akModule, s);
+
+  if (p != NULL) _sym[n] = p->GetSymbol();
+  _value[n] = _scopes.size();
+  _scopes.push_back(const_cast<CAstScope*>(s));
+  _scope_node[s] = n;
+
+  unsigned int stat = FlattenStatements(s->GetStatementSequence());
+  _a[n] = stat;
+
+  unsigned int prev = None;
+  for (size_t i=0; i<s->GetNumChildren(); i++) {
+    unsigned int c = FlattenScope(s->GetChild(i));
+    if (prev == None) _b[n] = c; else _next[prev] = c;
+    prev = c;
+  }
+
+  return n;
+}
+
+unsigned int CAstFlat::FlattenStatements(const CAstStatement *s)
+{
+  unsigned int first = None, prev = None;
+
+  while (s != NULL) {
+    unsigned int n = FlattenStatement(s);
+    if (prev == None) first = n; else _next[prev] = n;
+    prev = n;
+    s = s->GetNext();
+  }
+
+  return first;
+}
+
+unsigned int CAstFlat::FlattenStatement(const CAstStatement *s)
+{
+  unsigned int n, a, b;
+
+  // the exact type identifies the kind of a node; comparing typeids is much cheaper than a chain
+  // of dynamic_casts
+  const type_info &ti = typeid(*s);
+
+  if (ti == typeid(CAstStatAssign)) {
+    const CAstStatAssign *as = static_cast<const CAstStatAssign*>(s);
+    n = Add(akAssign, s);
+    a = FlattenExpression(as->GetLHS());
+    b = FlattenExpression(as->GetRHS());
+    _a[n] = a; _b[n] = b;
+  } else if (ti == typeid(CAstStatCall)) {
+    const CAstStatCall *c = static_cast<const CAstStatCall*>(s);
+    n = Add(akCall, s);
+    a = FlattenExpression(c->GetCall());
+    _a[n] = a;
+  } else if (ti == typeid(CAstStatReturn)) {
+    const CAstStatReturn *r = static_cast<const CAstStatReturn*>(s);
+    n = Add(akReturn, s);
+    a = r->GetExpression() != NULL ? FlattenExpression(r->GetExpression()) : None;
+    _a[n] = a;
+    _b[n] = FindScope(r->GetScope());
+    assert(_b[n] != None);
+  } else if (ti == typeid(CAstStatIf)) {
+    const CAstStatIf *i = static_cast<const CAstStatIf*>(s);
+    n = Add(akIf, s);
+    a = FlattenExpression(i->GetCondition());
+    b = FlattenStatements(i->GetIfBody());
+    _a[n] = a; _b[n] = b;
+    _value[n] = FlattenStatements(i->GetElseBody());
+  } else if (ti == typeid(CAstStatWhile)) {
+    const CAstStatWhile *w = static_cast<const CAstStatWhile*>(s);
+    n = Add(akWhile, s);
+    a = FlattenExpression(w->GetCondition());
+    b = FlattenStatements(w->GetBody());
+    _a[n] = a; _b[n] = b;
+  } else {
+    assert(false && "unknown statement");
+    n = None;
+  }
+
+  return n;
+}
+
+unsigned int CAstFlat::FlattenExpression(const CAstExpression *e)
+{
+  unsigned int n, a;
+  assert(e != NULL);
+
+  const type_info &ti = typeid(*e);
+
+  if (ti == typeid(CAstBinaryOp)) {
+    const CAstBinaryOp *bo = static_cast<const CAstBinaryOp*>(e);
+    n = Add(akBinaryOp, e);
+    _op[n] = bo->GetOperation();
+    a = FlattenExpression(bo->GetLeft());
+    _a[n] = a;
+    a = FlattenExpression(bo->GetRight());
+    _b[n] = a;
+  } else if (ti == typeid(CAstUnaryOp)) {
+    const CAstUnaryOp *uo = static_cast<const CAstUnaryOp*>(e);
+    n = Add(akUnaryOp, e);
+    _op[n] = uo->GetOperation();
+    a = FlattenExpression(uo->GetOperand());
+    _a[n] = a;
+  } else if (ti == typeid(CAstSpecialOp)) {
+    const CAstSpecialOp *so = static_cast<const CAstSpecialOp*>(e);
+    n = Add(akSpecialOp, e);
+    _op[n] = so->GetOperation();
+    if (so->GetOperation() == opCast) _type[n] = so->GetType();
+    a = FlattenExpression(so->GetOperand());
+    _a[n] = a;
+  } else if (ti == typeid(CAstFunctionCall)) {
+    const CAstFunctionCall *fc = static_cast<const CAstFunctionCall*>(e);
+    n = Add(akFunctionCall, e);
+    _sym[n] = fc->GetSymbol();
+    _value[n] = fc->GetNArgs();
+    unsigned int prev = None;
+    for (unsigned int i=0; i<fc->GetNArgs(); i++) {
+      a = FlattenExpression(fc->GetArg(i));
+      if (prev == None) _a[n] = a; else _next[prev] = a;
+      prev = a;
+    }
+  } else if (ti == typeid(CAstArrayDesignator)) {
+    const CAstArrayDesignator *ad = static_cast<const CAstArrayDesignator*>(e);
+    n = Add(akArrayDesignator, e);
+    _sym[n] = ad->GetSymbol();
+    _value[n] = ad->GetNIndices();
+    unsigned int prev = None;
+    for (unsigned int i=0; i<ad->GetNIndices(); i++) {
+      a = FlattenExpression(ad->GetIndex(i));
+      if (prev == None) _a[n] = a; else _next[prev] = a;
+      prev = a;
+    }
+  } else if (ti == typeid(CAstDesignator)) {
+    const CAstDesignator *d = static_cast<const CAstDesignator*>(e);
+    n = Add(akDesignator, e);
+    _sym[n] = d->GetSymbol();
+  } else if (ti == typeid(CAstConstant)) {
+    const CAstConstant *c = static_cast<const CAstConstant*>(e);
+    n = Add(akConstant, e);
+    _type[n] = c->GetType();
+    _value[n] = c->GetValue();
+  } else if (ti == typeid(CAstStringConstant)) {
+    const CAstStringConstant *sc = static_cast<const CAstStringConstant*>(e);
+    n = Add(akStringConstant, e);
+    _type[n] = sc->GetType();
+    _sym[n] = sc->GetSymbol();
+  } else {
+    assert(false && "unknown expression");
+    n = None;
+  }
+
+  return n;
+}
+
+const CType* CAstFlat::GetType(unsigned int n) const
+{
+  CTypeManager *tm = CTypeManager::Get();
+  const CType *type = NULL;
+
+  switch (_kind[n]) {
+    case akModule:
+    case akCall:
+    case akIf:
+    case akWhile:
+      type = tm->GetNull();
+      break;
+
+    case akProcedure:
+    case akFunctionCall:
+    case akDesignator:
+      type = _sym[n]->GetDataType();
+      break;
+
+    case akAssign:
+      type = GetType(_a[n]);
+      break;
+
+    case akReturn:
+      type = _a[n] != None ? GetType(_a[n]) : tm->GetNull();
+      break;
+
+    case akBinaryOp:
+      switch (_op[n]) {
+        case opAdd: case opSub: case opMul: case opDiv:
+          type = tm->GetInteger();
+          break;
+        case opAnd: case opOr: case opNot:
+        case opEqual: case opNotEqual:
+        case opLessThan: case opLessEqual: case opBiggerThan: case opBiggerEqual:
+          type = tm->GetBool();
+          break;
+      }
+      break;
+
+    case akUnaryOp:
+      switch (_op[n]) {
+        case opNeg: case opPos: type = tm->GetInteger(); break;
+        case opNop:             type = tm->GetBool(); break;
+      }
+      break;
+
+    case akSpecialOp: {
+      const CType *ot = GetType(_a[n]);
+      if (ot->IsNull()) break;
+      switch (_op[n]) {
+        case opAddress:
+          type = tm->GetPointer(ot);
+          // fall through (as CAstSpecialOp::GetType)
+        case opDeref:
+          if (!ot->IsPointer()) break;
+          type = dynamic_cast<const CPointerType*>(ot)->GetBaseType();
+          break;
+        case opCast:
+          type = _type[n];
+          break;
+      }
+      break;
+    }
+
+    case akArrayDesignator: {
+      type = _sym[n]->GetDataType();
+      if (type->IsPointer()) type = dynamic_cast<const CPointerType*>(type)->GetBaseType();
+      if (!type->IsArray()) return NULL;
+      if (_value[n] > (long long)dynamic_cast<const CArrayType*>(type)->GetNDim()) return NULL;
+      for (long long i=0; i<_value[n]; i++) {
+        if (!type->IsArray()) return NULL;
+        type = dynamic_cast<const CArrayType*>(type)->GetInnerType();
+      }
+      break;
+    }
+
+    case akConstant:
+    case akStringConstant:
+      type = _type[n];
+      break;
+  }
+
+  return type;
+}
+
+bool CAstFlat::TypeCheck(CToken *t, string *msg) const
+{
+  return GetNumNodes() == 0 || TypeCheckScope(0, t, msg);
+}
+
+bool CAstFlat::TypeCheckScope(unsigned int n, CToken *t, string *msg) const
+{
+  bool result = true;
+  try {
+    unsigned int s = _a[n];
+    while (result && (s != None)) {
+      result = TypeCheckNode(s, t, msg);
+      s = _next[s];
+    }
+    unsigned int c = _b[n];
+    while (result && (c != None)) {
+      result = TypeCheckScope(c, t, msg);
+      c = _next[c];
+    }
+  }
+  catch (...) {
+    result = false;
+  }
+  return result;
+}
+
+void CAstFlat::SetError(unsigned int n, CToken *t, string *msg, const char *message) const
+{
+  if (t != NULL) *t = GetToken(n);
+  if (msg != NULL) *msg = message;
+}
+
+bool CAstFlat::TypeCheckNode(unsigned int n, CToken *t, string *msg) const
+{
+  CTypeManager *tm = CTypeManager::Get();
+  unsigned int a = _a[n], b = _b[n];
+
+  switch (_kind[n]) {
+    case akAssign: {
+      if (!TypeCheckNode(a, t, msg) || !TypeCheckNode(b, t, msg)) return false;
+      const CType *lt = GetType(a), *rt = GetType(b);
+      if (!lt || !lt->IsScalar()) {
+        SetError(a, t, msg, "lhs type is not accepted.");
+        return false;
+      }
+      if (!rt || !rt->IsScalar()) {
+        SetError(b, t, msg, "rhs' type is not accepted.");
+        return false;
+      }
+      if (!lt->Match(rt)) {
+        SetError(b, t, msg, "Mismatch between lhs' type and rhs' type.");
+        return false;
+      }
+      return true;
+    }
+
+    case akCall:
+      return TypeCheckNode(a, t, msg);
+
+    case akReturn: {
+      const CType *st = GetType(b);
+      if (st->Match(tm->GetNull())) {
+        if (a != None) {
+          SetError(a, t, msg, "superfluous expression after return.");
+          return false;
+        }
+      } else {
+        if (a == None) {
+          SetError(n, t, msg, "expression expected after return.");
+          return false;
+        }
+        if (!TypeCheckNode(a, t, msg)) return false;
+        if (!st->Match(GetType(a))) {
+          SetError(a, t, msg, "return type mismatch.");
+          return false;
+        }
+      }
+      return true;
+    }
+
+    case akIf:
+    case akWhile: {
+      if (!TypeCheckNode(a, t, msg)) return false;
+      const CType *ct = GetType(a);
+      if (!ct || !ct->Match(tm->GetBool())) {
+        SetError(a, t, msg, "The Condition is not a boolean type.");
+        return false;
+      }
+      for (unsigned int s=b; s!=None; s=_next[s]) {
+        if (!TypeCheckNode(s, t, msg)) return false;
+      }
+      if (_kind[n] == akIf) {
+        for (unsigned int s=_value[n]; s!=None; s=_next[s]) {
+          if (!TypeCheckNode(s, t, msg)) return false;
+        }
+      }
+      return true;
+    }
+
+    case akBinaryOp: {
+      if (!TypeCheckNode(a, t, msg) || !TypeCheckNode(b, t, msg)) return false;
+      const CType *lt = GetType(a), *rt = GetType(b);
+      if (!lt || !lt->IsScalar() || lt->IsPointer()) {
+        SetError(a, t, msg, "The left term is not a scalar type or is a pointer.");
+        return false;
+      }
+      if (!rt || !rt->IsScalar() || rt->IsPointer()) {
+        SetError(b, t, msg, "The right term is not a scalar type or is a pointer.");
+        return false;
+      }
+      if (!lt->Match(rt)) {
+        SetError(n, t, msg, "The right term is not a scalar type or is a pointer.");
+        return false;
+      }
+      switch (_op[n]) {
+        case opAdd: case opSub: case opMul: case opDiv:
+        case opLessThan: case opLessEqual: case opBiggerEqual: case opBiggerThan:
+          if (!IsIntegral(lt)) {
+            SetError(a, t, msg, "Left term should be integer.");
+            return false;
+          } else if (!IsIntegral(rt)) {
+            SetError(b, t, msg, "Right term should be integer.");
+            return false;
+          }
+          break;
+        case opAnd: case opOr:
+          if (!lt->Match(tm->GetBool())) {
+            SetError(a, t, msg, "Left term should be boolean.");
+            return false;
+          } else if (!rt->Match(tm->GetBool())) {
+            SetError(b, t, msg, "Right term should be boolean.");
+            return false;
+          }
+          break;
+      }
+      return true;
+    }
+
+    case akUnaryOp:
+      if (!TypeCheckNode(a, t, msg)) return false;
+      if (_op[n] == opNot) {
+        if (!GetType(a)->Match(tm->GetBool())) {
+          SetError(a, t, msg, "The operand should be a boolean.");
+          return false;
+        }
+      } else if (!IsIntegral(GetType(a))) {
+        SetError(a, t, msg, "The operand should be an integer.");
+        return false;
+      }
+      return true;
+
+    case akSpecialOp:
+      if (!TypeCheckNode(a, t, msg)) return false;
+      if (!GetType(a)) {
+        SetError(n, t, msg, "Operand null.");
+        return false;
+      }
+      if ((_op[n] == opDeref) && !GetType(a)->IsPointer()) {
+        SetError(n, t, msg, "The operand should has a pointer type.");
+        return false;
+      }
+      return true;
+
+    case akFunctionCall: {
+      const CSymProc *proc = static_cast<const CSymProc*>(_sym[n]);
+      if (_value[n] != (long long)proc->GetNParams()) {
+        SetError(n, t, msg, "Not the good number of arguments.");
+        return false;
+      }
+      int i = 0;
+      for (unsigned int e=a; e!=None; e=_next[e], i++) {
+        const CType *pt = proc->GetParam(i)->GetDataType();
+        if (!TypeCheckNode(e, t, msg)) return false;
+        if (!GetType(e) || !pt || !pt->Match(GetType(e))) {
+          SetError(n, t, msg, "The parameters don't match.");
+          return false;
+        }
+      }
+      return true;
+    }
+
+    case akDesignator:
+      if (GetType(n) == NULL || GetType(n)->IsNull()) {
+        SetError(n, t, msg, "Designator is NULL Type.");
+        return false;
+      }
+      return true;
+
+    case akArrayDesignator:
+      for (unsigned int e=a; e!=None; e=_next[e]) {
+        if (!TypeCheckNode(e, t, msg)) return false;
+        if (!GetType(e)) {
+          SetError(e, t, msg, "The expression is NULL.");
+          return false;
+        }
+        if (!IsIntegral(GetType(e))) {
+          SetError(e, t, msg, "The expression should be an integer or a longint.");
+          return false;
+        }
+      }
+      return true;
+
+    case akConstant:
+      if (_type[n] == NULL || _type[n]->IsNull()) {
+        SetError(n, t, msg, "The type of the constant is NULL.");
+        return false;
+      }
+      return true;
+
+    case akStringConstant:
+      return true;
+
+    default:
+      return TypeCheckScope(n, t, msg);
+  }
+}
+
+void CAstFlat::ToTac(unsigned int scope, CCodeBlock *cb) const
+{
+  assert(cb != NULL);
+  assert((_kind[scope] == akModule) || (_kind[scope] == akProcedure));
+
+  StatementsToTac(_a[scope], cb);
+
+  cb->CleanupControlFlow();
+}
+
+void CAstFlat::StatementsToTac(unsigned int n, CCodeBlock *cb) const
+{
+  while (n != None) {
+    CTacLabel *next = cb->CreateLabel();
+    StatementToTac(n, cb, next);
+    cb->AddInstr(next);
+    n = _next[n];
+  }
+}
+
+void CAstFlat::StatementToTac(unsigned int n, CCodeBlock *cb, CTacLabel *next) const
+{
+  switch (_kind[n]) {
+    case akAssign:
+      cb->AddInstr(new CTacInstr(opAssign, ExpressionToTac(_a[n], cb), ExpressionToTac(_b[n], cb)));
+      break;
+
+    case akCall: {
+      unsigned int call = _a[n];
+      ArgsToTac(_a[call], 0, GetType(n), cb);
+      CTacTemp *tmp = NULL;
+      if (GetType(call) != CTypeManager::Get()->GetNull()) tmp = cb->CreateTemp(GetType(call));
+      cb->AddInstr(new CTacInstr(opCall, tmp, new CTacName(_sym[call]), NULL));
+      break;
+    }
+
+    case akReturn: {
+      CTacAddr *retval = NULL;
+      if (_a[n] != None) retval = ExpressionToTac(_a[n], cb);
+      cb->AddInstr(new CTacInstr(opReturn, NULL, retval, NULL));
+      break;
+    }
+
+    case akIf: {
+      CTacLabel *ltrue = cb->CreateLabel("lbl_true");
+      CTacLabel *lfalse = cb->CreateLabel("lbl_false");
+      ConditionToTac(_a[n], cb, ltrue, lfalse);
+      cb->AddInstr(ltrue);
+      StatementsToTac(_b[n], cb);
+      cb->AddInstr(new CTacInstr(opGoto, next));
+      cb->AddInstr(lfalse);
+      StatementsToTac(_value[n], cb);
+      break;
+    }
+
+    case akWhile: {
+      CTacLabel *lcond = cb->CreateLabel("lbl_condition");
+      CTacLabel *lbody = cb->CreateLabel("lbl_body");
+      cb->AddInstr(lcond);
+      ConditionToTac(_a[n], cb, lbody, next);
+      cb->AddInstr(lbody);
+      StatementsToTac(_b[n], cb);
+      cb->AddInstr(new CTacInstr(opGoto, lcond));
+      break;
+    }
+
+    default:
+      break;
+  }
+
+  cb->AddInstr(new CTacInstr(opGoto, next));
+}
+
+void CAstFlat::ArgsToTac(unsigned int n, int i, const CType *type, CCodeBlock *cb) const
+{
+  // parameters are passed last to first
+  if (n == None) return;
+  ArgsToTac(_next[n], i+1, type, cb);
+
+  CTacAddr *arg = ExpressionToTac(n, cb);
+  cb->AddInstr(new CTacInstr(opParam, cb->CreateConst(i, type), arg, NULL));
+}
+
+CTacAddr* CAstFlat::ExpressionToTac(unsigned int n, CCodeBlock *cb) const
+{
+  CTypeManager *tm = CTypeManager::Get();
+  EOperation op = (EOperation)_op[n];
+
+  switch (_kind[n]) {
+    case akBinaryOp:
+      if ((op == opAdd) || (op == opSub) || (op == opMul) || (op == opDiv)) {
+        CTacTemp *dest = cb->CreateTemp(tm->GetInteger());
+        cb->AddInstr(new CTacInstr(op, dest, ExpressionToTac(_a[n], cb), ExpressionToTac(_b[n], cb)));
+        return dest;
+      }
+      // fall through
+    case akUnaryOp: {
+      if ((op == opPos) || (op == opNeg)) {
+        unsigned int a = _a[n];
+        if (_kind[a] == akConstant) {
+          return cb->CreateConst(op == opNeg ? -_value[a] : _value[a], GetType(n));
+        }
+        CTacAddr *src = ExpressionToTac(a, cb);
+        CTacTemp *dest = cb->CreateTemp(tm->GetInteger());
+        cb->AddInstr(new CTacInstr(op, dest, src, NULL));
+        return dest;
+      }
+
+      // boolean expression: materialize the result of the condition
+      bool binary = _kind[n] == akBinaryOp;
+      CTacLabel *lfalse = binary ? cb->CreateLabel() : NULL;
+      CTacLabel *ltrue = cb->CreateLabel();
+      if (!binary) lfalse = cb->CreateLabel();
+      CTacLabel *lend = cb->CreateLabel();
+      const CType *ct = binary ? tm->GetBool() : GetType(n);
+
+      ConditionToTac(n, cb, ltrue, lfalse);
+      CTacTemp *result = cb->CreateTemp(tm->GetBool());
+
+      cb->AddInstr(ltrue);
+      cb->AddInstr(new CTacInstr(opAssign, result, cb->CreateConst(1, ct), NULL));
+      cb->AddInstr(new CTacInstr(opGoto, lend, NULL, NULL));
+      cb->AddInstr(lfalse);
+      cb->AddInstr(new CTacInstr(opAssign, result, cb->CreateConst(0, ct), NULL));
+      if (binary) cb->AddInstr(new CTacInstr(opGoto, lend, NULL, NULL));
+      cb->AddInstr(lend);
+      return result;
+    }
+
+    case akSpecialOp: {
+      CTacAddr *src = ExpressionToTac(_a[n], cb);
+      CTacTemp *dest = cb->CreateTemp(tm->GetPointer(GetType(_a[n])));
+      cb->AddInstr(new CTacInstr(opAddress, dest, src, NULL));
+      return dest;
+    }
+
+    case akFunctionCall: {
+      ArgsToTac(_a[n], 0, GetType(n), cb);
+      CTacTemp *result = cb->CreateTemp(GetType(n));
+      cb->AddInstr(new CTacInstr(opCall, result, new CTacName(_sym[n]), NULL));
+      return result;
+    }
+
+    case akDesignator: {
+      // named constants have no storage; use their folded value
+      const SConstValue &v = static_cast<const CAstExpression*>(_node[n])->Fold();
+      if (v.type != NULL) return cb->CreateConst(v.value, v.type);
+      return new CTacName(_sym[n]);
+    }
+
+    case akStringConstant:
+      return new CTacName(_sym[n]);
+
+    case akArrayDesignator:
+      return ArrayToTac(n, cb);
+
+    case akConstant:
+      return cb->CreateConst(_value[n], _type[n]);
+
+    default:
+      return NULL;
+  }
+}
+
+CTacAddr* CAstFlat::ConditionToTac(unsigned int n, CCodeBlock *cb,
+                                   CTacLabel *ltrue, CTacLabel *lfalse) const
+{
+  EOperation op = (EOperation)_op[n];
+
+  switch (_kind[n]) {
+    case akBinaryOp: {
+      CTacLabel *test_b = cb->CreateLabel();
+      if (IsRelOp(op)) {
+        cb->AddInstr(new CTacInstr(op, ltrue, ExpressionToTac(_a[n], cb), ExpressionToTac(_b[n], cb)));
+        cb->AddInstr(new CTacInstr(opGoto, lfalse));
+      } else {
+        // the right operand is evaluated first (as CAstBinaryOp)
+        if (op == opAnd) ConditionToTac(_b[n], cb, test_b, lfalse);
+        else             ConditionToTac(_b[n], cb, ltrue, test_b);
+        cb->AddInstr(test_b);
+        ConditionToTac(_a[n], cb, ltrue, lfalse);
+      }
+      break;
+    }
+
+    case akUnaryOp:
+      if (op == opNot) ConditionToTac(_a[n], cb, lfalse, ltrue);
+      break;
+
+    case akFunctionCall:
+    case akDesignator:
+    case akArrayDesignator: {
+      CTacAddr *value = ExpressionToTac(n, cb);
+      cb->AddInstr(new CTacInstr(opEqual, ltrue, value, cb->CreateConst(1, GetType(n))));
+      cb->AddInstr(new CTacInstr(opGoto, lfalse, NULL, NULL));
+      break;
+    }
+
+    case akConstant:
+      cb->AddInstr(new CTacInstr(opGoto, _value[n] ? ltrue : lfalse, NULL, NULL));
+      break;
+
+    default:
+      break;
+  }
+
+  return NULL;
+}
+
+CTacAddr* CAstFlat::ArrayBaseToTac(unsigned int n, CCodeBlock *cb) const
+{
+  // the array itself, or its address if it is not already a pointer
+  const CSymbol *sym = _sym[n];
+  CTacAddr *base = new CTacName(sym);
+  if (!sym->GetDataType()->IsPointer()) {
+    CTacTemp *ptr = cb->CreateTemp(CTypeManager::Get()->GetPointer(sym->GetDataType()));
+    cb->AddInstr(new CTacInstr(opAddress, ptr, base, NULL));
+    base = ptr;
+  }
+  return base;
+}
+
+CTacAddr* CAstFlat::ArrayCallToTac(const CSymbol *proc, unsigned int n, int dim,
+                                   CCodeBlock *cb) const
+{
+  // DIM(array, dim) if dim > 0, DOFS(array) otherwise
+  const CType *type = proc->GetDataType();
+  if (dim > 0) {
+    cb->AddInstr(new CTacInstr(opParam, cb->CreateConst(1, type),
+                               cb->CreateConst(dim, CTypeManager::Get()->GetInteger()), NULL));
+  }
+  CTacAddr *base = ArrayBaseToTac(n, cb);
+  cb->AddInstr(new CTacInstr(opParam, cb->CreateConst(0, type), base, NULL));
+
+  CTacTemp *result = cb->CreateTemp(type);
+  cb->AddInstr(new CTacInstr(opCall, result, new CTacName(proc), NULL));
+  return result;
+}
+
+CTacAddr* CAstFlat::ArrayToTac(unsigned int n, CCodeBlock *cb) const
+{
+  CTypeManager *tm = CTypeManager::Get();
+  const CAstArrayDesignator *ad = static_cast<const CAstArrayDesignator*>(_node[n]);
+  const CSymbol *dofs = ad->GetDOFS();
+  const CSymbol *dim = ad->GetDIM();
+  assert((dofs != NULL) && (dim != NULL));
+
+  const CSymbol *sym = _sym[n];
+  const CArrayType *at;
+  CTacAddr *id;
+  if (sym->GetDataType()->IsPointer()) {
+    at = dynamic_cast<const CArrayType*>(
+           dynamic_cast<const CPointerType*>(sym->GetDataType())->GetBaseType());
+    id = new CTacName(sym);
+  } else {
+    at = dynamic_cast<const CArrayType*>(sym->GetDataType());
+    id = ArrayBaseToTac(n, cb);
+  }
+
+  const CType *et = GetType(n);
+  int size = at->GetBaseType()->GetSize();
+  int ndim = at->GetNDim();
+  unsigned int idx = _a[n];
+  assert(idx != None);
+
+  // offset = ((i_0 * DIM(a, 2) + i_1) * DIM(a, 3) + ...) * size + DOFS(a)
+  CTacAddr *index = NULL;
+  for (int i=0; i<ndim; i++) {
+    if (index == NULL) {
+      index = ExpressionToTac(idx, cb);
+      idx = _next[idx];
+    } else {
+      CTacAddr *ival = cb->CreateConst(0, et);
+      if (idx != None) {
+        ival = ExpressionToTac(idx, cb);
+        idx = _next[idx];
+      }
+      CTacTemp *sum = cb->CreateTemp(tm->GetInteger());
+      cb->AddInstr(new CTacInstr(opAdd, sum, index, ival));
+      index = sum;
+    }
+    if (i == ndim-1) break;
+
+    CTacAddr *d = ArrayCallToTac(dim, n, i+2, cb);
+    CTacTemp *prod = cb->CreateTemp(tm->GetInteger());
+    cb->AddInstr(new CTacInstr(opMul, prod, index, d));
+    index = prod;
+  }
+
+  CTacAddr *ofs = ArrayCallToTac(dofs, n, 0, cb);
+  CTacTemp *tmp = cb->CreateTemp(tm->GetInteger());
+  cb->AddInstr(new CTacInstr(opMul, tmp, index, cb->CreateConst(size, et)));
+  index = tmp;
+  tmp = cb->CreateTemp(tm->GetInteger());
+  cb->AddInstr(new CTacInstr(opAdd, tmp, index, ofs));
+  index = tmp;
+  tmp = cb->CreateTemp(tm->GetInteger());
+  cb->AddInstr(new CTacInstr(opAdd, tmp, id, index));
+
+  return new CTacReference(tmp, NULL);
+}
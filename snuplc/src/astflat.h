@@ -0,0 +1,220 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL flattened abstract syntax tree
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_ASTFLAT_H__
+#define __SnuPL_ASTFLAT_H__
+
+#include <map>
+#include <vector>
+
+#include "ast.h"
+using namespace std;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief node kinds of the flattened AST
+///
+enum EAstKind {
+  akModule=0,                       ///< module scope
+  akProcedure,                      ///< procedure/function scope
+  akAssign,                         ///< assignment
+  akCall,                           ///< procedure call statement
+  akReturn,                         ///< return statement
+  akIf,                             ///< if statement
+  akWhile,                          ///< while statement
+  akBinaryOp,                       ///< binary operation
+  akUnaryOp,                        ///< unary operation
+  akSpecialOp,                      ///< special operation (address, dereference, cast)
+  akFunctionCall,                   ///< function call
+  akDesignator,                     ///< designator
+  akArrayDesignator,                ///< array designator
+  akConstant,                       ///< constant
+  akStringConstant,                 ///< string constant
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief flattened AST
+///
+/// compact representation of a module's AST. Nodes are numbered in pre-order and stored in
+/// parallel arrays (struct of arrays): a kind tag, an operation, two 32-bit child indices, a
+/// 32-bit sibling index, a value, a type and a symbol. Traversals dispatch on the kind tag with
+/// a switch instead of calling virtual methods.
+///
+/// The meaning of the child, sibling and value fields depends on the kind:
+///
+///   kind              | a             | b               | next              | value
+///   ------------------|---------------|-----------------|-------------------|-----------------
+///   module/procedure  | statements    | nested scopes   | next scope        | scope number
+///   assign            | lhs           | rhs             | next statement    |
+///   call              | function call |                 | next statement    |
+///   return            | expression    | scope           | next statement    |
+///   if                | condition     | if body         | next statement    | else body
+///   while             | condition     | body            | next statement    |
+///   binary op         | left operand  | right operand   | next arg/index    |
+///   unary/special op  | operand       |                 | next arg/index    |
+///   function call     | arguments     |                 | next arg/index    | number of args
+///   array designator  | indices       |                 | next arg/index    | number of indices
+///   constant          |               |                 | next arg/index    | value
+///
+/// Absent nodes are represented by CAstFlat::None. Symbol tables, symbols and types are shared
+/// with the AST the flattened form has been built from; the module must outlive it.
+///
+/// Type checking and TAC generation produce the same results as the corresponding methods of the
+/// AST classes (including their error messages).
+///
+
+class CAstFlat {
+  public:
+    /// @brief index of an absent node
+    static const unsigned int None = 0xffffffff;
+
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief flatten the AST of a module
+    /// @param m module
+    CAstFlat(const CAstModule *m);
+
+    /// @}
+
+    /// @name properties
+    /// @{
+
+    /// @brief return the number of nodes
+    size_t GetNumNodes(void) const { return _kind.size(); };
+
+    /// @brief return the kind of node @a n
+    EAstKind GetKind(unsigned int n) const { return (EAstKind)_kind[n]; };
+
+    /// @brief return the operation of node @a n
+    EOperation GetOperation(unsigned int n) const { return (EOperation)_op[n]; };
+
+    /// @brief return the first child of node @a n
+    unsigned int GetA(unsigned int n) const { return _a[n]; };
+
+    /// @brief return the second child of node @a n
+    unsigned int GetB(unsigned int n) const { return _b[n]; };
+
+    /// @brief return the next sibling of node @a n
+    unsigned int GetNext(unsigned int n) const { return _next[n]; };
+
+    /// @brief return the value of node @a n
+    long long GetValue(unsigned int n) const { return _value[n]; };
+
+    /// @brief return the symbol of node @a n
+    const CSymbol* GetSymbol(unsigned int n) const { return _sym[n]; };
+
+    /// @brief return the token of node @a n
+    CToken GetToken(unsigned int n) const { return _node[n]->GetToken(); };
+
+    /// @brief return the AST scope of the scope node @a n
+    CAstScope* GetScope(unsigned int n) const;
+
+    /// @brief return the node of an AST scope
+    /// @param s AST scope
+    /// @retval node index or None if @a s is not part of the flattened AST
+    unsigned int FindScope(const CAstScope *s) const;
+
+    /// @}
+
+    /// @name type management
+    /// @{
+
+    /// @brief return (compute) the type of node @a n
+    const CType* GetType(unsigned int n) const;
+
+    /// @brief perform type checking of the whole module
+    /// @param t (out, optional) type error at token t
+    /// @param msg (out, optional) type error message
+    /// @retval true if no type error has been found
+    /// @retval false otherwise
+    bool TypeCheck(CToken *t, string *msg) const;
+
+    /// @}
+
+    /// @name transformation into TAC
+    /// @{
+
+    /// @brief generate TAC for the statements of a scope
+    /// @param scope scope node
+    /// @param cb code block of the scope
+    void ToTac(unsigned int scope, CCodeBlock *cb) const;
+
+    /// @}
+
+  private:
+    /// @name construction
+    /// @{
+
+    unsigned int Add(EAstKind kind, const CAstNode *n);
+    unsigned int FlattenScope(const CAstScope *s);
+    unsigned int FlattenStatements(const CAstStatement *s);
+    unsigned int FlattenStatement(const CAstStatement *s);
+    unsigned int FlattenExpression(const CAstExpression *e);
+
+    /// @}
+
+    /// @name type checking
+    /// @{
+
+    bool TypeCheckScope(unsigned int n, CToken *t, string *msg) const;
+    bool TypeCheckNode(unsigned int n, CToken *t, string *msg) const;
+    void SetError(unsigned int n, CToken *t, string *msg, const char *message) const;
+
+    /// @}
+
+    /// @name TAC generation
+    /// @{
+
+    void StatementsToTac(unsigned int n, CCodeBlock *cb) const;
+    void StatementToTac(unsigned int n, CCodeBlock *cb, CTacLabel *next) const;
+    void ArgsToTac(unsigned int n, int i, const CType *type, CCodeBlock *cb) const;
+    CTacAddr* ExpressionToTac(unsigned int n, CCodeBlock *cb) const;
+    CTacAddr* ConditionToTac(unsigned int n, CCodeBlock *cb,
+                             CTacLabel *ltrue, CTacLabel *lfalse) const;
+    CTacAddr* ArrayToTac(unsigned int n, CCodeBlock *cb) const;
+    CTacAddr* ArrayBaseToTac(unsigned int n, CCodeBlock *cb) const;
+    CTacAddr* ArrayCallToTac(const CSymbol *proc, unsigned int n, int dim,
+                             CCodeBlock *cb) const;
+
+    /// @}
+
+    vector<unsigned char> _kind;    ///< node kind (EAstKind)
+    vector<unsigned char> _op;      ///< operation (EOperation)
+    vector<unsigned int> _a;        ///< first child
+    vector<unsigned int> _b;        ///< second child
+    vector<unsigned int> _next;     ///< next sibling
+    vector<long long> _value;       ///< value (see class description)
+    vector<const CType*> _type;     ///< type of constants and casts
+    vector<const CSymbol*> _sym;    ///< symbol of designators, calls and procedures
+    vector<const CAstNode*> _node;  ///< originating AST node (error reporting, array runtime)
+
+    vector<CAstScope*> _scopes;     ///< AST scopes by scope number
+    map<const CAstScope*, unsigned int> _scope_node; ///< node of every AST scope
+};
+
+#endif // __SnuPL_ASTFLAT_H__
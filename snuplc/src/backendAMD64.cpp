@@ -100,7 +100,7 @@ void CBackendAMD64::EmitCode(void)
 
   // emit external function declarations
   CSymtab *st = _m->GetSymbolTable(); assert(st != NULL);
-  vector<CSymbol*> sym = st->GetSymbols();
+  const vector<CSymbol*> &sym = st->GetSymbols();
   auto symit = sym.cbegin();
   while (symit != sym.cend()) {
     CSymbol *s = *symit++;
@@ -112,8 +112,6 @@ void CBackendAMD64::EmitCode(void)
       }
     }
   }
-	_out << _ind << ".extern " << "DOFS" << endl;
-	_out << _ind << ".extern " << "DIM" << endl;
 
   _out << endl
        << endl;
@@ -266,7 +264,7 @@ void CBackendAMD64::EmitGlobalData(CScope *scope)
 
   bool header = false;
 
-  vector<CSymbol*> slist = st->GetSymbols();
+  const vector<CSymbol*> &slist = st->GetSymbols();
 
   _out << dec;
 
@@ -360,10 +358,7 @@ void CBackendAMD64::EmitCodeBlock(CCodeBlock *cb, StackFrame &paf)
 {
   assert(cb != NULL);
 
-  const list<CTacInstr*> &instr = cb->GetInstr();
-  list<CTacInstr*>::const_iterator it = instr.begin();
-
-  while (it != instr.end()) EmitInstruction(*it++, paf);
+  for (CTacInstr *i = cb->GetFirst(); i != NULL; i = i->GetNext()) EmitInstruction(i, paf);
 }
 
 void CBackendAMD64::EmitInstruction(CTacInstr *i, StackFrame &paf)
@@ -409,6 +404,8 @@ void CBackendAMD64::EmitInstruction(CTacInstr *i, StackFrame &paf)
 		case opAnd:
 			operation = "andq";
 			break;
+		default:
+			assert(false);
 		}
 
 		reg = rAX;
@@ -441,6 +438,10 @@ void CBackendAMD64::EmitInstruction(CTacInstr *i, StackFrame &paf)
 		case opNot:
 			operation = "notq";
 			break;
+		case opPos:
+			break;
+		default:
+			assert(false);
 		}
 
 		reg = rAX;
@@ -475,7 +476,7 @@ void CBackendAMD64::EmitInstruction(CTacInstr *i, StackFrame &paf)
     // unconditional branching
     // goto dst
 	case opGoto:
-		EmitInstruction("jmp", Label(dynamic_cast<const CTacLabel*>(i->GetDest())), cmt.str());
+		EmitInstruction("jmp", Label(cast<CTacLabel>(i->GetDest())), cmt.str());
 		break;
 
     // conditional branching
@@ -490,7 +491,7 @@ void CBackendAMD64::EmitInstruction(CTacInstr *i, StackFrame &paf)
 
     // function call-related operations
   	case opCall:
-		EmitInstruction("call",dynamic_cast<const CSymProc*>(dynamic_cast<const CTacName*>(i->GetSrc(1))->GetSymbol())->GetName(), cmt.str());
+		EmitInstruction("call",dynamic_cast<const CSymProc*>(cast<CTacName>(i->GetSrc(1))->GetSymbol())->GetName(), cmt.str());
 		break;
 	case opReturn:
 		if (i->GetSrc(1)){
@@ -512,13 +513,19 @@ void CBackendAMD64::EmitInstruction(CTacInstr *i, StackFrame &paf)
 
 		// special
 	case opLabel:
-		_out << Label(dynamic_cast<CTacLabel*>(i)) << ":" << endl;
+		_out << Label(cast<CTacLabel>(i)) << ":" << endl;
 		break;
 
 	case opNop:
 		EmitInstruction("nop", "", cmt.str());
 		break;
 
+	// static single assignment
+	case opPhi:
+		// phi functions are removed by DestructSSA() before code generation
+		assert(false);
+		break;
+
 	default:
 		EmitInstruction("# ???", "not implemented", cmt.str());
 	}
@@ -583,14 +590,20 @@ string CBackendAMD64::Operand(const CTac *op)
 	string operand = "?";
 
 	// Case constant
-	const auto *opCst = dynamic_cast<const CTacConst*>(op);
+	const auto *opCst = dyn_cast<CTacConst>(op);
 	if (opCst) {
 		operand = "$" + to_string(opCst->GetValue());
 		return operand;
 	}
 
+	// Case temporary or reference held in a temporary (allocated on the stack like local variables)
+	if (isa<CTacTemp>(op) || isa<CTacReference>(op)) {
+		operand = "(%?)";
+		return operand;
+	}
+
 	// Case name
-	const auto *opName = dynamic_cast<const CTacName*>(op);
+	const auto *opName = dyn_cast<CTacName>(op);
 	if (opName)
 	{
 		const CSymbol* symbol = opName->GetSymbol();
@@ -607,7 +620,7 @@ string CBackendAMD64::Operand(const CTac *op)
 	}
 
 	// Hint: references (op of type CTacReference) require special care
-	const auto *opRef = dynamic_cast<const CTacName*>(op);
+	const auto *opRef = dyn_cast<CTacReference>(op);
 	if (opRef){
 
 	}
@@ -651,14 +664,20 @@ int CBackendAMD64::OperandSize(CTac *t) const
 {
 	int size = 8;
 
+	// Case temporary or reference held in a temporary (size of the temporary)
+	if (isa<CTacTemp>(t) || isa<CTacReference>(t)) {
+		size = cast<CTacAddr>(t)->GetType()->GetDataSize();
+		return size;
+	}
+
 	// Case name
-	auto *name = dynamic_cast<CTacName*>(t);
+	auto *name = dyn_cast<CTacName>(t);
 	if (name != NULL) {
 		size = name->GetSymbol()->GetDataType()->GetDataSize();
 		return size;
 	}
 
-	CTacReference *tRef = dynamic_cast<CTacReference*>(t);
+	CTacReference *tRef = dyn_cast<CTacReference>(t);
 	if (tRef) {
 		const CType *dataType = tRef->GetDerefSymbol()->GetDataType();
 		// Hint: also here references (incl. references to pointers) and arrays need special care.
@@ -744,6 +763,13 @@ void CBackendAMD64::ComputeStackOffsets(CScope *scope, StackFrame &paf)
 		}
 	}
 
+	// temporaries are not part of the symbol table
+	for (const auto temp : scope->GetTemps()){
+		if (temp->GetType()->IsInt()){
+			paf.padding += 4;
+		}
+	}
+
 	paf.size = paf.return_address + paf.saved_registers + paf.padding + paf.saved_parameters + paf.local_variables + paf.argument_build;
 
 
@@ -0,0 +1,188 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL flattened AST benchmark
+///
+/// compares type checking and TAC generation on the AST class hierarchy with the same operations
+/// on the flattened AST (CAstFlat) and verifies that both produce identical results. Also reports
+/// the heap allocations of TAC generation, the time to release the TAC and the peak resident set
+/// size.
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <sys/resource.h>
+
+#include "scanner.h"
+#include "parser.h"
+#include "ir.h"
+using namespace std;
+
+/// number of type checking rounds
+static const int ROUNDS = 5;
+
+/// number of heap allocations performed through operator new
+static atomic<size_t> allocations(0);
+
+void* operator new(size_t size)
+{
+  allocations++;
+  void *p = malloc(size > 0 ? size : 1);
+  if (p == NULL) throw bad_alloc();
+  return p;
+}
+
+void operator delete(void *ptr) noexcept
+{
+  free(ptr);
+}
+
+/// @brief return the seconds elapsed since @a t0
+static double Elapsed(chrono::steady_clock::time_point t0)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+/// @brief result of one benchmark run
+struct SRun {
+  double typecheck;                 ///< time for ROUNDS rounds of type checking
+  double totac;                     ///< time to generate the TAC of the module
+  size_t allocs;                    ///< heap allocations while generating the TAC
+  double release;                   ///< time to release the TAC
+  double flatten;                   ///< time to flatten the AST (flat runs only)
+  size_t nodes;                     ///< number of flat nodes (flat runs only)
+  string result;                    ///< type checking result and TAC
+};
+
+/// @brief parse a file and type check and lower it, either through the AST class hierarchy
+///        or through the flattened AST
+///
+/// @param fn file name
+/// @param flat use the flattened AST
+/// @param r result (output)
+/// @retval true on success
+/// @retval false if the file could not be parsed
+static bool Run(const char *fn, bool flat, SRun &r)
+{
+  // string constants are numbered globally; restart numbering for every run
+  static const int strbase = CAstStringConstant::GetIndex();
+  CAstStringConstant::SetIndex(strbase);
+
+  CScanner *s = CScanner::FromFile(fn);
+  CParser *p = new CParser(s);
+  CAstModule *m = dynamic_cast<CAstModule*>(p->Parse());
+
+  if (p->HasError()) {
+    const CToken *error = p->GetErrorToken();
+    cout << fn << ": parse error at " << error->GetLineNumber() << ":"
+         << error->GetCharPosition() << " : " << p->GetErrorMessage() << endl;
+    delete p;
+    delete s;
+    return false;
+  }
+
+  chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+  CAstFlat *f = flat ? p->Flatten() : NULL;
+  r.flatten = Elapsed(t0);
+  r.nodes = f != NULL ? f->GetNumNodes() : 0;
+
+  CToken t;
+  string msg;
+  bool ok = true;
+  t0 = chrono::steady_clock::now();
+  for (int i=0; i<ROUNDS; i++) {
+    ok = f != NULL ? f->TypeCheck(&t, &msg) : m->TypeCheck(&t, &msg);
+  }
+  r.typecheck = Elapsed(t0);
+
+  ostringstream o;
+  if (!ok) {
+    o << "semantic error at " << t.GetLineNumber() << ":" << t.GetCharPosition()
+      << " : " << msg << endl;
+  }
+
+  // the TAC is generated regardless of the outcome of type checking; the type checker rejects
+  // many valid programs
+  size_t a0 = allocations;
+  t0 = chrono::steady_clock::now();
+  CModule *tac = new CModule(m, f);
+  r.totac = Elapsed(t0);
+  r.allocs = allocations - a0;
+
+  o << tac << endl;
+  r.result = o.str();
+
+  t0 = chrono::steady_clock::now();
+  delete tac;
+  r.release = Elapsed(t0);
+  delete f;
+  delete m;
+  delete p;
+  delete s;
+
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2) {
+    cout << "Usage: bench_ast FILE..." << endl;
+    return EXIT_FAILURE;
+  }
+
+  cout << "                     type check          TAC generation    TAC allocations"
+       << "   TAC release" << endl
+       << "  nodes  flatten    tree    flat          tree    flat       tree     flat"
+       << "    tree    flat   file" << endl;
+
+  for (int i=1; i<argc; i++) {
+    SRun tree, flat;
+    if (!Run(argv[i], false, tree) || !Run(argv[i], true, flat)) return EXIT_FAILURE;
+
+    if (tree.result != flat.result) {
+      cout << argv[i] << ": type checking or TAC of the flattened AST differs." << endl;
+      return EXIT_FAILURE;
+    }
+
+    cout << fixed << setprecision(3)
+         << setw(7) << flat.nodes << "  " << setw(6) << flat.flatten << "s"
+         << "  " << setw(6) << tree.typecheck << "s" << " " << setw(6) << flat.typecheck << "s"
+         << "        " << setw(6) << tree.totac << "s" << " " << setw(6) << flat.totac << "s"
+         << "  " << setw(9) << tree.allocs << " " << setw(8) << flat.allocs
+         << "  " << setw(6) << tree.release << "s" << " " << setw(6) << flat.release << "s"
+         << "   " << argv[i] << endl;
+  }
+
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  cout << "peak RSS: " << ru.ru_maxrss / 1024 << " MB" << endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL expression depth benchmark
+///
+/// type checks pathologically deep expression trees of increasing depth and verifies that the
+/// time grows linearly with the depth
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+#include "ast.h"
+using namespace std;
+
+/// number of depths measured (each twice the previous one)
+static const int STEPS = 4;
+
+/// @brief return the seconds elapsed since @a t0
+static double Elapsed(chrono::steady_clock::time_point t0)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+/// @brief build and type check an expression tree of depth @a depth
+///
+/// The expression alternately takes the address of and dereferences an integer variable,
+/// i.e., *&*&...*&x. The type of every special operation depends on the type of its operand,
+/// so recomputing types on every query makes type checking quadratic in the depth.
+///
+/// @param depth number of nested operations (even)
+/// @retval time in seconds for type checking and querying the type of the expression
+static double Run(int depth)
+{
+  CToken t;
+  CAstModule *m = new CAstModule(t, "depth");
+  CAstArena *prev = CAstArena::SetCurrent(m->GetArena());
+
+  CSymbol *x = new CSymGlobal("x", CTypeManager::Get()->GetInteger());
+  m->GetSymbolTable()->AddSymbol(x);
+
+  CAstExpression *e = new CAstDesignator(t, x);
+  for (int i=0; i<depth; i++) {
+    e = new CAstSpecialOp(t, i % 2 == 0 ? opAddress : opDeref, e, NULL);
+  }
+
+  chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+  string msg;
+  bool ok = e->TypeCheck(&t, &msg) && (e->GetType() == x->GetDataType());
+  double time = Elapsed(t0);
+
+  CAstArena::SetCurrent(prev);
+  delete m;
+
+  if (!ok) {
+    cout << "type checking an expression of depth " << depth << " failed: " << msg << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  return time;
+}
+
+int main(int argc, char *argv[])
+{
+  int depth = argc > 1 ? atoi(argv[1]) : 2000;
+  if ((depth <= 0) || (depth % 2 != 0)) {
+    cout << "Usage: bench_depth [INITIAL DEPTH (even)]" << endl;
+    return EXIT_FAILURE;
+  }
+
+  cout << "   depth        time   time/node" << endl;
+
+  double first = 0.0, last = 0.0;
+  for (int i=0; i<STEPS; i++, depth *= 2) {
+    last = Run(depth);
+    if (i == 0) first = last;
+    cout << fixed << setprecision(6)
+         << setw(8) << depth << "  " << setw(9) << last << "s  "
+         << setprecision(1) << setw(8) << last/depth*1e9 << "ns" << endl;
+  }
+
+  // the depth grows by a factor of 2^(STEPS-1). Linear time grows by the same factor,
+  // quadratic time by its square; accept anything below three times the linear growth.
+  double growth = last/first, linear = 1 << (STEPS-1);
+  cout << "growth: " << setprecision(1) << growth << "x (linear: " << linear << "x)" << endl;
+
+  if ((first > 0.0) && (growth > 3*linear)) {
+    cout << "type checking time grows superlinearly with the expression depth." << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
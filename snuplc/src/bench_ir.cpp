@@ -0,0 +1,218 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL IR benchmark
+///
+/// times TAC generation, control flow cleanup, assembly emission, renaming of temporaries
+/// through their def-use chains, control flow graph construction, liveness analysis and
+/// conversion into and out of SSA form for a procedure with a large number of instructions
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "scanner.h"
+#include "parser.h"
+#include "ir.h"
+#include "cfg.h"
+#include "dataflow.h"
+#include "ssa.h"
+#include "backendAMD64.h"
+using namespace std;
+
+/// @brief return the seconds elapsed since @a t0
+static double Elapsed(chrono::steady_clock::time_point t0)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+/// @brief generate a module with a procedure of @a n if statements
+static string Generate(int n)
+{
+  ostringstream o;
+  o << "module ir;" << endl
+    << endl
+    << "procedure p(a, b: integer);" << endl
+    << "begin" << endl;
+  for (int i=0; i<n; i++) {
+    o << "  if (a > b) then a := a - b else b := b - a end;" << endl;
+  }
+  // the last statement of a sequence is not part of the AST
+  o << "  a := b" << endl
+    << "end p;" << endl
+    << endl
+    << "begin" << endl
+    << "end ir." << endl;
+  return o.str();
+}
+
+/// @brief fill @a cb with @a n instructions, three fifths of which CleanupControlFlow() removes
+///
+///   a <- a + b; if a < b goto l1; goto l2; l2: l1:
+///
+/// (temporaries are owned by the scope and must not outlive @a cb, so none are used)
+///
+/// @retval number of instructions added
+static size_t Fill(CCodeBlock *cb, const CSymbol *a, const CSymbol *b, size_t n)
+{
+  CTacArena *prev = CTacArena::SetCurrent(cb->GetArena());
+
+  size_t count = 0;
+  while (count < n) {
+    CTacLabel *l1 = cb->CreateLabel();
+    CTacLabel *l2 = cb->CreateLabel();
+
+    cb->AddInstr(new CTacInstr(opAdd, new CTacName(a), new CTacName(a), new CTacName(b)));
+    cb->AddInstr(new CTacInstr(opLessThan, l1, new CTacName(a), new CTacName(b)));
+    cb->AddInstr(new CTacInstr(opGoto, l2));
+    cb->AddInstr(l2);
+    cb->AddInstr(l1);
+    count += 5;
+  }
+
+  CTacArena::SetCurrent(prev);
+  return count;
+}
+
+int main(int argc, char *argv[])
+{
+  int n = argc > 1 ? atoi(argv[1]) : 100000;
+  if (n <= 0) {
+    cout << "Usage: bench_ir [NUMBER OF INSTRUCTIONS]" << endl;
+    return EXIT_FAILURE;
+  }
+
+  // every if statement is lowered to 8 instructions
+  CScanner *s = new CScanner(Generate(n / 8));
+  CParser *p = new CParser(s);
+  CAstModule *m = dynamic_cast<CAstModule*>(p->Parse());
+  if (p->HasError()) {
+    const CToken *error = p->GetErrorToken();
+    cout << "parse error at " << error->GetLineNumber() << ":" << error->GetCharPosition()
+         << " : " << p->GetErrorMessage() << endl;
+    return EXIT_FAILURE;
+  }
+
+  // TAC generation (includes CleanupControlFlow())
+  chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+  CModule *tac = new CModule(m);
+  double totac = Elapsed(t0);
+
+  CScope *proc = tac->GetSubscopes()[0];
+  size_t ninstr = proc->GetCodeBlock()->GetNumInstr();
+
+  // control flow cleanup on a synthetic block
+  CSymtab *st = proc->GetSymbolTable();
+  const CSymbol *a = st->FindSymbol("a"), *b = st->FindSymbol("b");
+  CCodeBlock *cb = new CCodeBlock(proc);
+  size_t nfill = Fill(cb, a, b, n);
+
+  t0 = chrono::steady_clock::now();
+  cb->CleanupControlFlow();
+  double cleanup = Elapsed(t0);
+  size_t nclean = cb->GetNumInstr();
+  delete cb;
+
+  // assembly emission
+  ostringstream out;
+  CBackendAMD64 *be = new CBackendAMD64(out);
+  t0 = chrono::steady_clock::now();
+  be->Emit(tac);
+  double emit = Elapsed(t0);
+
+  // def-use chains: rename every temporary of the procedure
+  vector<CTacTemp*> temps(proc->GetTemps());
+  size_t nuses = 0;
+  CTacArena *prev = CTacArena::SetCurrent(proc->GetCodeBlock()->GetArena());
+  t0 = chrono::steady_clock::now();
+  for (size_t i=0; i<temps.size(); i++) {
+    CTacTemp *t = temps[i], *r = proc->CreateTemp(t->GetType());
+
+    while (t->GetDefs() != NULL) t->GetDefs()->GetUser()->SetDest(r);
+    for (CTacUse *u = t->GetUses(); u != NULL; u = u->GetNext()) nuses++;
+    t->ReplaceAllUsesWith(r);
+  }
+  double rename = Elapsed(t0);
+  CTacArena::SetCurrent(prev);
+
+  // control flow graph with dominator tree and loops
+  t0 = chrono::steady_clock::now();
+  CCfg *cfg = new CCfg(proc->GetCodeBlock());
+  double buildcfg = Elapsed(t0);
+  size_t nblocks = cfg->GetBlocks().size();
+
+  // liveness analysis
+  t0 = chrono::steady_clock::now();
+  CLiveness *live = new CLiveness(cfg);
+  double liveness = Elapsed(t0);
+  size_t nvars = live->GetSize(), nvisits = live->GetNumVisits();
+  delete live;
+  delete cfg;
+
+  // SSA construction and destruction
+  CCodeBlock *pcb = proc->GetCodeBlock();
+  t0 = chrono::steady_clock::now();
+  ConstructSSA(pcb);
+  double tossa = Elapsed(t0);
+  size_t nphis = 0;
+  for (CTacInstr *i = pcb->GetFirst(); i != NULL; i = i->GetNext()) {
+    if (isa<CTacPhi>(i)) nphis++;
+  }
+
+  t0 = chrono::steady_clock::now();
+  DestructSSA(pcb);
+  double fromssa = Elapsed(t0);
+  size_t nout = pcb->GetNumInstr();
+
+  cout << fixed << setprecision(3)
+       << "TAC generation:        " << setw(7) << ninstr << " instructions  "
+       << setw(6) << totac << "s" << endl
+       << "control flow cleanup:  " << setw(7) << nfill << " instructions  "
+       << setw(6) << cleanup << "s  (" << nclean << " remaining)" << endl
+       << "assembly emission:     " << setw(7) << ninstr << " instructions  "
+       << setw(6) << emit << "s  (" << out.str().size() / 1024 << " KB)" << endl
+       << "temporary renaming:    " << setw(7) << temps.size() << " temporaries   "
+       << setw(6) << rename << "s  (" << nuses << " uses)" << endl
+       << "control flow graph:    " << setw(7) << ninstr << " instructions  "
+       << setw(6) << buildcfg << "s  (" << nblocks << " blocks)" << endl
+       << "liveness analysis:     " << setw(7) << ninstr << " instructions  "
+       << setw(6) << liveness << "s  (" << nvars << " variables, " << nvisits << " block visits)"
+       << endl
+       << "SSA construction:      " << setw(7) << ninstr << " instructions  "
+       << setw(6) << tossa << "s  (" << nphis << " phi functions)" << endl
+       << "SSA destruction:       " << setw(7) << ninstr << " instructions  "
+       << setw(6) << fromssa << "s  (" << nout << " remaining)" << endl;
+
+  delete be;
+  delete tac;
+  delete m;
+  delete p;
+  delete s;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL keyword classification microbenchmark
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#include "scanner.h"
+using namespace std;
+
+/// @brief number of passes over the lexeme list per measurement
+#define PASSES 200
+
+/// @brief keyword table as used by the former map-based classification (reference)
+static const pair<const char*, EToken> Keywords[] =
+{
+  {"module", tModule},
+  {"procedure", tProcedure},
+  {"function", tFunction},
+  {"var", tVarDecl},
+  {"const", tConstDecl},
+  {"integer", tInteger},
+  {"char", tChar},
+  {"boolean", tBoolean},
+  {"begin", tBegin},
+  {"end", tEnd},
+  {"if", tIf},
+  {"then", tThen},
+  {"else", tElse},
+  {"while", tWhile},
+  {"do", tDo},
+  {"return", tReturn},
+  {"true", tBoolConst},
+  {"false", tBoolConst},
+};
+
+/// @brief built-in lexemes used when no input files are given
+static const char* Sample[] =
+{
+  "module", "procedure", "function", "var", "const", "integer", "char", "boolean",
+  "begin", "end", "if", "then", "else", "while", "do", "return", "true", "false",
+  "i", "j", "n", "x", "tmp", "sum", "dim", "ReadInt", "WriteInt", "WriteLn", "fib",
+  "factorial", "endless", "iff", "double", "truth", "modules", "procedures", "a2", "c",
+  "array", "counter", "result", "value", "primes", "matrix", "index", "DOFS", "DIM",
+};
+
+int main(int argc, char *argv[])
+{
+  vector<string> lexemes;
+
+  // collect identifier-shaped lexemes (identifiers and keywords) from the input files
+  for (int i=1; i<argc; i++) {
+    CScanner *s = CScanner::FromFile(argv[i]);
+
+    while (s->Good()) {
+      CToken t = s->Get();
+      if (t.GetType() == tEOF) break;
+
+      const string &v = t.GetValue();
+      if ((t.GetType() == tIdent) || (CScanner::Keyword(v.data(), v.size()) == t.GetType())) {
+        lexemes.push_back(v);
+      }
+    }
+
+    delete s;
+  }
+
+  if (lexemes.size() == 0) {
+    for (size_t i=0; i<sizeof(Sample)/sizeof(Sample[0]); i++) lexemes.push_back(Sample[i]);
+  }
+
+  map<string, EToken> keywords;
+  for (size_t i=0; i<sizeof(Keywords)/sizeof(Keywords[0]); i++) {
+    keywords[Keywords[i].first] = Keywords[i].second;
+  }
+
+  // both classifications must agree
+  for (size_t i=0; i<lexemes.size(); i++) {
+    map<string, EToken>::const_iterator it = keywords.find(lexemes[i]);
+    EToken ref = (it != keywords.end()) ? it->second : tIdent;
+    if (CScanner::Keyword(lexemes[i].data(), lexemes[i].size()) != ref) {
+      cout << "classification mismatch for '" << lexemes[i] << "'" << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  size_t n = lexemes.size() * PASSES;
+  unsigned long long check_map = 0, check_switch = 0;
+
+  chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+  for (int p=0; p<PASSES; p++) {
+    for (size_t i=0; i<lexemes.size(); i++) {
+      map<string, EToken>::const_iterator it = keywords.find(lexemes[i]);
+      check_map += (it != keywords.end()) ? it->second : tIdent;
+    }
+  }
+  chrono::steady_clock::time_point t1 = chrono::steady_clock::now();
+  for (int p=0; p<PASSES; p++) {
+    for (size_t i=0; i<lexemes.size(); i++) {
+      check_switch += CScanner::Keyword(lexemes[i].data(), lexemes[i].size());
+    }
+  }
+  chrono::steady_clock::time_point t2 = chrono::steady_clock::now();
+
+  double ns_map = chrono::duration<double, nano>(t1 - t0).count() / n;
+  double ns_switch = chrono::duration<double, nano>(t2 - t1).count() / n;
+
+  cout << lexemes.size() << " lexemes x " << PASSES << " passes" << endl
+       << "  map<string, EToken>:  " << ns_map << " ns/lexeme" << endl
+       << "  CScanner::Keyword():  " << ns_switch << " ns/lexeme" << endl;
+
+  return (check_map == check_switch) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
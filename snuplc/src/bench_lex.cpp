@@ -0,0 +1,98 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL parallel lexing benchmark
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "scanner.h"
+using namespace std;
+
+/// @brief lex a file with a given number of threads and return all tokens
+///
+/// @param fn file name
+/// @param nthreads number of threads
+/// @param tokens token sequence (output)
+/// @retval time in seconds
+static double Lex(const char *fn, unsigned int nthreads, vector<CToken> &tokens)
+{
+  chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+
+  CScanner *s = CScanner::FromFile(fn);
+  s->ScanParallel(nthreads);
+
+  while (s->Good()) {
+    CToken t = s->Get();
+    tokens.push_back(t);
+    if (t.GetType() == tEOF) break;
+  }
+
+  chrono::steady_clock::time_point t1 = chrono::steady_clock::now();
+  delete s;
+
+  return chrono::duration<double>(t1 - t0).count();
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2) {
+    cout << "Usage: bench_lex FILE [MAXTHREADS]" << endl;
+    return EXIT_FAILURE;
+  }
+
+  unsigned int max = (argc > 2) ? atoi(argv[2]) : 16;
+
+  vector<CToken> reference;
+  double serial = Lex(argv[1], 1, reference);
+
+  cout << argv[1] << ": " << reference.size() << " tokens" << endl
+       << "  threads      time   speedup" << endl;
+
+  for (unsigned int n=1; n<=max; n*=2) {
+    vector<CToken> tokens;
+    double t = Lex(argv[1], n, tokens);
+
+    // the token sequence must not depend on the number of threads
+    bool same = tokens.size() == reference.size();
+    for (size_t i=0; same && (i<tokens.size()); i++) {
+      same = (tokens[i].GetType() == reference[i].GetType()) &&
+             (tokens[i].GetValueId() == reference[i].GetValueId()) &&
+             (tokens[i].GetLineNumber() == reference[i].GetLineNumber()) &&
+             (tokens[i].GetCharPosition() == reference[i].GetCharPosition());
+    }
+    if (!same) {
+      cout << "  token sequence with " << n << " threads differs." << endl;
+      return EXIT_FAILURE;
+    }
+
+    cout << "  " << setw(7) << n << "  " << fixed << setprecision(3) << setw(7) << t << "s"
+         << "  " << setprecision(2) << setw(7) << serial / t << endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL parallel parsing benchmark
+///
+/// times the parser with increasing numbers of threads and reports the number of heap
+/// allocations and the peak resident set size of the serial parse
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <sys/resource.h>
+
+#include "scanner.h"
+#include "parser.h"
+using namespace std;
+
+/// number of heap allocations performed through operator new
+static atomic<size_t> allocations(0);
+
+void* operator new(size_t size)
+{
+  allocations++;
+  void *p = malloc(size > 0 ? size : 1);
+  if (p == NULL) throw bad_alloc();
+  return p;
+}
+
+void operator delete(void *ptr) noexcept
+{
+  free(ptr);
+}
+
+/// @brief parse a file with a given number of threads and print the AST
+///
+/// @param fn file name
+/// @param nthreads number of threads
+/// @param out textual AST or error message (output)
+/// @param allocs number of heap allocations while parsing (output, optional)
+/// @param rss peak resident set size in KB after parsing (output, optional)
+/// @retval time in seconds
+static double Parse(const char *fn, unsigned int nthreads, string &out, size_t *allocs=NULL,
+                    long *rss=NULL)
+{
+  // string constants are numbered globally; restart numbering for every run
+  static const int strbase = CAstStringConstant::GetIndex();
+  CAstStringConstant::SetIndex(strbase);
+
+  chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+
+  CScanner *s = CScanner::FromFile(fn);
+  CParser *p = new CParser(s);
+  p->ParseParallel(nthreads);
+
+  size_t a0 = allocations;
+  CAstNode *ast = p->Parse();
+  if (allocs != NULL) *allocs = allocations - a0;
+
+  if (rss != NULL) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    *rss = ru.ru_maxrss;
+  }
+
+  chrono::steady_clock::time_point t1 = chrono::steady_clock::now();
+
+  ostringstream o;
+  if (p->HasError()) {
+    const CToken *error = p->GetErrorToken();
+    o << "parse error at " << error->GetLineNumber() << ":" << error->GetCharPosition()
+      << " : " << p->GetErrorMessage() << endl;
+  } else {
+    ast->print(o, 0);
+    dynamic_cast<CAstScope*>(ast)->GetSymbolTable()->print(o, 0);
+  }
+  out = o.str();
+
+  delete p;
+  delete s;
+
+  return chrono::duration<double>(t1 - t0).count();
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2) {
+    cout << "Usage: bench_parse FILE [MAXTHREADS]" << endl;
+    return EXIT_FAILURE;
+  }
+
+  unsigned int max = (argc > 2) ? atoi(argv[2]) : 16;
+
+  string reference;
+  size_t allocs;
+  long rss;
+  double serial = Parse(argv[1], 1, reference, &allocs, &rss);
+
+  cout << argv[1] << ": " << reference.substr(0, reference.find('\n')) << endl
+       << "  heap allocations: " << allocs << ", peak RSS: " << rss / 1024 << " MB" << endl
+       << "  threads      time   speedup" << endl;
+
+  for (unsigned int n=1; n<=max; n*=2) {
+    string ast;
+    double t = Parse(argv[1], n, ast);
+
+    // the AST must not depend on the number of threads
+    if (ast != reference) {
+      cout << "  AST with " << n << " threads differs." << endl;
+      return EXIT_FAILURE;
+    }
+
+    cout << "  " << setw(7) << n << "  " << fixed << setprecision(3) << setw(7) << t << "s"
+         << "  " << setprecision(2) << setw(7) << serial / t << endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL single-pass compilation benchmark
+///
+/// times the classic front end (parse, type check, TAC generation) against single-pass
+/// compilation (CParser::Compile()), checks that both produce the same TAC and reports the peak
+/// resident set size after each
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <sys/resource.h>
+
+#include "scanner.h"
+#include "parser.h"
+#include "ir.h"
+using namespace std;
+
+/// @brief return the peak resident set size in MB
+static long PeakRSS(void)
+{
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_maxrss / 1024;
+}
+
+/// @brief compile a file and print its TAC to @a out
+///
+/// @param fn file name
+/// @param single use single-pass compilation
+/// @param out TAC or error message (output)
+/// @retval double time to parse, type check and generate the TAC
+static double Compile(const char *fn, bool single, string &out)
+{
+  // string constants are numbered globally; restart numbering for every run
+  static const int strbase = CAstStringConstant::GetIndex();
+  CAstStringConstant::SetIndex(strbase);
+
+  chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+
+  CScanner *s = CScanner::FromFile(fn);
+  CParser *p = new CParser(s);
+  CModule *tac = NULL;
+  CAstNode *ast = single ? p->Compile(&tac) : p->Parse();
+
+  CToken t;
+  string msg;
+  bool ok = !p->HasError();
+  if (ok && !single) {
+    ok = dynamic_cast<CAstModule*>(ast)->TypeCheck(&t, &msg);
+    if (ok) tac = new CModule(ast);
+  }
+
+  double time = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+  ostringstream o;
+  if (p->HasError()) {
+    const CToken *error = p->GetErrorToken();
+    o << (p->IsSemanticError() ? "semantic" : "parse") << " error at "
+      << error->GetLineNumber() << ":" << error->GetCharPosition()
+      << " : " << p->GetErrorMessage() << endl;
+  } else if (!ok) {
+    o << "semantic error at " << t.GetLineNumber() << ":" << t.GetCharPosition()
+      << " : " << msg << endl;
+  } else {
+    o << tac << endl;
+  }
+  out = o.str();
+
+  delete tac;
+  delete ast;
+  delete p;
+  delete s;
+
+  return time;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2) {
+    cout << "Usage: bench_single FILE..." << endl;
+    return EXIT_FAILURE;
+  }
+
+  cout << "                  classic               single-pass" << endl
+       << "  file       time  peak RSS        time  peak RSS" << endl;
+
+  for (int i=1; i<argc; i++) {
+    // the single-pass compiler runs first; its peak RSS is not affected by the classic run
+    string single, classic;
+    double ts = Compile(argv[i], true, single);
+    long rs = PeakRSS();
+    double tc = Compile(argv[i], false, classic);
+    long rc = PeakRSS();
+
+    // semantic errors may be found in a different order
+    if ((single != classic) && (single.compare(0, 9, "semantic ") != 0)) {
+      cout << argv[i] << ": single-pass compilation differs." << endl;
+      return EXIT_FAILURE;
+    }
+
+    cout << "  " << argv[i] << endl
+         << fixed << setprecision(3)
+         << "          " << setw(7) << tc << "s" << "  " << setw(5) << rc << " MB"
+         << "     " << setw(7) << ts << "s" << "  " << setw(5) << rs << " MB" << endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,173 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL TAC benchmark
+///
+/// reads modules in textual TAC form (.tac files written by snuplc --tac), runs the selected
+/// passes and assembly emission on them and reports the time of each step
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "ir.h"
+#include "pass.h"
+#include "tacparser.h"
+#include "backendAMD64.h"
+using namespace std;
+
+/// @brief return the seconds elapsed since @a t0
+static double Elapsed(chrono::steady_clock::time_point t0)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+/// @brief return the number of instructions of @a s and its subscopes
+static size_t NumInstr(const CScope *s)
+{
+  size_t n = s->GetCodeBlock()->GetNumInstr();
+  for (size_t i=0; i<s->GetSubscopes().size(); i++) n += NumInstr(s->GetSubscopes()[i]);
+  return n;
+}
+
+static void Syntax(void)
+{
+  cout << "Usage: bench_tac [-O<level>] [-p <pass>[,<pass>...]] [-v] FILE.tac..." << endl
+       << endl
+       << "  -O<level>  run the passes of optimization level <level>" << endl
+       << "  -p         run the given passes (after those of -O)" << endl
+       << "  -v         print the TAC after the passes" << endl
+       << endl
+       << "passes:";
+  vector<string> names = CPassManager::GetPassNames();
+  for (size_t i=0; i<names.size(); i++) cout << " " << names[i];
+  cout << endl;
+}
+
+int main(int argc, char *argv[])
+{
+  int level = 0;
+  vector<string> passes, files;
+  bool verbose = false;
+
+  for (int i=1; i<argc; i++) {
+    if (strncmp(argv[i], "-O", 2) == 0) {
+      level = atoi(argv[i]+2);
+      if (!CPassManager().AddPasses(level)) {
+        cout << "optimization level '" << argv[i]+2 << "' not supported." << endl;
+        return EXIT_FAILURE;
+      }
+    } else if ((strcmp(argv[i], "-p") == 0) && (i+1 < argc)) {
+      istringstream names(argv[++i]);
+      string name;
+      while (getline(names, name, ',')) {
+        CPass *pass = CPassManager::CreatePass(name);
+        if (pass == NULL) {
+          cout << "unknown pass '" << name << "'." << endl;
+          return EXIT_FAILURE;
+        }
+        delete pass;
+        passes.push_back(name);
+      }
+    } else if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else if (argv[i][0] == '-') {
+      Syntax();
+      return EXIT_FAILURE;
+    } else {
+      files.push_back(argv[i]);
+    }
+  }
+
+  if (files.empty()) {
+    Syntax();
+    return EXIT_FAILURE;
+  }
+
+  for (size_t f=0; f<files.size(); f++) {
+    ifstream in(files[f]);
+    if (!in) {
+      cout << "cannot open '" << files[f] << "'." << endl << endl;
+      continue;
+    }
+    cout << "reading '" << files[f] << "'..." << endl;
+
+    // TAC reader
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    CTacParser *tp = new CTacParser(&in);
+    CModule *m = tp->Parse();
+    double read = Elapsed(t0);
+
+    if (tp->HasError()) {
+      cout << "error at line " << tp->GetErrorLine() << " : " << tp->GetErrorMessage() << endl
+           << endl;
+      delete tp;
+      continue;
+    }
+    size_t ninstr = NumInstr(m);
+
+    // passes (timed per file)
+    CPassManager pm;
+    pm.AddPasses(level);
+    for (size_t p=0; p<passes.size(); p++) pm.AddPass(CPassManager::CreatePass(passes[p]));
+
+    t0 = chrono::steady_clock::now();
+    pm.Run(m);
+    double passes = Elapsed(t0);
+    size_t nopt = NumInstr(m);
+
+    if (verbose) cout << m << endl << endl;
+
+    // assembly emission
+    ostringstream out;
+    CBackendAMD64 *be = new CBackendAMD64(out);
+    t0 = chrono::steady_clock::now();
+    be->Emit(m);
+    double emit = Elapsed(t0);
+
+    cout << fixed << setprecision(3)
+         << "  TAC reader:            " << setw(7) << ninstr << " instructions  "
+         << setw(6) << read << "s  (" << m->GetSubscopes().size() + 1 << " scopes)" << endl
+         << "  IR passes:             " << setw(7) << ninstr << " instructions  "
+         << setw(6) << passes << "s  (" << nopt << " remaining)" << endl
+         << "  assembly emission:     " << setw(7) << nopt << " instructions  "
+         << setw(6) << emit << "s  (" << out.str().size() / 1024 << " KB)" << endl;
+    if (!pm.GetPasses().empty()) pm.PrintTimings(cout, 4);
+    cout << endl;
+
+    delete be;
+    delete m;
+    delete tp;
+  }
+
+  cout << "Done." << endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL type manager benchmark
+///
+/// parses a module with thousands of array declarations of distinct shapes, interns the same
+/// types again through the type manager and verifies that every type exists exactly once
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include <unistd.h>
+
+#include "scanner.h"
+#include "parser.h"
+using namespace std;
+
+/// @brief return the seconds elapsed since @a t0
+static double Elapsed(chrono::steady_clock::time_point t0)
+{
+  return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+/// @brief return the base type of the @a i-th declaration
+static const CType* BaseType(CTypeManager *tm, int i)
+{
+  switch (i % 3) {
+    case 0:  return tm->GetInteger();
+    case 1:  return tm->GetChar();
+    default: return tm->GetBool();
+  }
+}
+
+/// @brief return the SnuPL name of the base type of the @a i-th declaration
+static const char* BaseTypeName(int i)
+{
+  static const char *names[] = { "integer", "char", "boolean" };
+  return names[i % 3];
+}
+
+/// @brief return the dimensions of the @a i-th declaration
+///
+/// every declaration gets a distinct shape; the inner dimensions are shared among many
+/// declarations, so array types nest and their inner types are looked up over and over
+static vector<int> Shape(int i)
+{
+  vector<int> d;
+  d.push_back(i/3 + 1);
+  d.push_back(i%5 + 1);
+  if (i % 2 == 0) d.push_back(i%7 + 2);
+  return d;
+}
+
+/// @brief generate a module with @a n global array variables of distinct shapes
+static string Generate(int n)
+{
+  ostringstream o;
+  o << "module types;" << endl
+    << endl
+    << "var" << endl;
+  for (int i=0; i<n; i++) {
+    vector<int> d = Shape(i);
+    o << "  a" << i << " : " << BaseTypeName(i);
+    for (size_t k=0; k<d.size(); k++) o << "[" << d[k] << "]";
+    o << ";" << endl;
+  }
+  o << endl
+    << "begin" << endl
+    << "end types." << endl;
+  return o.str();
+}
+
+/// @brief intern the array types of @a n declarations through the type manager
+static vector<const CType*> Intern(int n)
+{
+  CTypeManager *tm = CTypeManager::Get();
+  vector<const CType*> types;
+  types.reserve(n);
+
+  for (int i=0; i<n; i++) {
+    vector<int> d = Shape(i);
+    const CType *t = BaseType(tm, i);
+    for (size_t k=d.size(); k>0; k--) t = tm->GetArray(d[k-1], t);
+    types.push_back(tm->GetPointer(t));
+  }
+
+  return types;
+}
+
+int main(int argc, char *argv[])
+{
+  int n = argc > 1 ? atoi(argv[1]) : 5000;
+  if (n <= 0) {
+    cout << "Usage: bench_types [NUMBER OF DECLARATIONS]" << endl;
+    return EXIT_FAILURE;
+  }
+
+  CTypeManager *tm = CTypeManager::Get();
+
+  // parse a generated module; the parser creates all array types
+  char fn[] = "/tmp/bench_typesXXXXXX";
+  int fd = mkstemp(fn);
+  if (fd < 0) {
+    cout << "cannot create temporary file." << endl;
+    return EXIT_FAILURE;
+  }
+  close(fd);
+  ofstream(fn) << Generate(n);
+
+  chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+  CScanner *s = CScanner::FromFile(fn);
+  CParser *p = new CParser(s);
+  CAstNode *m = p->Parse();
+  double tparse = Elapsed(t0);
+  remove(fn);
+
+  if (p->HasError()) {
+    const CToken *error = p->GetErrorToken();
+    cout << "parse error at " << error->GetLineNumber() << ":" << error->GetCharPosition()
+         << " : " << p->GetErrorMessage() << endl;
+    return EXIT_FAILURE;
+  }
+  unsigned int ntypes = tm->GetNumTypes();
+
+  // intern pointers to the same arrays: the arrays exist, the pointers are new
+  t0 = chrono::steady_clock::now();
+  vector<const CType*> first = Intern(n);
+  double tcreate = Elapsed(t0);
+
+  // intern everything again: pure lookups
+  t0 = chrono::steady_clock::now();
+  vector<const CType*> second = Intern(n);
+  double tlookup = Elapsed(t0);
+
+  // every shape must exist exactly once, and identical shapes must yield the same object
+  set<const CType*> distinct(first.begin(), first.end());
+  bool ok = (distinct.size() == (size_t)n) && (first == second);
+  for (unsigned int id=0; id<tm->GetNumTypes(); id++) {
+    if (tm->GetType(id)->GetID() != id) ok = false;
+  }
+
+  cout << fixed << setprecision(3)
+       << "declarations:           " << setw(8) << n << endl
+       << "types after parsing:    " << setw(8) << ntypes << endl
+       << "types after interning:  " << setw(8) << tm->GetNumTypes() << endl
+       << "parse:                  " << setw(8) << tparse << "s" << endl
+       << "intern (new pointers):  " << setw(8) << tcreate << "s" << endl
+       << "intern (lookup only):   " << setw(8) << tlookup << "s" << endl;
+
+  if (!ok) {
+    cout << "type interning is not unique." << endl;
+    return EXIT_FAILURE;
+  }
+
+  delete m;
+  delete p;
+  delete s;
+
+  return EXIT_SUCCESS;
+}
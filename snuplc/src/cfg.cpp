@@ -0,0 +1,402 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL control flow graph
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cassert>
+#include <sstream>
+
+#include "cfg.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// CBasicBlock
+//
+CBasicBlock::CBasicBlock(unsigned int id, CTacInstr *first)
+  : _id(id), _first(first), _last(first), _ninstr(0), _rpo(-1), _idom(NULL),
+    _domin(0), _domout(0), _loop(NULL)
+{
+}
+
+bool CBasicBlock::Dominates(const CBasicBlock *b) const
+{
+  assert(b != NULL);
+
+  // unreachable blocks are not part of the dominator tree
+  if (!IsReachable() || !b->IsReachable()) return this == b;
+
+  return (_domin <= b->_domin) && (b->_domin <= _domout);
+}
+
+unsigned int CBasicBlock::GetLoopDepth(void) const
+{
+  return _loop != NULL ? _loop->GetDepth() : 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CLoop
+//
+CLoop::CLoop(CBasicBlock *header)
+  : _header(header), _parent(NULL), _depth(1)
+{
+  _blocks.push_back(header);
+}
+
+bool CLoop::Contains(const CBasicBlock *b) const
+{
+  for (const CLoop *l = b->GetLoop(); l != NULL; l = l->GetParent()) {
+    if (l == this) return true;
+  }
+  return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CCfg
+//
+CCfg::CCfg(CCodeBlock *cb)
+  : _cb(cb)
+{
+  assert(cb != NULL);
+
+  BuildBlocks();
+  ComputeRPO();
+  ComputeDominators();
+  FindLoops();
+}
+
+CCfg::~CCfg(void)
+{
+  for (size_t i=0; i<_loops.size(); i++) delete _loops[i];
+  for (size_t i=0; i<_blocks.size(); i++) delete _blocks[i];
+}
+
+CBasicBlock* CCfg::GetEntry(void) const
+{
+  return _blocks.empty() ? NULL : _blocks[0];
+}
+
+CBasicBlock* CCfg::GetBlock(const CTacInstr *instr) const
+{
+  // walk back to the first instruction of the block
+  for (const CTacInstr *i = instr; i != NULL; i = i->GetPrev()) {
+    unordered_map<const CTacInstr*, CBasicBlock*>::const_iterator it = _leaders.find(i);
+    if (it != _leaders.end()) return it->second;
+  }
+  return NULL;
+}
+
+void CCfg::AddEdge(CBasicBlock *from, CBasicBlock *to)
+{
+  if (find(from->_succ.begin(), from->_succ.end(), to) != from->_succ.end()) return;
+
+  from->_succ.push_back(to);
+  to->_pred.push_back(from);
+}
+
+void CCfg::BuildBlocks(void)
+{
+  // a block starts with the first instruction, with a label and after a branch or return.
+  // Consecutive labels are not merged: phi functions identify their predecessors by label, and
+  // a block emptied by an optimization must remain a predecessor of its own.
+  CBasicBlock *bb = NULL;
+  bool leader = true;
+
+  for (CTacInstr *i = _cb->GetFirst(); i != NULL; i = i->GetNext()) {
+    if (leader || isa<CTacLabel>(i)) {
+      bb = new CBasicBlock(_blocks.size(), i);
+      _blocks.push_back(bb);
+      _leaders[i] = bb;
+    }
+
+    bb->_last = i;
+    bb->_ninstr++;
+    leader = i->IsBranch() || (i->GetOperation() == opReturn);
+  }
+
+  // fall-through edge first, branch target last
+  for (size_t b=0; b<_blocks.size(); b++) {
+    bb = _blocks[b];
+    CTacInstr *last = bb->_last;
+    EOperation op = last->GetOperation();
+
+    if ((op != opGoto) && (op != opReturn) && (b+1 < _blocks.size())) {
+      AddEdge(bb, _blocks[b+1]);
+    }
+
+    if (last->IsBranch()) {
+      CBasicBlock *target = GetBlock(cast<CTacLabel>(last->GetDest()));
+      assert(target != NULL);
+      AddEdge(bb, target);
+    }
+  }
+}
+
+void CCfg::ComputeRPO(void)
+{
+  if (_blocks.empty()) return;
+
+  // iterative depth-first search; a block is appended to the postorder once all its successors
+  // have been visited
+  vector<CBasicBlock*> post;
+  vector<bool> visited(_blocks.size(), false);
+  vector<pair<CBasicBlock*, size_t> > stack;
+
+  stack.push_back(make_pair(_blocks[0], 0));
+  visited[0] = true;
+
+  while (!stack.empty()) {
+    CBasicBlock *b = stack.back().first;
+    size_t &next = stack.back().second;
+
+    if (next < b->_succ.size()) {
+      CBasicBlock *s = b->_succ[next++];
+      if (!visited[s->_id]) {
+        visited[s->_id] = true;
+        stack.push_back(make_pair(s, 0));
+      }
+    } else {
+      post.push_back(b);
+      stack.pop_back();
+    }
+  }
+
+  _rpo.assign(post.rbegin(), post.rend());
+  for (size_t i=0; i<_rpo.size(); i++) _rpo[i]->_rpo = i;
+}
+
+void CCfg::ComputeDominators(void)
+{
+  if (_rpo.empty()) return;
+
+  // Cooper, Harvey, Kennedy: iterate over the blocks in reverse postorder until the immediate
+  // dominators are stable. The entry temporarily dominates itself.
+  CBasicBlock *entry = _rpo[0];
+  entry->_idom = entry;
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+
+    for (size_t i=1; i<_rpo.size(); i++) {
+      CBasicBlock *b = _rpo[i], *idom = NULL;
+
+      for (size_t p=0; p<b->_pred.size(); p++) {
+        CBasicBlock *pred = b->_pred[p];
+        if (pred->_idom == NULL) continue;    // not processed yet or unreachable
+
+        if (idom == NULL) {
+          idom = pred;
+        } else {
+          // walk up the dominator tree from both blocks until they meet
+          CBasicBlock *f1 = pred, *f2 = idom;
+          while (f1 != f2) {
+            while (f1->_rpo > f2->_rpo) f1 = f1->_idom;
+            while (f2->_rpo > f1->_rpo) f2 = f2->_idom;
+          }
+          idom = f1;
+        }
+      }
+
+      if (b->_idom != idom) {
+        b->_idom = idom;
+        changed = true;
+      }
+    }
+  }
+
+  entry->_idom = NULL;
+  for (size_t i=1; i<_rpo.size(); i++) _rpo[i]->_idom->_domchildren.push_back(_rpo[i]);
+
+  // number the dominator tree in preorder; b dominates c iff c's number lies within b's subtree
+  unsigned int n = 0;
+  vector<pair<CBasicBlock*, size_t> > stack;
+
+  entry->_domin = n++;
+  stack.push_back(make_pair(entry, 0));
+
+  while (!stack.empty()) {
+    CBasicBlock *b = stack.back().first;
+    size_t &next = stack.back().second;
+
+    if (next < b->_domchildren.size()) {
+      CBasicBlock *c = b->_domchildren[next++];
+      c->_domin = n++;
+      stack.push_back(make_pair(c, 0));
+    } else {
+      b->_domout = n-1;
+      stack.pop_back();
+    }
+  }
+}
+
+void CCfg::FindLoops(void)
+{
+  // headers are visited in reverse postorder, i.e., outer loops before the loops they contain.
+  // Each loop claims its blocks, so every block ends up with its innermost loop.
+  vector<size_t> mark(_blocks.size(), 0);
+
+  for (size_t i=0; i<_rpo.size(); i++) {
+    CBasicBlock *h = _rpo[i];
+    CLoop *loop = NULL;
+
+    // back edges: edges to a block that dominates their source
+    for (size_t p=0; p<h->_pred.size(); p++) {
+      CBasicBlock *pred = h->_pred[p];
+      if (pred->IsReachable() && h->Dominates(pred)) {
+        if (loop == NULL) loop = new CLoop(h);
+        loop->_latches.push_back(pred);
+      }
+    }
+    if (loop == NULL) continue;
+
+    // the loop consists of the blocks that reach a latch without passing through the header
+    size_t stamp = _loops.size() + 1;
+    vector<CBasicBlock*> work(loop->_latches);
+    mark[h->_id] = stamp;
+
+    while (!work.empty()) {
+      CBasicBlock *b = work.back();
+      work.pop_back();
+      if (mark[b->_id] == stamp) continue;
+
+      mark[b->_id] = stamp;
+      loop->_blocks.push_back(b);
+      for (size_t p=0; p<b->_pred.size(); p++) {
+        CBasicBlock *pred = b->_pred[p];
+        if (pred->IsReachable() && (mark[pred->_id] != stamp)) work.push_back(pred);
+      }
+    }
+
+    loop->_parent = h->_loop;
+    if (loop->_parent != NULL) loop->_depth = loop->_parent->_depth + 1;
+    for (size_t b=0; b<loop->_blocks.size(); b++) loop->_blocks[b]->_loop = loop;
+
+    _loops.push_back(loop);
+  }
+}
+
+ostream& CCfg::print(ostream &out, int indent) const
+{
+  string ind(indent, ' ');
+
+  out << ind << "[[ CFG " << _cb->GetName() << endl;
+
+  for (size_t b=0; b<_blocks.size(); b++) {
+    const CBasicBlock *bb = _blocks[b];
+
+    out << ind << "  BB" << bb->GetId() << ": " << bb->GetFirst()->GetId() << "-"
+        << bb->GetLast()->GetId();
+
+    if (!bb->IsReachable()) {
+      out << "  unreachable" << endl;
+      continue;
+    }
+
+    out << "  pred";
+    if (bb->GetPredecessors().empty()) out << " -";
+    for (size_t p=0; p<bb->GetPredecessors().size(); p++) {
+      out << " BB" << bb->GetPredecessors()[p]->GetId();
+    }
+    out << "  succ";
+    if (bb->GetSuccessors().empty()) out << " -";
+    for (size_t s=0; s<bb->GetSuccessors().size(); s++) {
+      out << " BB" << bb->GetSuccessors()[s]->GetId();
+    }
+    out << "  idom ";
+    if (bb->GetIDom() != NULL) out << "BB" << bb->GetIDom()->GetId(); else out << "-";
+    out << "  depth " << bb->GetLoopDepth() << endl;
+  }
+
+  for (size_t l=0; l<_loops.size(); l++) {
+    const CLoop *loop = _loops[l];
+
+    out << ind << "  loop BB" << loop->GetHeader()->GetId() << " (depth " << loop->GetDepth()
+        << "):";
+    for (size_t b=0; b<loop->GetBlocks().size(); b++) {
+      out << " BB" << loop->GetBlocks()[b]->GetId();
+    }
+    out << endl;
+  }
+
+  out << ind << "]]" << endl;
+
+  return out;
+}
+
+string CCfg::dotID(const CBasicBlock *b) const
+{
+  ostringstream o;
+  o << _cb->GetName() << "_bb" << b->GetId();
+  return o.str();
+}
+
+void CCfg::toDot(ostream &out, int indent) const
+{
+  string ind(indent, ' ');
+
+  out << ind << "subgraph cluster_" << _cb->GetName() << " {" << endl
+      << ind << "  label=\"" << _cb->GetName() << "\";" << endl;
+
+  for (size_t b=0; b<_blocks.size(); b++) {
+    const CBasicBlock *bb = _blocks[b];
+    bool header = (bb->GetLoop() != NULL) && (bb->GetLoop()->GetHeader() == bb);
+
+    out << ind << "  " << dotID(bb) << " [label=\"BB" << bb->GetId() << "\\l";
+    for (CTacInstr *i = bb->GetFirst(); ; i = i->GetNext()) {
+      i->print(out, 0);
+      out << "\\l";
+      if (i == bb->GetLast()) break;
+    }
+    out << "\",shape=box" << (header ? ",peripheries=2" : "") << "];" << endl;
+  }
+
+  for (size_t b=0; b<_blocks.size(); b++) {
+    const CBasicBlock *bb = _blocks[b];
+
+    for (size_t s=0; s<bb->GetSuccessors().size(); s++) {
+      out << ind << "  " << dotID(bb) << " -> " << dotID(bb->GetSuccessors()[s]) << ";" << endl;
+    }
+    if (bb->GetIDom() != NULL) {
+      out << ind << "  " << dotID(bb->GetIDom()) << " -> " << dotID(bb)
+          << " [style=dashed,color=gray,constraint=false];" << endl;
+    }
+  }
+
+  out << ind << "}" << endl;
+}
+
+ostream& operator<<(ostream &out, const CCfg &t)
+{
+  return t.print(out);
+}
+
+ostream& operator<<(ostream &out, const CCfg *t)
+{
+  return t->print(out);
+}
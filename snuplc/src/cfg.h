@@ -0,0 +1,292 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL control flow graph
+///
+/// basic blocks, dominator tree and natural loops of a code block
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_CFG_H__
+#define __SnuPL_CFG_H__
+
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "ir.h"
+using namespace std;
+
+class CLoop;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief basic block
+///
+/// a maximal sequence of consecutive instructions of a code block that is entered only at its
+/// first and left only at its last instruction. Basic blocks are created by CCfg.
+///
+
+class CBasicBlock {
+  public:
+    /// @name properties
+    /// @{
+
+    /// @brief return the number of the block (blocks are numbered in instruction order)
+    unsigned int GetId(void) const { return _id; };
+
+    /// @brief return the first instruction of the block
+    CTacInstr* GetFirst(void) const { return _first; };
+
+    /// @brief return the last instruction of the block
+    CTacInstr* GetLast(void) const { return _last; };
+
+    /// @brief return the number of instructions in the block
+    size_t GetNumInstr(void) const { return _ninstr; };
+
+    /// @brief return the successors of the block (branch target last)
+    const vector<CBasicBlock*>& GetSuccessors(void) const { return _succ; };
+
+    /// @brief return the predecessors of the block
+    const vector<CBasicBlock*>& GetPredecessors(void) const { return _pred; };
+
+    /// @brief returns true if the block is reachable from the entry block
+    bool IsReachable(void) const { return _rpo >= 0; };
+
+    /// @brief return the position of the block in reverse postorder (-1 if unreachable)
+    int GetRPO(void) const { return _rpo; };
+
+    /// @}
+
+
+    /// @name dominator tree
+    /// @{
+
+    /// @brief return the immediate dominator (NULL for the entry and unreachable blocks)
+    CBasicBlock* GetIDom(void) const { return _idom; };
+
+    /// @brief return the blocks immediately dominated by this block
+    const vector<CBasicBlock*>& GetDomChildren(void) const { return _domchildren; };
+
+    /// @brief returns true if this block dominates @a b (every block dominates itself)
+    bool Dominates(const CBasicBlock *b) const;
+
+    /// @}
+
+
+    /// @name loops
+    /// @{
+
+    /// @brief return the innermost loop containing this block (or NULL)
+    CLoop* GetLoop(void) const { return _loop; };
+
+    /// @brief return the number of loops containing this block
+    unsigned int GetLoopDepth(void) const;
+
+    /// @}
+
+  private:
+    /// @brief constructor
+    /// @param id number of the block
+    /// @param first first instruction
+    CBasicBlock(unsigned int id, CTacInstr *first);
+
+    unsigned int _id;                ///< block number
+    CTacInstr   *_first;             ///< first instruction
+    CTacInstr   *_last;              ///< last instruction
+    size_t       _ninstr;            ///< number of instructions
+    vector<CBasicBlock*> _succ;      ///< successors
+    vector<CBasicBlock*> _pred;      ///< predecessors
+    int          _rpo;               ///< reverse postorder number
+    CBasicBlock *_idom;              ///< immediate dominator
+    vector<CBasicBlock*> _domchildren; ///< dominator tree children
+    unsigned int _domin;             ///< preorder number in the dominator tree
+    unsigned int _domout;            ///< largest preorder number in the dominator subtree
+    CLoop       *_loop;              ///< innermost loop
+
+    friend class CCfg;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief natural loop
+///
+/// the blocks of all back edges to the same header. Loops are created by CCfg.
+///
+
+class CLoop {
+  public:
+    /// @name properties
+    /// @{
+
+    /// @brief return the loop header (dominates all blocks of the loop)
+    CBasicBlock* GetHeader(void) const { return _header; };
+
+    /// @brief return the blocks of the loop, header first
+    const vector<CBasicBlock*>& GetBlocks(void) const { return _blocks; };
+
+    /// @brief return the sources of the back edges to the header
+    const vector<CBasicBlock*>& GetLatches(void) const { return _latches; };
+
+    /// @brief return the innermost enclosing loop (or NULL)
+    CLoop* GetParent(void) const { return _parent; };
+
+    /// @brief return the nesting depth (outermost loops have depth 1)
+    unsigned int GetDepth(void) const { return _depth; };
+
+    /// @brief returns true if @a b is part of the loop (or of a nested loop)
+    bool Contains(const CBasicBlock *b) const;
+
+    /// @}
+
+  private:
+    /// @brief constructor
+    /// @param header loop header
+    CLoop(CBasicBlock *header);
+
+    CBasicBlock *_header;            ///< loop header
+    vector<CBasicBlock*> _blocks;    ///< blocks of the loop
+    vector<CBasicBlock*> _latches;   ///< back edge sources
+    CLoop       *_parent;            ///< enclosing loop
+    unsigned int _depth;             ///< nesting depth
+
+    friend class CCfg;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief control flow graph
+///
+/// basic blocks of a code block with their successor/predecessor edges, the dominator tree
+/// (Cooper, Harvey, Kennedy: "A Simple, Fast Dominance Algorithm") and the natural loops.
+///
+/// The graph is a snapshot: it refers to the instructions of the code block and has to be
+/// rebuilt after instructions are inserted or removed or branch targets are changed.
+///
+
+class CCfg {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor. Builds the graph, the dominator tree and the loops.
+    /// @param cb code block
+    CCfg(CCodeBlock *cb);
+
+    /// @brief destructor
+    ~CCfg(void);
+
+    /// @}
+
+
+    /// @name properties
+    /// @{
+
+    /// @brief return the code block
+    CCodeBlock* GetCodeBlock(void) const { return _cb; };
+
+    /// @brief return the entry block (NULL if the code block is empty)
+    CBasicBlock* GetEntry(void) const;
+
+    /// @brief return the blocks in instruction order
+    const vector<CBasicBlock*>& GetBlocks(void) const { return _blocks; };
+
+    /// @brief return the reachable blocks in reverse postorder
+    const vector<CBasicBlock*>& GetRPO(void) const { return _rpo; };
+
+    /// @brief return the block containing @a instr
+    /// @param instr instruction of the code block
+    CBasicBlock* GetBlock(const CTacInstr *instr) const;
+
+    /// @brief return the loops, outer loops before the loops they contain
+    const vector<CLoop*>& GetLoops(void) const { return _loops; };
+
+    /// @}
+
+
+    /// @name output
+    /// @{
+
+    /// @brief print the graph to an output stream
+    /// @param out output stream
+    /// @param indent indentation
+    ostream& print(ostream &out, int indent=0) const;
+
+    /// @brief print the graph in dot format to an output stream
+    ///
+    /// control flow edges are solid, dominator tree edges dashed. Loop headers are drawn with a
+    /// double border.
+    ///
+    /// @param out output stream
+    /// @param indent indentation
+    void toDot(ostream &out, int indent=0) const;
+
+    /// @}
+
+  private:
+    /// @brief split the instructions into basic blocks and connect them
+    void BuildBlocks(void);
+
+    /// @brief number the reachable blocks in reverse postorder
+    void ComputeRPO(void);
+
+    /// @brief compute the immediate dominators and the dominator tree
+    void ComputeDominators(void);
+
+    /// @brief find the natural loops
+    void FindLoops(void);
+
+    /// @brief add the edge @a from -> @a to (once)
+    void AddEdge(CBasicBlock *from, CBasicBlock *to);
+
+    /// @brief return the node ID of block @a b in dot format
+    string dotID(const CBasicBlock *b) const;
+
+    CCodeBlock *_cb;                 ///< code block
+    vector<CBasicBlock*> _blocks;    ///< blocks in instruction order
+    vector<CBasicBlock*> _rpo;       ///< reachable blocks in reverse postorder
+    vector<CLoop*> _loops;           ///< loops, outer first
+    /// block starting with an instruction
+    unordered_map<const CTacInstr*, CBasicBlock*> _leaders;
+};
+
+/// @name CCfg output operators
+/// @{
+
+/// @brief CCfg output operator
+///
+/// @param out output stream
+/// @param t reference to CCfg
+/// @retval output stream
+ostream& operator<<(ostream &out, const CCfg &t);
+
+/// @brief CCfg output operator
+///
+/// @param out output stream
+/// @param t reference to CCfg
+/// @retval output stream
+ostream& operator<<(ostream &out, const CCfg *t);
+
+/// @}
+
+
+#endif // __SnuPL_CFG_H__
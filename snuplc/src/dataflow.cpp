@@ -0,0 +1,613 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL data-flow analysis
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+
+#include <cassert>
+#include <sstream>
+
+#include "dataflow.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// CBitSet
+//
+CBitSet::CBitSet(size_t size)
+{
+  Resize(size);
+}
+
+void CBitSet::Resize(size_t size)
+{
+  _size = size;
+  _words.assign((size + 63) / 64, 0);
+}
+
+size_t CBitSet::Count(void) const
+{
+  size_t n = 0;
+  for (size_t w=0; w<_words.size(); w++) n += __builtin_popcountll(_words[w]);
+  return n;
+}
+
+long CBitSet::Next(size_t i) const
+{
+  if (i >= _size) return -1;
+
+  size_t w = i >> 6;
+  uint64_t bits = _words[w] & (~(uint64_t)0 << (i & 63));
+  while (bits == 0) {
+    if (++w == _words.size()) return -1;
+    bits = _words[w];
+  }
+
+  return (long)(w * 64 + __builtin_ctzll(bits));
+}
+
+void CBitSet::Clear(void)
+{
+  for (size_t w=0; w<_words.size(); w++) _words[w] = 0;
+}
+
+void CBitSet::Fill(void)
+{
+  for (size_t w=0; w<_words.size(); w++) _words[w] = ~(uint64_t)0;
+  if (_size & 63) _words.back() = ((uint64_t)1 << (_size & 63)) - 1;
+}
+
+void CBitSet::Complement(void)
+{
+  for (size_t w=0; w<_words.size(); w++) _words[w] = ~_words[w];
+  if (_size & 63) _words.back() &= ((uint64_t)1 << (_size & 63)) - 1;
+}
+
+bool CBitSet::Union(const CBitSet &s)
+{
+  assert(_size == s._size);
+
+  uint64_t changed = 0;
+  for (size_t w=0; w<_words.size(); w++) {
+    uint64_t v = _words[w] | s._words[w];
+    changed |= v ^ _words[w];
+    _words[w] = v;
+  }
+  return changed != 0;
+}
+
+bool CBitSet::Intersect(const CBitSet &s)
+{
+  assert(_size == s._size);
+
+  uint64_t changed = 0;
+  for (size_t w=0; w<_words.size(); w++) {
+    uint64_t v = _words[w] & s._words[w];
+    changed |= v ^ _words[w];
+    _words[w] = v;
+  }
+  return changed != 0;
+}
+
+void CBitSet::Subtract(const CBitSet &s)
+{
+  assert(_size == s._size);
+
+  for (size_t w=0; w<_words.size(); w++) _words[w] &= ~s._words[w];
+}
+
+bool CBitSet::Update(const CBitSet &gen, const CBitSet &in, const CBitSet &kill)
+{
+  assert((_size == gen._size) && (_size == in._size) && (_size == kill._size));
+
+  uint64_t changed = 0;
+  for (size_t w=0; w<_words.size(); w++) {
+    uint64_t v = gen._words[w] | (in._words[w] & ~kill._words[w]);
+    changed |= v ^ _words[w];
+    _words[w] = v;
+  }
+  return changed != 0;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CVariables
+//
+CVariables::CVariables(const CCodeBlock *cb)
+{
+  assert(cb != NULL);
+
+  _owner = cb->GetOwner();
+  _ntemps = _owner->GetTemps().size();
+
+  // only local scalar variables and parameters whose address is not taken
+  const vector<CSymbol*> &decl = _owner->GetSymbolTable()->GetDeclarations();
+  _excluded.resize(decl.size());
+  for (size_t s=0; s<decl.size(); s++) {
+    ESymbolType st = decl[s]->GetSymbolType();
+    const CType *type = decl[s]->GetDataType();
+    _excluded[s] = ((st != stLocal) && (st != stParam)) || !type->IsScalar() || type->IsPointer();
+  }
+
+  for (CTacInstr *i = cb->GetFirst(); i != NULL; i = i->GetNext()) {
+    if (i->GetOperation() != opAddress) continue;
+
+    int v = GetIndex(i->GetSrc(1));
+    if (v >= (int)_ntemps) _excluded[v - _ntemps] = true;
+  }
+}
+
+int CVariables::GetIndex(const CTac *a) const
+{
+  if (isa<CTacTemp>(a)) {
+    unsigned int id = cast<CTacTemp>(a)->GetId();
+    return id < _ntemps ? (int)id : -1;
+  }
+
+  if (isa<CTacName>(a)) {
+    const CSymbol *s = cast<CTacName>(a)->GetSymbol();
+    ESymbolType st = s->GetSymbolType();
+
+    // symbols of other scopes are globals
+    if ((st != stLocal) && (st != stParam)) return -1;
+    if ((s->GetSlot() < 0) || ((size_t)s->GetSlot() >= _excluded.size())) return -1;
+    if (_excluded[s->GetSlot()]) return -1;
+
+    return (int)(_ntemps + s->GetSlot());
+  }
+
+  return -1;
+}
+
+int CVariables::GetDef(const CTacInstr *i) const
+{
+  const CTac *dst = i->GetDest();
+  return (dst != NULL) && !i->IsBranch() ? GetIndex(dst) : -1;
+}
+
+void CVariables::GetUses(const CTacInstr *i, vector<int> &uses) const
+{
+  const CTacPhi *phi = dyn_cast<CTacPhi>(i);
+  if (phi != NULL) {
+    for (unsigned int a=0; a<phi->GetNumArgs(); a++) {
+      int v = phi->GetArg(a) != NULL ? GetIndex(phi->GetArg(a)) : -1;
+      if (v >= 0) uses.push_back(v);
+    }
+    return;
+  }
+
+  for (int k=1; k<=2; k++) {
+    const CTacAddr *src = i->GetSrc(k);
+    if (src == NULL) continue;
+    if (isa<CTacReference>(src)) src = cast<CTacReference>(src)->GetTemp();
+
+    int v = GetIndex(src);
+    if (v >= 0) uses.push_back(v);
+  }
+
+  const CTacReference *ref = dyn_cast<CTacReference>(i->GetDest());
+  if (ref != NULL) {
+    int v = GetIndex(ref->GetTemp());
+    if (v >= 0) uses.push_back(v);
+  }
+}
+
+void CVariables::GetUpwardExposed(const CCfg *cfg, vector<bool> &exposed) const
+{
+  // block id + 1 of the last block that defined a variable
+  vector<unsigned int> def(GetSize(), 0);
+  vector<int> uses;
+
+  exposed.assign(GetSize(), false);
+
+  const vector<CBasicBlock*> &blocks = cfg->GetRPO();
+  for (size_t b=0; b<blocks.size(); b++) {
+    unsigned int id = blocks[b]->GetId() + 1;
+
+    for (CTacInstr *i = blocks[b]->GetFirst(); ; i = i->GetNext()) {
+      uses.clear();
+      GetUses(i, uses);
+      for (size_t u=0; u<uses.size(); u++) {
+        if (def[uses[u]] != id) exposed[uses[u]] = true;
+      }
+
+      int d = GetDef(i);
+      if (d >= 0) def[d] = id;
+
+      if (i == blocks[b]->GetLast()) break;
+    }
+  }
+}
+
+string CVariables::GetName(unsigned int index) const
+{
+  ostringstream o;
+
+  if (index < _ntemps) o << "t" << index;
+  else o << _owner->GetSymbolTable()->GetDeclarations()[index - _ntemps]->GetName();
+
+  return o.str();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CDataflow
+//
+CDataflow::CDataflow(const string title, const CCfg *cfg, EDirection dir, EMeet meet)
+  : _title(title), _cfg(cfg), _dir(dir), _meet(meet), _size(0), _visits(0)
+{
+  assert(cfg != NULL);
+}
+
+CDataflow::~CDataflow(void)
+{
+}
+
+void CDataflow::TransferBlock(const CBasicBlock *b, CBitSet &s) const
+{
+  if (_dir == dfForward) {
+    for (CTacInstr *i = b->GetFirst(); ; i = i->GetNext()) {
+      Transfer(i, s);
+      if (i == b->GetLast()) break;
+    }
+  } else {
+    for (CTacInstr *i = b->GetLast(); ; i = i->GetPrev()) {
+      Transfer(i, s);
+      if (i == b->GetFirst()) break;
+    }
+  }
+}
+
+void CDataflow::Solve(size_t size)
+{
+  const vector<CBasicBlock*> &blocks = _cfg->GetBlocks();
+  const vector<CBasicBlock*> &rpo = _cfg->GetRPO();
+  size_t nblocks = blocks.size();
+  bool forward = _dir == dfForward;
+
+  _size = size;
+  _in.assign(nblocks, CBitSet(size));
+  _out.assign(nblocks, CBitSet(size));
+  _visits = 0;
+
+  // gen and kill sets of the blocks: gen = f(0), kill = ~f(1)
+  vector<CBitSet> gen(nblocks, CBitSet(size)), kill(nblocks, CBitSet(size));
+  for (size_t b=0; b<rpo.size(); b++) {
+    unsigned int id = rpo[b]->GetId();
+    TransferBlock(rpo[b], gen[id]);
+    kill[id].Fill();
+    TransferBlock(rpo[b], kill[id]);
+    kill[id].Complement();
+  }
+
+  // visit order: reverse postorder for forward, postorder for backward problems
+  vector<CBasicBlock*> order(rpo);
+  if (!forward) order.assign(rpo.rbegin(), rpo.rend());
+
+  // sets flowing out of a block in the direction of the analysis (the result of the transfer
+  // function) start at the identity of the meet operator
+  vector<CBitSet> &result = forward ? _out : _in;
+  vector<CBitSet> &meet = forward ? _in : _out;
+  if (_meet == dfIntersect) {
+    for (size_t b=0; b<order.size(); b++) result[order[b]->GetId()].Fill();
+  }
+
+  vector<bool> pending(nblocks, false);
+  for (size_t b=0; b<order.size(); b++) pending[order[b]->GetId()] = true;
+
+  bool again = true;
+  while (again) {
+    again = false;
+
+    for (size_t b=0; b<order.size(); b++) {
+      const CBasicBlock *bb = order[b];
+      unsigned int id = bb->GetId();
+      if (!pending[id]) continue;
+      pending[id] = false;
+      _visits++;
+
+      // meet over the reachable neighbors against the direction of the analysis
+      const vector<CBasicBlock*> &from = forward ? bb->GetPredecessors() : bb->GetSuccessors();
+      CBitSet &m = meet[id];
+      bool first = true;
+      for (size_t n=0; n<from.size(); n++) {
+        if (!from[n]->IsReachable()) continue;
+
+        const CBitSet &r = result[from[n]->GetId()];
+        if (first) m = r;
+        else if (_meet == dfUnion) m.Union(r);
+        else m.Intersect(r);
+        first = false;
+      }
+      // the entry block has an additional predecessor, the boundary, with the empty set
+      if (first || (forward && (bb == _cfg->GetEntry()) && (_meet == dfIntersect))) m.Clear();
+
+      // propagate changes in the direction of the analysis
+      if (result[id].Update(gen[id], m, kill[id])) {
+        const vector<CBasicBlock*> &to = forward ? bb->GetSuccessors() : bb->GetPredecessors();
+        for (size_t n=0; n<to.size(); n++) {
+          if (!to[n]->IsReachable()) continue;
+          pending[to[n]->GetId()] = true;
+
+          // blocks already visited in this round are visited again in the next one
+          int rpo = to[n]->GetRPO();
+          if (forward ? rpo <= bb->GetRPO() : rpo >= bb->GetRPO()) again = true;
+        }
+      }
+    }
+  }
+}
+
+void CDataflow::PrintSet(ostream &out, const CBitSet &s) const
+{
+  out << "{";
+  for (long i = s.Next(0); i >= 0; i = s.Next(i+1)) out << " " << GetName(i);
+  out << " }";
+}
+
+ostream& CDataflow::print(ostream &out, int indent) const
+{
+  string ind(indent, ' ');
+
+  out << ind << "[[ " << _title << " " << _cfg->GetCodeBlock()->GetName() << endl;
+
+  const vector<CBasicBlock*> &blocks = _cfg->GetBlocks();
+  for (size_t b=0; b<blocks.size(); b++) {
+    const CBasicBlock *bb = blocks[b];
+    if (!bb->IsReachable()) continue;
+
+    out << ind << "  BB" << bb->GetId() << "  in ";
+    PrintSet(out, GetIn(bb));
+    out << "  out ";
+    PrintSet(out, GetOut(bb));
+    out << endl;
+  }
+
+  out << ind << "]]" << endl;
+
+  return out;
+}
+
+ostream& operator<<(ostream &out, const CDataflow &t)
+{
+  return t.print(out);
+}
+
+ostream& operator<<(ostream &out, const CDataflow *t)
+{
+  return t->print(out);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CLiveness
+//
+CLiveness::CLiveness(const CCfg *cfg)
+  : CDataflow("liveness", cfg, dfBackward, dfUnion), _vars(cfg->GetCodeBlock())
+{
+  vector<bool> exposed;
+  _vars.GetUpwardExposed(cfg, exposed);
+
+  _fact.assign(_vars.GetSize(), -1);
+  for (size_t v=0; v<exposed.size(); v++) {
+    if (!exposed[v]) continue;
+    _fact[v] = _var.size();
+    _var.push_back(v);
+  }
+
+  Solve(_var.size());
+}
+
+bool CLiveness::IsLiveOut(const CBasicBlock *b, const CTac *a) const
+{
+  int v = _vars.GetIndex(a);
+  if (v < 0) return true;
+
+  return (_fact[v] >= 0) && GetOut(b).Test(_fact[v]);
+}
+
+void CLiveness::Transfer(const CTacInstr *i, CBitSet &s) const
+{
+  int d = _vars.GetDef(i);
+  if ((d >= 0) && (_fact[d] >= 0)) s.Reset(_fact[d]);
+
+  _uses.clear();
+  _vars.GetUses(i, _uses);
+  for (size_t u=0; u<_uses.size(); u++) {
+    if (_fact[_uses[u]] >= 0) s.Set(_fact[_uses[u]]);
+  }
+}
+
+string CLiveness::GetName(unsigned int index) const
+{
+  return _vars.GetName(_var[index]);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CReachingDefs
+//
+CReachingDefs::CReachingDefs(const CCfg *cfg)
+  : CDataflow("reaching definitions", cfg, dfForward, dfUnion), _vars(cfg->GetCodeBlock())
+{
+  vector<bool> exposed;
+  _vars.GetUpwardExposed(cfg, exposed);
+  _vardefs.resize(_vars.GetSize());
+
+  for (CTacInstr *i = cfg->GetCodeBlock()->GetFirst(); i != NULL; i = i->GetNext()) {
+    int v = _vars.GetDef(i);
+    if ((v < 0) || !exposed[v]) continue;
+
+    _index[i] = _defs.size();
+    _vardefs[v].push_back(_defs.size());
+    _defs.push_back(i);
+  }
+
+  Solve(_defs.size());
+}
+
+int CReachingDefs::GetIndex(const CTacInstr *i) const
+{
+  unordered_map<const CTacInstr*, unsigned int>::const_iterator it = _index.find(i);
+  return it != _index.end() ? (int)it->second : -1;
+}
+
+void CReachingDefs::Transfer(const CTacInstr *i, CBitSet &s) const
+{
+  int d = GetIndex(i);
+  if (d < 0) return;
+
+  const vector<unsigned int> &defs = _vardefs[_vars.GetDef(i)];
+  for (size_t k=0; k<defs.size(); k++) s.Reset(defs[k]);
+  s.Set(d);
+}
+
+string CReachingDefs::GetName(unsigned int index) const
+{
+  ostringstream o;
+  o << _defs[index]->GetId();
+  return o.str();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CAvailableExprs
+//
+
+/// @brief returns true if @a op computes an expression of its sources
+static bool IsExpression(EOperation op)
+{
+  switch (op) {
+    case opAdd: case opSub: case opMul: case opDiv: case opAnd: case opOr:
+    case opNeg: case opPos: case opNot:
+    case opCast: case opWiden: case opNarrow:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+CAvailableExprs::CAvailableExprs(const CCfg *cfg)
+  : CDataflow("available expressions", cfg, dfForward, dfIntersect), _vars(cfg->GetCodeBlock())
+{
+  _varexprs.resize(_vars.GetSize());
+
+  // candidates: expressions identified by their operation and the printed operands
+  struct SCandidate {
+    const CTacInstr *instr;          ///< first computation
+    unsigned int block;              ///< block id + 1 of the last computation
+    unsigned int nblocks;            ///< number of blocks computing the expression
+  };
+  unordered_map<string, unsigned int> keys;
+  vector<SCandidate> cand;
+  vector<pair<const CTacInstr*, unsigned int> > computed;
+
+  const vector<CBasicBlock*> &blocks = cfg->GetRPO();
+  for (size_t b=0; b<blocks.size(); b++) {
+    for (CTacInstr *i = blocks[b]->GetFirst(); ; i = i->GetNext()) {
+      if (IsExpression(i->GetOperation())) {
+        ostringstream key;
+        bool ok = true;
+        key << i->GetOperation();
+        for (unsigned int k=1; k<=i->GetNumSrc(); k++) {
+          const CTacAddr *src = i->GetSrc(k);
+          if ((_vars.GetIndex(src) < 0) && !isa<CTacConst>(src)) ok = false;
+          key << " " << src;
+        }
+
+        if (ok) {
+          unordered_map<string, unsigned int>::iterator it = keys.find(key.str());
+          unsigned int c = it != keys.end() ? it->second : cand.size();
+          if (c == cand.size()) {
+            keys[key.str()] = c;
+            SCandidate sc = { i, 0, 0 };
+            cand.push_back(sc);
+          }
+          if (cand[c].block != blocks[b]->GetId() + 1) {
+            cand[c].block = blocks[b]->GetId() + 1;
+            cand[c].nblocks++;
+          }
+          computed.push_back(make_pair(i, c));
+        }
+      }
+
+      if (i == blocks[b]->GetLast()) break;
+    }
+  }
+
+  // facts: expressions computed in at least two blocks
+  vector<int> fact(cand.size(), -1);
+  for (size_t c=0; c<cand.size(); c++) {
+    if (cand[c].nblocks < 2) continue;
+
+    unsigned int e = _exprs.size();
+    fact[c] = e;
+    _exprs.push_back(cand[c].instr);
+
+    const CTacInstr *i = cand[c].instr;
+    for (unsigned int k=1; k<=i->GetNumSrc(); k++) {
+      int v = _vars.GetIndex(i->GetSrc(k));
+      if ((v < 0) || ((k == 2) && (v == _vars.GetIndex(i->GetSrc(1))))) continue;
+      _varexprs[v].push_back(e);
+    }
+  }
+
+  for (size_t k=0; k<computed.size(); k++) {
+    if (fact[computed[k].second] >= 0) _index[computed[k].first] = fact[computed[k].second];
+  }
+
+  Solve(_exprs.size());
+}
+
+int CAvailableExprs::GetIndex(const CTacInstr *i) const
+{
+  unordered_map<const CTacInstr*, unsigned int>::const_iterator it = _index.find(i);
+  return it != _index.end() ? (int)it->second : -1;
+}
+
+void CAvailableExprs::Transfer(const CTacInstr *i, CBitSet &s) const
+{
+  int e = GetIndex(i);
+  if (e >= 0) s.Set(e);
+
+  // expressions reading the destination (including the one just computed) are killed
+  int d = _vars.GetDef(i);
+  if (d < 0) return;
+
+  const vector<unsigned int> &exprs = _varexprs[d];
+  for (size_t k=0; k<exprs.size(); k++) s.Reset(exprs[k]);
+}
+
+string CAvailableExprs::GetName(unsigned int index) const
+{
+  const CTacInstr *i = _exprs[index];
+  ostringstream o;
+
+  o << i->GetOperation();
+  for (unsigned int k=1; k<=i->GetNumSrc(); k++) o << (k > 1 ? "," : "") << " " << i->GetSrc(k);
+
+  return o.str();
+}
@@ -0,0 +1,478 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL data-flow analysis
+///
+/// bit-vector data-flow framework over the control flow graph with liveness, reaching
+/// definitions and available expressions
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+
+#ifndef __SnuPL_DATAFLOW_H__
+#define __SnuPL_DATAFLOW_H__
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ir.h"
+#include "cfg.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief dense bit set
+///
+/// a fixed number of bits stored in 64-bit words. The set operations work on whole words; bits
+/// beyond the size of the set are always zero.
+///
+
+class CBitSet {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor
+    /// @param size number of bits (all cleared)
+    CBitSet(size_t size=0);
+
+    /// @}
+
+
+    /// @name properties
+    /// @{
+
+    /// @brief return the number of bits
+    size_t GetSize(void) const { return _size; };
+
+    /// @brief change the number of bits and clear all bits
+    void Resize(size_t size);
+
+    /// @brief returns true if bit @a i is set
+    bool Test(size_t i) const { return (_words[i >> 6] >> (i & 63)) & 1; };
+
+    /// @brief set bit @a i
+    void Set(size_t i) { _words[i >> 6] |= (uint64_t)1 << (i & 63); };
+
+    /// @brief clear bit @a i
+    void Reset(size_t i) { _words[i >> 6] &= ~((uint64_t)1 << (i & 63)); };
+
+    /// @brief return the number of set bits
+    size_t Count(void) const;
+
+    /// @brief return the first set bit at or after @a i (-1 if there is none)
+    long Next(size_t i) const;
+
+    /// @}
+
+
+    /// @name set operations
+    /// @{
+
+    /// @brief clear all bits
+    void Clear(void);
+
+    /// @brief set all bits
+    void Fill(void);
+
+    /// @brief complement the set
+    void Complement(void);
+
+    /// @brief add the bits of @a s (sets of equal size)
+    /// @retval true if the set has changed
+    bool Union(const CBitSet &s);
+
+    /// @brief remove the bits not in @a s (sets of equal size)
+    /// @retval true if the set has changed
+    bool Intersect(const CBitSet &s);
+
+    /// @brief remove the bits of @a s (sets of equal size)
+    void Subtract(const CBitSet &s);
+
+    /// @brief set to @a gen | (@a in & ~@a kill) in one pass (sets of equal size)
+    /// @retval true if the set has changed
+    bool Update(const CBitSet &gen, const CBitSet &in, const CBitSet &kill);
+
+    bool operator==(const CBitSet &s) const { return _words == s._words; };
+    bool operator!=(const CBitSet &s) const { return _words != s._words; };
+
+    /// @}
+
+  private:
+    size_t _size;                    ///< number of bits
+    vector<uint64_t> _words;         ///< bits, 64 per word
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief variables of a code block
+///
+/// dense numbering of the temporaries and the local scalar variables and parameters of a code
+/// block: temporary @a t has index t->GetId(), the symbol in slot @a s of the symbol table of
+/// the scope has index (number of temporaries) + @a s. Variables whose address is taken,
+/// arrays, pointers and global variables are not numbered since they can be accessed through
+/// memory and by other procedures.
+///
+
+class CVariables {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor
+    /// @param cb code block
+    CVariables(const CCodeBlock *cb);
+
+    /// @}
+
+
+    /// @name properties
+    /// @{
+
+    /// @brief return the number of indices
+    size_t GetSize(void) const { return _ntemps + _excluded.size(); };
+
+    /// @brief return the index of the variable @a a (-1 if @a a is not a numbered variable)
+    int GetIndex(const CTac *a) const;
+
+    /// @brief return the index of the variable defined by @a i (-1 if none)
+    int GetDef(const CTacInstr *i) const;
+
+    /// @brief return the indices of the variables read by @a i
+    ///
+    /// the temporary of a reference (CTacReference) is read, also if the reference is the
+    /// destination. The arguments of phi functions are read by the phi function.
+    ///
+    /// @param i instruction
+    /// @param uses indices (appended)
+    void GetUses(const CTacInstr *i, vector<int> &uses) const;
+
+    /// @brief return the name of variable @a index
+    string GetName(unsigned int index) const;
+
+    /// @brief mark the variables that are read before they are written in some reachable block
+    ///
+    /// all other variables are local to the blocks that access them: they are never live at
+    /// the entry or exit of a block.
+    ///
+    /// @param cfg control flow graph of the code block
+    /// @param exposed result (by index)
+    void GetUpwardExposed(const CCfg *cfg, vector<bool> &exposed) const;
+
+    /// @}
+
+  private:
+    const CScope *_owner;            ///< scope of the code block
+    size_t _ntemps;                  ///< number of temporaries
+    vector<bool> _excluded;          ///< symbols (by slot) that are not numbered
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief bit-vector data-flow problem
+///
+/// the solver computes a set of facts (bits) at the entry and the exit of every reachable basic
+/// block. Subclasses define the facts and the transfer function of an instruction, which must
+/// have the form gen | (x & ~kill); the solver derives the gen and kill sets of each block from
+/// it once and then only operates on whole sets.
+///
+/// Blocks are visited in reverse postorder (forward problems) or postorder (backward
+/// problems); a block is visited again in the next round only if the sets it depends on have
+/// changed. The meet over the predecessors (forward) or successors (backward) is the union
+/// (may problems) or the intersection (must problems). Facts at the boundary (entry of the
+/// entry block, exit of blocks without successors) are the empty set, unreachable blocks are
+/// ignored and have empty sets.
+///
+/// Dense sets need (number of blocks) * (number of facts) bits per set kind. The clients below
+/// therefore only include facts that can hold at the boundary of a block and matter there;
+/// facts local to a block are left to a walk over its instructions. The analysis is a snapshot
+/// of the code block like the control flow graph it is computed on.
+///
+
+class CDataflow {
+  public:
+    /// @brief direction of the data flow
+    enum EDirection {
+      dfForward,                     ///< from the entry along the edges
+      dfBackward,                    ///< from the exits against the edges
+    };
+
+    /// @brief meet operator
+    enum EMeet {
+      dfUnion,                       ///< fact holds on some path
+      dfIntersect,                   ///< fact holds on all paths
+    };
+
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief destructor
+    virtual ~CDataflow(void);
+
+    /// @}
+
+
+    /// @name properties
+    /// @{
+
+    /// @brief return the control flow graph
+    const CCfg* GetCfg(void) const { return _cfg; };
+
+    /// @brief return the number of facts
+    size_t GetSize(void) const { return _size; };
+
+    /// @brief return the facts at the entry of block @a b
+    const CBitSet& GetIn(const CBasicBlock *b) const { return _in[b->GetId()]; };
+
+    /// @brief return the facts at the exit of block @a b
+    const CBitSet& GetOut(const CBasicBlock *b) const { return _out[b->GetId()]; };
+
+    /// @brief return the number of block visits the solver needed
+    size_t GetNumVisits(void) const { return _visits; };
+
+    /// @brief apply the transfer function of @a i to @a s
+    ///
+    /// @a s holds the facts before @a i in the direction of the analysis, i.e., after @a i for
+    /// backward problems.
+    ///
+    /// @param i instruction
+    /// @param s facts
+    virtual void Transfer(const CTacInstr *i, CBitSet &s) const = 0;
+
+    /// @brief return the name of fact @a index
+    virtual string GetName(unsigned int index) const = 0;
+
+    /// @}
+
+
+    /// @name output
+    /// @{
+
+    /// @brief print the facts at the entry and exit of all blocks to an output stream
+    ///
+    /// @param out output stream
+    /// @param indent indentation
+    ostream& print(ostream &out, int indent=0) const;
+
+    /// @}
+
+  protected:
+    /// @brief constructor
+    /// @param title name of the analysis (for output)
+    /// @param cfg control flow graph
+    /// @param dir direction
+    /// @param meet meet operator
+    CDataflow(const string title, const CCfg *cfg, EDirection dir, EMeet meet);
+
+    /// @brief solve the problem for @a size facts (called by the subclass constructors)
+    void Solve(size_t size);
+
+  private:
+    /// @brief apply the transfer functions of the instructions of block @a b to @a s
+    void TransferBlock(const CBasicBlock *b, CBitSet &s) const;
+
+    /// @brief print the set @a s to an output stream
+    void PrintSet(ostream &out, const CBitSet &s) const;
+
+    const string _title;             ///< name of the analysis
+    const CCfg *_cfg;                ///< control flow graph
+    EDirection _dir;                 ///< direction
+    EMeet _meet;                     ///< meet operator
+    size_t _size;                    ///< number of facts
+    vector<CBitSet> _in;             ///< facts at block entry (by block id)
+    vector<CBitSet> _out;            ///< facts at block exit (by block id)
+    size_t _visits;                  ///< number of block visits
+};
+
+/// @name CDataflow output operators
+/// @{
+
+/// @brief CDataflow output operator
+///
+/// @param out output stream
+/// @param t reference to CDataflow
+/// @retval output stream
+ostream& operator<<(ostream &out, const CDataflow &t);
+
+/// @brief CDataflow output operator
+///
+/// @param out output stream
+/// @param t reference to CDataflow
+/// @retval output stream
+ostream& operator<<(ostream &out, const CDataflow *t);
+
+/// @}
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief liveness analysis
+///
+/// backward may problem over the variables of the code block (see CVariables): a variable is
+/// live at a point if it is read on some path from that point before it is redefined. Only
+/// variables that are read before they are written in some block are facts; the others are
+/// never live at the boundary of a block.
+///
+/// To find the variables live at an instruction, walk the block backwards from GetOut() with
+/// Transfer() and track the block-local variables (GetFact() < 0) separately.
+///
+
+class CLiveness : public CDataflow {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor. Solves the problem.
+    /// @param cfg control flow graph
+    CLiveness(const CCfg *cfg);
+
+    /// @}
+
+
+    /// @name properties
+    /// @{
+
+    /// @brief return the variables
+    const CVariables& GetVariables(void) const { return _vars; };
+
+    /// @brief return the fact of variable @a var (-1 if the variable is local to blocks)
+    int GetFact(unsigned int var) const { return _fact[var]; };
+
+    /// @brief returns true if @a a is live at the exit of block @a b
+    ///
+    /// variables that are not numbered are always live.
+    bool IsLiveOut(const CBasicBlock *b, const CTac *a) const;
+
+    virtual void Transfer(const CTacInstr *i, CBitSet &s) const;
+    virtual string GetName(unsigned int index) const;
+
+    /// @}
+
+  private:
+    CVariables _vars;                ///< variables
+    vector<int> _fact;               ///< fact of a variable
+    vector<unsigned int> _var;       ///< variable of a fact
+    mutable vector<int> _uses;       ///< uses of an instruction (Transfer())
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief reaching definitions
+///
+/// forward may problem over the instructions that define a variable of the code block (see
+/// CVariables): a definition reaches a point if there is a path from it to that point on which
+/// the variable is not redefined. Only definitions of variables that are read before they are
+/// written in some block are facts; the uses of the other variables are only reached by the
+/// definitions before them in the same block.
+///
+
+class CReachingDefs : public CDataflow {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor. Solves the problem.
+    /// @param cfg control flow graph
+    CReachingDefs(const CCfg *cfg);
+
+    /// @}
+
+
+    /// @name properties
+    /// @{
+
+    /// @brief return the variables
+    const CVariables& GetVariables(void) const { return _vars; };
+
+    /// @brief return the definition @a index
+    const CTacInstr* GetDefinition(unsigned int index) const { return _defs[index]; };
+
+    /// @brief return the index of definition @a i (-1 if @a i is no fact)
+    int GetIndex(const CTacInstr *i) const;
+
+    virtual void Transfer(const CTacInstr *i, CBitSet &s) const;
+    virtual string GetName(unsigned int index) const;
+
+    /// @}
+
+  private:
+    CVariables _vars;                ///< variables
+    vector<const CTacInstr*> _defs;  ///< definitions
+    /// index of a definition
+    unordered_map<const CTacInstr*, unsigned int> _index;
+    vector<vector<unsigned int> > _vardefs; ///< definitions of a variable
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief available expressions
+///
+/// forward must problem over the arithmetic, logical and conversion operations whose operands
+/// are constants or variables of the code block (see CVariables): an expression is available at
+/// a point if it is computed on every path to that point and none of its operands is redefined
+/// after the computation. Expressions are identified by their operation and operands. Only
+/// expressions computed in at least two blocks are facts; the others are never available at
+/// the entry of a block that computes them.
+///
+
+class CAvailableExprs : public CDataflow {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor. Solves the problem.
+    /// @param cfg control flow graph
+    CAvailableExprs(const CCfg *cfg);
+
+    /// @}
+
+
+    /// @name properties
+    /// @{
+
+    /// @brief return the variables
+    const CVariables& GetVariables(void) const { return _vars; };
+
+    /// @brief return an instruction computing expression @a index
+    const CTacInstr* GetExpression(unsigned int index) const { return _exprs[index]; };
+
+    /// @brief return the index of the expression computed by @a i (-1 if none or not a fact)
+    int GetIndex(const CTacInstr *i) const;
+
+    virtual void Transfer(const CTacInstr *i, CBitSet &s) const;
+    virtual string GetName(unsigned int index) const;
+
+    /// @}
+
+  private:
+    CVariables _vars;                ///< variables
+    vector<const CTacInstr*> _exprs; ///< expressions
+    /// index of the expression computed by an instruction
+    unordered_map<const CTacInstr*, unsigned int> _index;
+    vector<vector<unsigned int> > _varexprs; ///< expressions reading a variable
+};
+
+
+#endif // __SnuPL_DATAFLOW_H__
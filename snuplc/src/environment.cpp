@@ -55,7 +55,15 @@ struct {
   { "run-dot", ptFlag,   "(do not) run the dot command automatically.",         "0" },
   { "console", ptFlag,   "output assembly code to console (instead of a file).","0" },
   { "exe",     ptFlag,   "(do not) run assembler on generated assembly code.",  "0" },
+  { "pipeline",ptFlag,   "(do not) run the scanner in its own thread.",         "0" },
   { "lib-path",ptSetting,"path to SnuPL/1 libraries.",                       "rte/" },
+  { "lex-threads",ptSetting,"number of threads used to lex large inputs.",   "1" },
+  { "parse-threads",ptSetting,"number of threads used to parse subroutines.","1" },
+  { "flat-ast",ptFlag,   "(do not) type check and lower the flattened AST.",   "0" },
+  { "single-pass",ptFlag,"(do not) compile in a single pass without an AST.",  "0" },
+  { "opt-level",ptSetting,"optimization level (0-2); also -O0, -O1, -O2.",   "0" },
+  { "time-passes",ptFlag,"(do not) report time and effect of each IR pass.",   "0" },
+  { "dump-after",ptSetting,"output the IR after each run of the given pass.", "" },
   { "target",  ptTarget, "target architecture.",                           "x86-64" },
   { "help",    ptSwitch, "print this help.",                                    "0" },
   { NULL }
@@ -129,7 +137,7 @@ void CEnvironment::Syntax(string msg)
   while (cit != _config.cend()) {
     if (get<0>(cit->second) == ptFlag) {
       cout << "    "
-           << "--[no-]" << setw(10) << cit->first
+           << "--[no-]" << setw(12) << cit->first
            << "  "
            << setw(52) << get<1>(cit->second)
            << "  Default: "
@@ -145,8 +153,8 @@ void CEnvironment::Syntax(string msg)
   while (cit != _config.cend()) {
     if (get<0>(cit->second) == ptSetting) {
       cout << "    "
-           << "--" << setw(10) << cit->first
-           << "       "
+           << "--" << setw(17) << cit->first
+           << "  "
            << setw(52) << get<1>(cit->second)
            << "  Default: "
            << get<2>(cit->second)
@@ -161,8 +169,8 @@ void CEnvironment::Syntax(string msg)
   while (cit != _config.cend()) {
     if (get<0>(cit->second) == ptSwitch) {
       cout << "    "
-           << "--" << setw(10) << cit->first
-           << "       "
+           << "--" << setw(17) << cit->first
+           << "  "
            << setw(52) << get<1>(cit->second)
            << endl;
     }
@@ -175,8 +183,8 @@ void CEnvironment::Syntax(string msg)
   while (cit != _config.cend()) {
     if (get<0>(cit->second) == ptTarget) {
       cout << "    "
-           << "--" << setw(10) << cit->first
-           << "       "
+           << "--" << setw(17) << cit->first
+           << "  "
            << setw(52) << get<1>(cit->second)
            << "  Default: "
            << get<2>(cit->second)
@@ -190,7 +198,7 @@ void CEnvironment::Syntax(string msg)
   auto tit = _target.cbegin();
   while (tit != _target.cend()) {
     cout << "      "
-         << setw(10) << tit->first
+         << setw(12) << tit->first
          << "       "
          << setw(52) << tit->second->GetName()
          << endl;
@@ -212,6 +220,11 @@ void CEnvironment::Syntax(string msg)
        << "  compile fibonacci.mod and also output the IR in textual and graphical form" << endl
        << "  The IR is saved in fibonacci.mod.tac (textual) and fibonacci.mod.tac.dot (graphical form)" << endl
        << "  $ snuplc --tac fibonacci.mod" << endl
+       << "  With --dot, the control flow graphs are saved in fibonacci.mod.cfg.dot" << endl
+       << endl
+       << "  compile fibonacci.mod with optimizations and report the time of each IR pass" << endl
+       << "  $ snuplc -O2 --time-passes fibonacci.mod" << endl
+       << "  With --dump-after dce, the IR after dead code elimination is saved in fibonacci.mod.dce.tac" << endl
        << endl;
 
   exit(EXIT_FAILURE);
@@ -224,7 +237,11 @@ void CEnvironment::ParseArguments(int argc, char *argv[])
   while (i < argc) {
     char *str = argv[i];
 
-    if ((strlen(str) > 2) && !strncmp(str, "--", 2)) {
+    if ((strlen(str) == 3) && !strncmp(str, "-O", 2)) {
+      // -O<level> is a shorthand for --opt-level <level>
+      get<2>(_config["opt-level"]) = string(str+2);
+
+    } else if ((strlen(str) > 2) && !strncmp(str, "--", 2)) {
       str += 2;
 
       bool bval = true;
@@ -271,6 +288,11 @@ void CEnvironment::ParseArguments(int argc, char *argv[])
   bool b;
   if (GetSwitch("help", b) && b) Syntax("");
 
+  string o;
+  if (GetSetting("opt-level", o) && ((o.size() != 1) || (o[0] < '0') || (o[0] > '2'))) {
+    Syntax("Unsupported optimization level: '" + o + "'.");
+  }
+
   string t;
   if (GetConfig("target", t)) {
     if (!SetTarget(t)) {
@@ -0,0 +1,144 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL string interner
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <cassert>
+#include <cstring>
+
+#include "intern.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// CInterner
+//
+CInterner* CInterner::_global_interner = NULL;
+
+#define INITIAL_SIZE 4096           ///< initial number of hash table slots (power of 2)
+
+/// @brief FNV-1a hash of a character range
+static unsigned int Hash(const char *str, size_t len)
+{
+  unsigned int h = 2166136261u;
+  for (size_t i=0; i<len; i++) {
+    h ^= (unsigned char)str[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+CInterner::CInterner(void)
+  : _size(0), _table(INITIAL_SIZE, -1), _concurrent(false)
+{
+  memset(_blocks, 0, sizeof(_blocks));
+
+  int id = Intern("", 0);
+  assert(id == 0);
+}
+
+CInterner::~CInterner(void)
+{
+  for (int b=0; (b<MAX_BLOCKS) && (_blocks[b] != NULL); b++) delete [] _blocks[b];
+}
+
+CInterner* CInterner::Get(void)
+{
+  if (_global_interner == NULL) _global_interner = new CInterner();
+
+  return _global_interner;
+}
+
+int CInterner::Intern(const char *str, size_t len)
+{
+  unique_lock<mutex> guard(_lock, defer_lock);
+  if (_concurrent) guard.lock();
+
+  unsigned int hash = Hash(str, len);
+  size_t slot = Lookup(str, len, hash);
+
+  if (_table[slot] != -1) return _table[slot];
+
+  int id = _size;
+  int b = id >> BLOCK_BITS;
+  assert(b < MAX_BLOCKS);
+  if (_blocks[b] == NULL) _blocks[b] = new string[BLOCK_SIZE];
+  _blocks[b][id & (BLOCK_SIZE-1)].assign(str, len);
+  _size++;
+
+  _hashes.push_back(hash);
+  _table[slot] = id;
+
+  // keep the load factor below 50%
+  if (2*(size_t)_size > _table.size()) Grow();
+
+  return id;
+}
+
+int CInterner::Intern(const string &str)
+{
+  return Intern(str.data(), str.size());
+}
+
+int CInterner::Find(const string &str) const
+{
+  unique_lock<mutex> guard(_lock, defer_lock);
+  if (_concurrent) guard.lock();
+
+  size_t slot = Lookup(str.data(), str.size(), Hash(str.data(), str.size()));
+  return _table[slot];
+}
+
+size_t CInterner::Lookup(const char *str, size_t len, unsigned int hash) const
+{
+  size_t mask = _table.size() - 1;
+  size_t slot = hash & mask;
+
+  while (true) {
+    int id = _table[slot];
+    if (id == -1) return slot;
+
+    const string &s = GetString(id);
+    if ((_hashes[id] == hash) && (s.size() == len) && (memcmp(s.data(), str, len) == 0)) {
+      return slot;
+    }
+
+    slot = (slot + 1) & mask;
+  }
+}
+
+void CInterner::Grow(void)
+{
+  vector<int> table(2*_table.size(), -1);
+  size_t mask = table.size() - 1;
+
+  for (size_t id=0; id<(size_t)_size; id++) {
+    size_t slot = _hashes[id] & mask;
+    while (table[slot] != -1) slot = (slot + 1) & mask;
+    table[slot] = (int)id;
+  }
+
+  _table.swap(table);
+}
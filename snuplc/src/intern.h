@@ -0,0 +1,135 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL string interner
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_INTERN_H__
+#define __SnuPL_INTERN_H__
+
+#include <mutex>
+#include <string>
+#include <vector>
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief string interner
+///
+/// maps every distinct string (identifiers, numbers, string constants, ...) to a small integer id.
+/// Two strings are equal iff their ids are equal, so tokens, symbols and symbol tables store and
+/// compare ids instead of copying strings around. Interned strings are never released; references
+/// returned by GetString() remain valid for the lifetime of the interner.
+/// The empty string always has id 0.
+///
+/// GetString() never blocks and may be called concurrently with Intern() for ids that have been
+/// handed over properly (strings are stored in blocks that never move). Intern() and Find() are
+/// only thread-safe after SetConcurrent(true); otherwise concurrent users work on local interners
+/// and merge them into the global one afterwards.
+///
+class CInterner {
+  public:
+    /// @name constructor/destructor
+    /// @{
+
+    /// @brief constructor for a local interner (e.g., for a worker thread)
+    ///
+    /// Ids of a local interner are only meaningful within that interner.
+    CInterner(void);
+    virtual ~CInterner(void);
+
+    /// @}
+
+    /// @brief return the global interner
+    static CInterner* Get(void);
+
+    /// @brief enable/disable locking for concurrent interning
+    ///
+    /// @param concurrent true: Intern() and Find() may be called from several threads
+    void SetConcurrent(bool concurrent) { _concurrent = concurrent; };
+
+    /// @name interning
+    /// @{
+
+    /// @brief intern a string given as a character range
+    ///
+    /// @param str pointer to the first character
+    /// @param len length of the string
+    /// @retval id of the (possibly newly added) string
+    int Intern(const char *str, size_t len);
+
+    /// @brief intern a string
+    ///
+    /// @param str string
+    /// @retval id of the (possibly newly added) string
+    int Intern(const string &str);
+
+    /// @brief look up a string without adding it
+    ///
+    /// @param str string
+    /// @retval id of the string
+    /// @retval -1 if the string has not been interned
+    int Find(const string &str) const;
+
+    /// @brief return the string for a given id
+    ///
+    /// @param id string id
+    /// @retval interned string
+    const string& GetString(int id) const
+    {
+      return _blocks[id >> BLOCK_BITS][id & (BLOCK_SIZE-1)];
+    };
+
+    /// @brief return the number of interned strings
+    size_t GetSize(void) const { return _size; };
+
+    /// @}
+
+  private:
+    static const int BLOCK_BITS = 12;                 ///< log2 of strings per block
+    static const int BLOCK_SIZE = 1 << BLOCK_BITS;    ///< strings per block
+    static const int MAX_BLOCKS = 1 << 14;            ///< maximal number of blocks
+
+    /// @brief find the hash table slot of a string
+    ///
+    /// @param str pointer to the first character
+    /// @param len length of the string
+    /// @param hash hash value of the string
+    /// @retval slot index; the slot is either empty (-1) or holds the string's id
+    size_t Lookup(const char *str, size_t len, unsigned int hash) const;
+
+    /// @brief double the size of the hash table and rehash all strings
+    void Grow(void);
+
+    string              *_blocks[MAX_BLOCKS]; ///< interned strings, indexed by id
+    int                  _size;     ///< number of interned strings
+    vector<unsigned int> _hashes;   ///< hash values of interned strings, indexed by id
+    vector<int>          _table;    ///< open-addressing hash table (ids, -1 = empty)
+    bool                 _concurrent; ///< lock in Intern()/Find()
+    mutable mutex        _lock;     ///< lock for concurrent interning
+
+    static CInterner *_global_interner; ///< global interner instance
+};
+
+#endif // __SnuPL_INTERN_H__
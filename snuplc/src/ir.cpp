@@ -38,6 +38,7 @@
 
 #include "ir.h"
 #include "ast.h"
+#include "astflat.h"
 using namespace std;
 
 
@@ -91,6 +92,10 @@ char EOperationName[][OPERATION_STRLEN] = {
   "return",                         ///< return: return optional src1
   "param",                          ///< parameter: dst = index, src1 = parameter
 
+  // static single assignment
+  // dst = phi(src_1, ..., src_n), one source per predecessor block
+  "phi",                            ///< phi function
+
   // special
   "label",                          ///< jump label; no arguments
   "nop",                            ///< no operation
@@ -113,11 +118,87 @@ ostream& operator<<(ostream &out, EOperation t)
 }
 
 
+//--------------------------------------------------------------------------------------------------
+// CTacArena
+//
+thread_local CTacArena* CTacArena::_current = NULL;
+
+CTacArena::CTacArena(size_t blocksize)
+  : _blocksize(blocksize), _next(4*1024 < blocksize ? 4*1024 : blocksize),
+    _top(NULL), _end(NULL), _size(0), _objs(NULL), _numobjs(0)
+{
+}
+
+CTacArena::~CTacArena(void)
+{
+  // objects do not reference each other on destruction; the reverse order only mirrors
+  // construction
+  for (SObjects *c = _objs; c != NULL; c = c->prev) {
+    for (size_t i = c->count; i > 0; i--) c->obj[i-1]->~CTac();
+  }
+
+  for (size_t i = 0; i < _blocks.size(); i++) delete [] _blocks[i];
+}
+
+void* CTacArena::Allocate(size_t size)
+{
+  // TAC objects hold pointers, integers and strings; none requires more than 8-byte alignment
+  const size_t align = 8;
+  size = (size + align - 1) & ~(align - 1);
+
+  if ((size_t)(_end - _top) < size) {
+    // most code blocks are small; start with a small block and double its size up to the
+    // block size
+    _top = new char[_next];
+    _end = _top + _next;
+    _blocks.push_back(_top);
+    if (_next < _blocksize) _next *= 2;
+  }
+
+  void *p = _top;
+  _top += size;
+  _size += size;
+  return p;
+}
+
+void CTacArena::Register(CTac *tac)
+{
+  const size_t n = sizeof(_objs->obj) / sizeof(_objs->obj[0]);
+
+  if ((_objs == NULL) || (_objs->count == n)) {
+    SObjects *c = static_cast<SObjects*>(Allocate(sizeof(SObjects)));
+    c->prev = _objs;
+    c->count = 0;
+    _objs = c;
+  }
+
+  _objs->obj[_objs->count++] = tac;
+  _numobjs++;
+}
+
+CTacArena* CTacArena::SetCurrent(CTacArena *arena)
+{
+  CTacArena *prev = _current;
+  _current = arena;
+  return prev;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 // CTac
 //
-CTac::CTac(void)
+CTac::CTac(ETacKind kind)
+  : _kind(kind)
+{
+  CTacArena *arena = CTacArena::GetCurrent();
+  if (arena != NULL) arena->Register(this);
+}
+
+void* CTac::operator new(size_t size)
 {
+  CTacArena *arena = CTacArena::GetCurrent();
+  if (arena != NULL) return arena->Allocate(size);
+  else return ::operator new(size);
 }
 
 CTac::~CTac(void)
@@ -135,16 +216,60 @@ ostream& operator<<(ostream &out, const CTac *t)
 }
 
 
+//--------------------------------------------------------------------------------------------------
+// CTacUse
+//
+int CTacUse::GetIndex(void) const
+{
+  if ((this >= _user->_use) && (this < _user->_use + 3)) return (int)(this - _user->_use);
+
+  // argument slot of a phi function
+  return (int)(this - cast<CTacPhi>(_user)->_argu.data()) + 1;
+}
+
+CTacAddr* CTacUse::Get(void) const
+{
+  return _user->GetOperand(GetIndex());
+}
+
+bool CTacUse::IsDef(void) const
+{
+  const CTacAddr *op = Get();
+  return (GetIndex() == 0) && (isa<CTacName>(op) || isa<CTacTemp>(op));
+}
+
+void CTacUse::Link(CTacUse **head)
+{
+  assert(_pprev == NULL);
+
+  _next = *head;
+  if (_next != NULL) _next->_pprev = &_next;
+  _pprev = head;
+  *head = this;
+}
+
+void CTacUse::Unlink(void)
+{
+  if (_pprev == NULL) return;
+
+  *_pprev = _next;
+  if (_next != NULL) _next->_pprev = _pprev;
+  _next = NULL;
+  _pprev = NULL;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 // CTacAddr
 //
-CTacAddr::CTacAddr(const CType *type)
-  : _type(type)
+CTacAddr::CTacAddr(ETacKind kind, const CType *type)
+  : CTac(kind), _type(type), _uses(NULL), _defs(NULL)
 {
   assert(type != NULL);
 }
 
-CTacAddr::CTacAddr(void)
+CTacAddr::CTacAddr(ETacKind kind)
+  : CTac(kind), _uses(NULL), _defs(NULL)
 {
 }
 
@@ -157,12 +282,47 @@ const CType* CTacAddr::GetType(void) const
   return _type;
 }
 
+CTacInstr* CTacAddr::GetDef(void) const
+{
+  if ((_defs == NULL) || (_defs->GetNext() != NULL)) return NULL;
+  return _defs->GetUser();
+}
+
+bool CTacAddr::ReplaceAllUsesWith(CTacAddr *addr)
+{
+  assert((addr != NULL) && (addr != this));
+  assert(isa<CTacTemp>(this));
+
+  CTacTemp *temp = dyn_cast<CTacTemp>(addr);
+  CTacUse *u = _uses;
+  bool done = true;
+
+  while (u != NULL) {
+    CTacUse *next = u->GetNext();
+    CTacReference *ref = dyn_cast<CTacReference>(u->Get());
+
+    if (ref == NULL) {
+      u->GetUser()->SetOperand(u->GetIndex(), addr);
+    } else if (temp != NULL) {
+      u->Unlink();
+      ref->_temp = temp;
+      u->Link(&temp->_uses);
+    } else {
+      done = false;
+    }
+
+    u = next;
+  }
+
+  return done;
+}
+
 
 //--------------------------------------------------------------------------------------------------
 // CTacConst
 //
 CTacConst::CTacConst(long long value, const CType *type)
-  : CTacAddr(type), _value(value)
+  : CTacAddr(tkConst, type), _value(value)
 {
 }
 
@@ -171,6 +331,11 @@ long long CTacConst::GetValue(void) const
   return _value;
 }
 
+const CType* CTacConst::GetType(void) const
+{
+  return _type;
+}
+
 ostream& CTacConst::print(ostream &out, int indent) const
 {
   string ind(indent, ' ');
@@ -185,7 +350,7 @@ ostream& CTacConst::print(ostream &out, int indent) const
 // CTacName
 //
 CTacName::CTacName(const CSymbol *symbol)
-  : _symbol(symbol)
+  : CTacAddr(tkName), _symbol(symbol)
 {
   assert(symbol != NULL);
   _type = symbol->GetDataType();
@@ -209,18 +374,37 @@ const CSymbol* CTacName::GetSymbol(void) const
 //--------------------------------------------------------------------------------------------------
 // CTacTemp
 //
-CTacTemp::CTacTemp(const CSymbol *symbol)
-  : CTacName(symbol)
+CTacTemp::CTacTemp(unsigned int id, const CType *type)
+  : CTacAddr(tkTemp, type), _id(id)
 {
 }
 
+unsigned int CTacTemp::GetId(void) const
+{
+  return _id;
+}
+
+ostream& CTacTemp::print(ostream &out, int indent) const
+{
+  string ind(indent, ' ');
+
+  out << ind << "t" << _id;
+
+  return out;
+}
+
 
 //--------------------------------------------------------------------------------------------------
 // CTacReference
 //
-CTacReference::CTacReference(const CSymbol *symbol, const CSymbol *deref)
-  : CTacName(symbol), _deref(deref)
+CTacReference::CTacReference(CTacTemp *temp, const CSymbol *deref)
+  : CTacAddr(tkReference, temp->GetType()), _temp(temp), _deref(deref)
+{
+}
+
+CTacTemp* CTacReference::GetTemp(void) const
 {
+  return _temp;
 }
 
 const CSymbol* CTacReference::GetDerefSymbol(void) const
@@ -232,7 +416,8 @@ ostream& CTacReference::print(ostream &out, int indent) const
 {
   string ind(indent, ' ');
 
-  out << ind << "@" << _symbol->GetName();
+  out << ind << "@";
+  _temp->print(out);
 
   return out;
 }
@@ -242,27 +427,30 @@ ostream& CTacReference::print(ostream &out, int indent) const
 // CTacInstr
 //
 CTacInstr::CTacInstr(string name)
-  : _id(-1), _op(opNop), _name(name), _src1(NULL), _src2(NULL), _dst(NULL)
+  : CTac(tkInstr), _id(-1), _op(opNop), _name(name), _src1(NULL), _src2(NULL), _dst(NULL),
+    _prev(NULL), _next(NULL), _block(NULL)
 {
+  for (int i=0; i<3; i++) {
+    _use[i]._user = this;
+    _use[i]._next = NULL;
+    _use[i]._pprev = NULL;
+  }
 }
 
 CTacInstr::CTacInstr(EOperation op, CTac *dst, CTacAddr *src1, CTacAddr *src2)
-  : _id(-1), _op(op), _src1(src1), _src2(src2), _dst(dst)
+  : CTac(tkInstr), _id(-1), _op(op), _src1(src1), _src2(src2), _dst(dst),
+    _prev(NULL), _next(NULL), _block(NULL)
 {
-  if (IsBranch()) {
-    CTacLabel *lbl = dynamic_cast<CTacLabel*>(_dst);
-    assert(lbl != NULL);
-    lbl->AddReference(1);
+  for (int i=0; i<3; i++) {
+    _use[i]._user = this;
+    _use[i]._next = NULL;
+    _use[i]._pprev = NULL;
   }
+  if (IsBranch()) cast<CTacLabel>(_dst)->AddReference(1);
 }
 
 CTacInstr::~CTacInstr(void)
 {
-  if (IsBranch()) {
-    CTacLabel *lbl = dynamic_cast<CTacLabel*>(_dst);
-    assert(lbl != NULL);
-    lbl->AddReference(-1);
-  }
 }
 
 unsigned int CTacInstr::GetId(void) const
@@ -304,9 +492,75 @@ CTac* CTacInstr::GetDest(void) const
   return _dst;
 }
 
+void CTacInstr::SetSrc(int index, CTacAddr *src)
+{
+  assert((index == 1) || (index == 2));
+  SetOperand(index, src);
+}
+
 void CTacInstr::SetDest(CTac* dst)
 {
-  _dst = dst;
+  if (IsBranch()) {
+    cast<CTacLabel>(_dst)->AddReference(-1);
+    cast<CTacLabel>(dst)->AddReference(1);
+  }
+  SetOperand(0, dst);
+}
+
+int CTacInstr::GetNumOperands(void) const
+{
+  const CTacPhi *phi = dyn_cast<CTacPhi>(this);
+  return phi != NULL ? (int)phi->_args.size() + 1 : 3;
+}
+
+CTacUse* CTacInstr::GetSlot(int index)
+{
+  CTacPhi *phi = dyn_cast<CTacPhi>(this);
+  return (phi != NULL) && (index > 0) ? &phi->_argu[index-1] : &_use[index];
+}
+
+CTacAddr* CTacInstr::GetOperand(int index) const
+{
+  const CTacPhi *phi = dyn_cast<CTacPhi>(this);
+  if ((phi != NULL) && (index > 0)) return phi->_args[index-1];
+
+  switch (index) {
+    case 0: return dyn_cast<CTacAddr>(_dst);
+    case 1: return _src1;
+    case 2: return _src2;
+  }
+  return NULL;
+}
+
+void CTacInstr::SetOperand(int index, CTac *op)
+{
+  GetSlot(index)->Unlink();
+
+  CTacPhi *phi = dyn_cast<CTacPhi>(this);
+  if ((phi != NULL) && (index > 0)) {
+    phi->_args[index-1] = op != NULL ? cast<CTacAddr>(op) : NULL;
+  } else {
+    switch (index) {
+      case 0: _dst = op; break;
+      case 1: _src1 = cast<CTacAddr>(op); break;
+      case 2: _src2 = op != NULL ? cast<CTacAddr>(op) : NULL; break;
+    }
+  }
+
+  if (_block != NULL) LinkOperand(index);
+}
+
+void CTacInstr::LinkOperand(int index)
+{
+  CTacAddr *op = GetOperand(index);
+  if (op == NULL) return;
+
+  CTacUse *u = GetSlot(index);
+  CTacReference *ref = dyn_cast<CTacReference>(op);
+
+  if (ref != NULL) u->Link(&ref->GetTemp()->_uses);
+  else if (u->IsDef()) u->Link(&op->_defs);
+  else u->Link(&op->_uses);
 }
 
 ostream& CTacInstr::print(ostream &out, int indent) const
@@ -321,18 +575,17 @@ ostream& CTacInstr::print(ostream &out, int indent) const
     out << "    " << left << setw(6);
     if (relop) out << "if"; else out << _op;
     out << " ";
-    CTacAddr *adr = dynamic_cast<CTacAddr*>(_dst);
-    if (adr != NULL) out << _dst << " <- ";
+    if (isa<CTacAddr>(_dst)) out << _dst << " <- ";
     if (_src1 != NULL) out << _src1;
     if (_src2 != NULL) {
       if (relop) out << " " << _op; else out << ",";
       out << " " << _src2;
     }
-    CTacInstr *target = dynamic_cast<CTacInstr*>(_dst);
+    CTacInstr *target = dyn_cast<CTacInstr>(_dst);
     if (target != NULL) {
       if (relop) out << " goto ";
 
-      CTacLabel *l = dynamic_cast<CTacLabel*>(target);
+      CTacLabel *l = dyn_cast<CTacLabel>(target);
       if (l != NULL) out << l->GetLabel();
       else out << target->GetId();
     }
@@ -350,6 +603,7 @@ ostream& CTacInstr::print(ostream &out, int indent) const
 CTacLabel::CTacLabel(const string label)
   : CTacInstr(opLabel, NULL), _label(label), _refcnt(0)
 {
+  _kind = tkLabel;
 }
 
 CTacLabel::~CTacLabel(void)
@@ -387,11 +641,79 @@ ostream& CTacLabel::print(ostream &out, int indent) const
 }
 
 
+//--------------------------------------------------------------------------------------------------
+// CTacPhi
+//
+CTacPhi::CTacPhi(CTacAddr *dst, unsigned int nargs)
+  : CTacInstr(opPhi, dst), _args(nargs, NULL), _preds(nargs, NULL), _argu(nargs)
+{
+  _kind = tkPhi;
+
+  for (size_t i=0; i<_argu.size(); i++) {
+    _argu[i]._user = this;
+    _argu[i]._next = NULL;
+    _argu[i]._pprev = NULL;
+  }
+}
+
+CTacPhi::~CTacPhi(void)
+{
+}
+
+unsigned int CTacPhi::GetNumArgs(void) const
+{
+  return _args.size();
+}
+
+CTacAddr* CTacPhi::GetArg(unsigned int index) const
+{
+  assert(index < _args.size());
+  return _args[index];
+}
+
+void CTacPhi::SetArg(unsigned int index, CTacAddr *arg)
+{
+  assert(index < _args.size());
+  SetOperand(index+1, arg);
+}
+
+CTacLabel* CTacPhi::GetPred(unsigned int index) const
+{
+  assert(index < _preds.size());
+  return _preds[index];
+}
+
+void CTacPhi::SetPred(unsigned int index, CTacLabel *pred)
+{
+  assert(index < _preds.size());
+  if (_preds[index] != NULL) _preds[index]->AddReference(-1);
+  if (pred != NULL) pred->AddReference(1);
+  _preds[index] = pred;
+}
+
+ostream& CTacPhi::print(ostream &out, int indent) const
+{
+  string ind(indent, ' ');
+
+  out << ind << right << dec << setw(3) << _id << ": "
+      << "    " << left << setw(6) << _op << " ";
+  if (_dst != NULL) out << _dst << " <- ";
+
+  for (size_t i=0; i<_args.size(); i++) {
+    if (i > 0) out << ", ";
+    if (_args[i] != NULL) out << _args[i]; else out << "?";
+    if (_preds[i] != NULL) out << " (" << _preds[i]->GetLabel() << ")"; else out << " (entry)";
+  }
+
+  return out;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 // CScope
 //
-CScope::CScope(CAstNode *ast, CScope *parent)
-  : _ast(ast), _parent(parent), _temp_id(0), _label_id(0)
+CScope::CScope(CAstNode *ast, CScope *parent, const CAstFlat *flat, bool lower)
+  : _ast(ast), _parent(parent), _label_id(0)
 {
   CAstScope *s = dynamic_cast<CAstScope*>(ast);
   assert(s != NULL);
@@ -399,17 +721,45 @@ CScope::CScope(CAstNode *ast, CScope *parent)
   _name = s->GetName();
   _symtab = s->GetSymbolTable();
   _cb = new CCodeBlock(this);
-  s->ToTac(_cb);
+
+  if (!lower) {
+    if (_parent != NULL) _parent->_children.push_back(this);
+    return;
+  }
+
+  // instructions, temporaries, labels and addresses are owned by the code block
+  CTacArena *prev = CTacArena::SetCurrent(_cb->GetArena());
+  if (flat != NULL) {
+    unsigned int n = flat->FindScope(s);
+    assert(n != CAstFlat::None);
+    flat->ToTac(n, _cb);
+  } else {
+    s->ToTac(_cb);
+  }
+  CTacArena::SetCurrent(prev);
 
   for (size_t i=0; i<s->GetNumChildren(); i++) {
-    CProcedure *p = new CProcedure(s->GetChild(i), this);
+    CProcedure *p = new CProcedure(s->GetChild(i), this, flat);
     _children.push_back(p);
   }
 }
 
+CScope::CScope(const string name, CSymtab *symtab, CScope *parent)
+  : _ast(NULL), _name(name), _symtab(symtab), _parent(parent), _label_id(0)
+{
+  assert(symtab != NULL);
+
+  _cb = new CCodeBlock(this);
+  if (_parent != NULL) _parent->_children.push_back(this);
+}
+
 CScope::~CScope(void)
 {
+  for (size_t i=0; i<_children.size(); i++) delete _children[i];
   delete _cb;
+
+  // the symbol table of a scope with an AST is owned by the AST
+  if (_ast == NULL) delete _symtab;
 }
 
 string CScope::GetName(void) const
@@ -437,31 +787,17 @@ CCodeBlock* CScope::GetCodeBlock(void) const
   return _cb;
 }
 
-CTacTemp* CScope::CreateTemp(const CType *type, string name, CStorage *store)
+CTacTemp* CScope::CreateTemp(const CType *type)
 {
-  CSymtab *st = GetSymbolTable();
-  CSymbol *s = NULL;
-
-  if (name == "") name = "t";
-
-  if (st->FindSymbol(name, sGlobal) != NULL) {
-    // in case of name clashes we simply iterate until we find a
-    // name that has not yet been used
-    do {
-      ostringstream tmp;
-      tmp << name << _temp_id++;
-      if (st->FindSymbol(tmp.str(), sGlobal) == NULL) {
-        name = tmp.str();
-        break;
-      }
-    } while (true);
-  }
+  CTacTemp *t = new CTacTemp(_temps.size(), type);
+  _temps.push_back(t);
 
-  s = new CSymLocal(name, type);
-  if (store != NULL) s->SetLocation(store);
-  st->AddSymbol(s);
+  return t;
+}
 
-  return new CTacTemp(s);
+const vector<CTacTemp*>& CScope::GetTemps(void) const
+{
+  return _temps;
 }
 
 CTacLabel* CScope::CreateLabel(const char *hint)
@@ -482,6 +818,22 @@ ostream& CScope::print(ostream &out, int indent) const
   return out;
 }
 
+void CScope::printTemps(ostream &out, int indent) const
+{
+  if (_temps.empty()) return;
+
+  string ind(indent, ' ');
+
+  out << ind << "[[ temporaries" << endl;
+  for (size_t i=0; i<_temps.size(); i++) {
+    ostringstream name;
+    _temps[i]->print(name);
+    out << ind << "  [ $" << left << setw(8) << name.str() << " " << _temps[i]->GetType()
+        << " ]" << endl;
+  }
+  out << ind << "]]" << endl;
+}
+
 string CScope::dotID(void) const
 {
   return GetName();
@@ -510,8 +862,13 @@ ostream& operator<<(ostream &out, const CScope *t)
 //--------------------------------------------------------------------------------------------------
 // CModule
 //
-CModule::CModule(CAstNode *ast)
-  : CScope(ast, NULL)
+CModule::CModule(CAstNode *ast, const CAstFlat *flat, bool lower)
+  : CScope(ast, NULL, flat, lower)
+{
+}
+
+CModule::CModule(const string name, CSymtab *symtab)
+  : CScope(name, symtab)
 {
 }
 
@@ -531,6 +888,7 @@ ostream& CModule::print(ostream &out, int indent) const
   out << ind << "[[ module: " << GetName() << endl;
   CTypeManager::Get()->print(out, indent+2);
   GetSymbolTable()->print(out, indent+2);
+  printTemps(out, indent+2);
   _cb->print(out, indent+2);
 
   for (size_t i=0; i<_children.size(); i++) {
@@ -546,8 +904,13 @@ ostream& CModule::print(ostream &out, int indent) const
 //--------------------------------------------------------------------------------------------------
 // CProcedure
 //
-CProcedure::CProcedure(CAstNode *ast, CScope *parent)
-  : CScope(ast, parent)
+CProcedure::CProcedure(CAstNode *ast, CScope *parent, const CAstFlat *flat, bool lower)
+  : CScope(ast, parent, flat, lower), _decl(NULL)
+{
+}
+
+CProcedure::CProcedure(CSymProc *decl, CScope *parent, CSymtab *symtab)
+  : CScope(decl->GetName(), symtab, parent), _decl(decl)
 {
 }
 
@@ -557,6 +920,8 @@ CProcedure::~CProcedure(void)
 
 CSymbol* CProcedure::GetDeclaration(void) const
 {
+  if (_ast == NULL) return _decl;
+
   CAstProcedure *s = dynamic_cast<CAstProcedure*>(_ast);
   assert(s != NULL);
 
@@ -567,8 +932,18 @@ ostream& CProcedure::print(ostream &out, int indent) const
 {
   string ind(indent, ' ');
 
-  out << ind << "[[ procedure: " << GetName() << endl;
+  // the parameters in declaration order (the symbol table is listed by name)
+  const CSymProc *decl = dynamic_cast<const CSymProc*>(GetDeclaration());
+  assert(decl != NULL);
+
+  out << ind << "[[ procedure: " << GetName() << "(";
+  for (unsigned int i=0; i<decl->GetNParams(); i++) {
+    if (i > 0) out << ",";
+    out << decl->GetParam(i)->GetName();
+  }
+  out << ")" << endl;
   GetSymbolTable()->print(out, indent+2);
+  printTemps(out, indent+2);
   _cb->print(out, indent+2);
 
   for (size_t i=0; i<_children.size(); i++) {
@@ -585,7 +960,7 @@ ostream& CProcedure::print(ostream &out, int indent) const
 // CCodeBlock
 //
 CCodeBlock::CCodeBlock(CScope *owner)
-  : _owner(owner), _inst_id(0)
+  : _owner(owner), _first(NULL), _last(NULL), _ninstr(0), _inst_id(0)
 {
   assert(_owner != NULL);
 }
@@ -609,63 +984,103 @@ CTacTemp* CCodeBlock::CreateTemp(const CType *type)
   return _owner->CreateTemp(type);
 }
 
+CTacConst* CCodeBlock::CreateConst(long long value, const CType *type)
+{
+  CTacConst *&c = _consts[ConstKey(type, value)];
+  if (c == NULL) c = new CTacConst(value, type);
+
+  return c;
+}
+
 CTacLabel* CCodeBlock::CreateLabel(const char *hint)
 {
   return _owner->CreateLabel(hint);
 }
 
+CTacArena* CCodeBlock::GetArena(void)
+{
+  return &_arena;
+}
+
 CTacInstr* CCodeBlock::AddInstr(CTacInstr *instr)
 {
   assert(instr != NULL);
   instr->SetId(_inst_id++);
-  _ops.push_back(instr);
 
-  return instr;
+  return InsertInstr(NULL, instr);
 }
 
-const list<CTacInstr*>& CCodeBlock::GetInstr(void) const
+CTacInstr* CCodeBlock::InsertInstr(CTacInstr *pos, CTacInstr *instr)
 {
-  return _ops;
+  assert((instr != NULL) && (instr->_block == NULL));
+
+  CTacInstr *prev = pos != NULL ? pos->_prev : _last;
+
+  instr->_prev = prev;
+  instr->_next = pos;
+  if (prev != NULL) prev->_next = instr; else _first = instr;
+  if (pos != NULL) pos->_prev = instr; else _last = instr;
+  _ninstr++;
+
+  instr->_block = this;
+  for (int i=0; i<instr->GetNumOperands(); i++) instr->LinkOperand(i);
+
+  return instr;
 }
 
-void CCodeBlock::CleanupControlFlow(void)
+CTacInstr* CCodeBlock::RemoveInstr(CTacInstr *instr)
 {
-  list<CTacInstr*>::iterator it = _ops.begin();
+  assert((instr != NULL) && (instr->_block == this));
 
-  // 1. pass: delete all branches (absolute/conditional) that jump to the
-  //          immediately next instruction. Deleting branch instruction will
-  //          automatically decrease the reference count of the target label.
-  while (it != _ops.end()) {
-    CTacInstr *instr = *it++;
+  CTacInstr *next = instr->_next;
 
-    if (instr->IsBranch()) {
-      CTacLabel *lbl = dynamic_cast<CTacLabel*>(instr->GetDest());
-      CTacInstr *next = (it == _ops.end() ? NULL : *it);
+  if (instr->_prev != NULL) instr->_prev->_next = next; else _first = next;
+  if (next != NULL) next->_prev = instr->_prev; else _last = instr->_prev;
+  instr->_prev = instr->_next = NULL;
+  _ninstr--;
 
-      if ((lbl != NULL) && (lbl == next)) {
-        delete instr;
-        it = _ops.erase(--it);
-      }
+  instr->_block = NULL;
+  for (int i=0; i<instr->GetNumOperands(); i++) instr->GetSlot(i)->Unlink();
+
+  return next;
+}
+
+void CCodeBlock::CleanupControlFlow(void)
+{
+  // 1. pass: remove all branches (absolute/conditional) that jump to the
+  //          immediately next instruction and decrease the reference count
+  //          of the target label. The instructions are owned by the arena.
+  CTacInstr *instr = _first;
+  while (instr != NULL) {
+    CTacInstr *next = instr->GetNext();
+
+    if (instr->IsBranch() && (instr->GetDest() == next)) {
+      cast<CTacLabel>(next)->AddReference(-1);
+      RemoveInstr(instr);
     }
+
+    instr = next;
   }
 
   // 2. pass: remove all labels with reference count 0
-  it = _ops.begin();
-  while (it != _ops.end()) {
-    CTacInstr *instr = *it++;
+  instr = _first;
+  while (instr != NULL) {
+    CTacLabel *lbl = dyn_cast<CTacLabel>(instr);
 
-    CTacLabel *lbl = dynamic_cast<CTacLabel*>(instr);
-
-    if ((lbl != NULL) && (lbl->GetRefCnt() == 0)) {
-      delete lbl;
-      it = _ops.erase(--it);
-    }
+    if ((lbl != NULL) && (lbl->GetRefCnt() == 0)) instr = RemoveInstr(lbl);
+    else instr = instr->GetNext();
   }
 
   // 3. renumber instructions (we shouldn't do that really, but it's prettier)
+  Renumber();
+}
+
+void CCodeBlock::Renumber(void)
+{
   _inst_id = 0;
-  it = _ops.begin();
-  while (it != _ops.end()) (*it++)->SetId(_inst_id++);
+  for (CTacInstr *instr = _first; instr != NULL; instr = instr->GetNext()) {
+    instr->SetId(_inst_id++);
+  }
 }
 
 ostream& CCodeBlock::print(ostream &out, int indent) const
@@ -674,9 +1089,8 @@ ostream& CCodeBlock::print(ostream &out, int indent) const
 
   out << ind << "[[ " << GetName() << endl;
 
-  list<CTacInstr*>::const_iterator it = _ops.begin();
-  while (it != _ops.end()) {
-    (*it++)->print(out, indent+2);
+  for (CTacInstr *i = _first; i != NULL; i = i->GetNext()) {
+    i->print(out, indent+2);
     out << endl;
   }
 
@@ -698,9 +1112,8 @@ string CCodeBlock::dotAttr(void) const
 
   o << " [label=\"" << GetName() << "\\r";
 
-  list<CTacInstr*>::const_iterator it = _ops.begin();
-  while (it != _ops.end()) {
-    (*it++)->print(o, 0);
+  for (CTacInstr *i = _first; i != NULL; i = i->GetNext()) {
+    i->print(o, 0);
     o << "\\l";
   }
 
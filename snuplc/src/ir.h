@@ -36,8 +36,9 @@
 #ifndef __SnuPL_IR_H__
 #define __SnuPL_IR_H__
 
+#include <cassert>
 #include <iostream>
-#include <list>
+#include <unordered_map>
 #include <vector>
 
 #include "symtab.h"
@@ -91,6 +92,10 @@ enum EOperation {
   opReturn,                         ///< return: return optional src1
   opParam,                          ///< parameter: dst = index,src1 = parameter
 
+  // static single assignment
+  // dst = phi(src_1, ..., src_n), one source per predecessor block
+  opPhi,                            ///< phi function (CTacPhi)
+
   // special
   opLabel,                          ///< jump label; no arguments
   opNop,                            ///< no operation
@@ -106,6 +111,111 @@ bool IsRelOp(EOperation t);
 /// @retval output stream
 ostream& operator<<(ostream &out, EOperation t);
 
+//--------------------------------------------------------------------------------------------------
+/// @brief kinds of three-address code objects
+///
+/// every CTac carries its kind so that hot paths can dispatch with isa<>/cast<>/dyn_cast<>
+/// instead of RTTI. The instruction and address kinds are contiguous.
+///
+enum ETacKind {
+  tkInstr=0,                        ///< instruction (CTacInstr)
+  tkLabel,                          ///< label (CTacLabel)
+  tkPhi,                            ///< phi function (CTacPhi)
+  tkConst,                          ///< constant (CTacConst)
+  tkName,                           ///< symbol (CTacName)
+  tkTemp,                           ///< temporary (CTacTemp)
+  tkReference,                      ///< reference (CTacReference)
+};
+
+class CTac;
+class CTacAddr;
+class CTacInstr;
+class CTacPhi;
+class CCodeBlock;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief three-address code arena
+///
+/// bump-pointer allocator that owns the instructions and addresses of a code block. TAC objects
+/// are allocated from the current arena of the calling thread (see SetCurrent()) and register
+/// themselves with it upon construction. Deleting the arena destroys all registered objects and
+/// releases the memory in one go; individual objects are never freed.
+///
+/// Every CCodeBlock owns an arena; CScope makes it current while generating the block's TAC.
+///
+
+class CTacArena {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @param blocksize maximal size of a memory block in bytes
+    CTacArena(size_t blocksize=64*1024);
+
+    /// @brief destructor. Destroys all registered objects and releases the memory.
+    ~CTacArena(void);
+
+    /// @}
+
+    /// @name allocation
+    /// @{
+
+    /// @brief allocate @a size bytes aligned for any TAC object
+    /// @param size number of bytes
+    /// @retval pointer to uninitialized memory owned by the arena
+    void* Allocate(size_t size);
+
+    /// @brief register an object for destruction with the arena
+    /// @param tac constructed object
+    void Register(CTac *tac);
+
+    /// @}
+
+    /// @name statistics
+    /// @{
+
+    /// @brief return the number of registered objects
+    size_t GetNumObjects(void) const { return _numobjs; };
+
+    /// @brief return the number of bytes allocated from the arena
+    size_t GetSize(void) const { return _size; };
+
+    /// @}
+
+    /// @name current arena
+    /// @{
+
+    /// @brief return the current arena of the calling thread (or NULL)
+    static CTacArena* GetCurrent(void) { return _current; };
+
+    /// @brief set the current arena of the calling thread
+    /// @param arena new current arena (or NULL)
+    /// @retval previous current arena
+    static CTacArena* SetCurrent(CTacArena *arena);
+
+    /// @}
+
+  private:
+    /// @brief chunk of registered objects (allocated from the arena itself)
+    struct SObjects {
+      SObjects *prev;               ///< previous (older) chunk
+      size_t   count;               ///< number of used entries
+      CTac     *obj[254];           ///< objects in construction order
+    };
+
+    size_t   _blocksize;            ///< maximal size of a memory block
+    size_t   _next;                 ///< size of the next memory block
+    vector<char*> _blocks;          ///< memory blocks
+    char     *_top;                 ///< next free byte in current block
+    char     *_end;                 ///< end of current block
+    size_t   _size;                 ///< number of bytes allocated
+    SObjects *_objs;                ///< newest chunk of registered objects
+    size_t   _numobjs;              ///< number of registered objects
+
+    static thread_local CTacArena *_current; ///< current arena (per thread)
+};
+
+
 //--------------------------------------------------------------------------------------------------
 /// @brief three-address code base class
 ///
@@ -117,11 +227,33 @@ class CTac {
     /// @name constructors/destructors
     /// @{
 
-    CTac(void);
+    /// @param kind kind of the object
+    CTac(ETacKind kind);
     virtual ~CTac(void);
 
     /// @}
 
+    /// @name properties
+    /// @{
+
+    /// @brief return the kind of the object
+    ETacKind GetKind(void) const { return _kind; };
+
+    /// @}
+
+    /// @name memory management
+    /// @{
+
+    /// @brief allocate a TAC object from the current arena (see CTacArena)
+    ///
+    /// objects created while no arena is current are allocated on the heap and never released.
+    static void* operator new(size_t size);
+
+    /// @brief TAC objects are released by their arena
+    static void operator delete(void *ptr) {};
+
+    /// @}
+
 
     /// @name output
     /// @{
@@ -132,8 +264,54 @@ class CTac {
     virtual ostream& print(ostream &out, int indent=0) const = 0;
 
     /// @}
+
+  protected:
+    ETacKind _kind;                  ///< kind of the object
 };
 
+/// @name CTac type tests and casts
+///
+/// kind-tag based replacements for dynamic_cast. Every TAC class provides a static
+/// classof(const CTac*) that tests the kind.
+///
+/// @{
+
+/// @brief returns true if @a t is non-NULL and an instance of T
+template<class T> inline bool isa(const CTac *t)
+{
+  return (t != NULL) && T::classof(t);
+}
+
+/// @brief cast @a t to T; @a t must be an instance of T
+template<class T> inline T* cast(CTac *t)
+{
+  assert(isa<T>(t));
+  return static_cast<T*>(t);
+}
+
+/// @brief cast @a t to T; @a t must be an instance of T
+template<class T> inline const T* cast(const CTac *t)
+{
+  assert(isa<T>(t));
+  return static_cast<const T*>(t);
+}
+
+/// @brief cast @a t to T if it is an instance of T
+/// @retval T* @a t or NULL if @a t is NULL or not an instance of T
+template<class T> inline T* dyn_cast(CTac *t)
+{
+  return isa<T>(t) ? static_cast<T*>(t) : NULL;
+}
+
+/// @brief cast @a t to T if it is an instance of T
+/// @retval T* @a t or NULL if @a t is NULL or not an instance of T
+template<class T> inline const T* dyn_cast(const CTac *t)
+{
+  return isa<T>(t) ? static_cast<const T*>(t) : NULL;
+}
+
+/// @}
+
 /// @name CTac output operators
 /// @{
 
@@ -154,6 +332,57 @@ ostream& operator<<(ostream &out, const CTac *t);
 /// @}
 
 
+//--------------------------------------------------------------------------------------------------
+/// @brief operand slot
+///
+/// every instruction has three operand slots: the destination (index 0) and two sources (index
+/// 1/2). While the instruction is part of a code block, each slot holding an address is linked
+/// into the def list (destination names and temporaries) or the use list (everything else) of
+/// that address. A slot holding a reference is linked into the use list of its temporary.
+///
+/// Phi functions (CTacPhi) have one source slot per argument; argument i has index i+1.
+///
+
+class CTacUse {
+  public:
+    /// @name properties
+    /// @{
+
+    /// @brief return the instruction owning this slot
+    CTacInstr* GetUser(void) const { return _user; };
+
+    /// @brief return the index of this slot (0 = destination, 1.. = source)
+    int GetIndex(void) const;
+
+    /// @brief return the operand in this slot
+    CTacAddr* Get(void) const;
+
+    /// @brief returns true if this slot is in a def list
+    bool IsDef(void) const;
+
+    /// @brief return the next slot in the same use or def list (or NULL)
+    CTacUse* GetNext(void) const { return _next; };
+
+    /// @}
+
+  private:
+    /// @brief link this slot into the list @a head
+    void Link(CTacUse **head);
+
+    /// @brief unlink this slot from its list
+    void Unlink(void);
+
+    CTacInstr *_user;                ///< instruction owning this slot
+    CTacUse   *_next;                ///< next slot in the list
+    CTacUse   **_pprev;              ///< link pointing to this slot (NULL if unlinked)
+
+    friend class CTacAddr;
+    friend class CTacInstr;
+    friend class CTacPhi;
+    friend class CCodeBlock;
+};
+
+
 //--------------------------------------------------------------------------------------------------
 /// @brief address class
 ///
@@ -166,8 +395,9 @@ class CTacAddr : public CTac {
     /// @{
 
     /// @brief constructor
+    /// @param kind kind of the address
     /// @param type data type
-    CTacAddr(const CType *type);
+    CTacAddr(ETacKind kind, const CType *type);
     virtual ~CTacAddr(void);
 
     /// @}
@@ -179,6 +409,42 @@ class CTacAddr : public CTac {
     /// @brief return the data type of the constant value
     const CType* GetType(void) const;
 
+    /// @brief returns true if @a t is an address
+    static bool classof(const CTac *t) { return t->GetKind() >= tkConst; };
+
+    /// @}
+
+
+    /// @name def-use chains
+    ///
+    /// temporaries and constants are shared by all instructions of a code block, so their lists
+    /// are complete. Names are created per occurrence; their lists only cover that occurrence.
+    ///
+    /// @{
+
+    /// @brief return the first slot using this address (or NULL)
+    ///
+    /// For a name this is at most the single operand the name was created for; other uses of
+    /// the same symbol have their own CTacName and are not reachable from here.
+    CTacUse* GetUses(void) const { return _uses; };
+
+    /// @brief return the first slot defining this address (or NULL)
+    CTacUse* GetDefs(void) const { return _defs; };
+
+    /// @brief return the instruction defining this address if there is exactly one (or NULL)
+    CTacInstr* GetDef(void) const;
+
+    /// @brief replace all uses of this address with @a addr
+    ///
+    /// defs are not changed. References to this temporary are redirected to @a addr if
+    /// @a addr is a temporary and left unchanged otherwise.
+    /// Only temporaries have complete use lists, so this must not be called on names or
+    /// constants.
+    ///
+    /// @param addr replacement
+    /// @retval true if no uses remain, false otherwise
+    bool ReplaceAllUsesWith(CTacAddr *addr);
+
     /// @}
 
 
@@ -194,9 +460,13 @@ class CTacAddr : public CTac {
 
   protected:
     const CType *_type;              ///< data type
+    CTacUse *_uses;                  ///< slots using this address
+    CTacUse *_defs;                  ///< slots defining this address
 
     /// @brief protected constructor used by CTacName
-    CTacAddr(void);
+    CTacAddr(ETacKind kind);
+
+    friend class CTacInstr;
 };
 
 class CTacConst : public CTacAddr {
@@ -218,6 +488,9 @@ class CTacConst : public CTacAddr {
     /// @brief return the constant value
     long long GetValue(void) const;
 
+    /// @brief returns true if @a t is a constant
+    static bool classof(const CTac *t) { return t->GetKind() == tkConst; };
+
     /// @brief return the data type of the constant value
     const CType* GetType(void) const;
 
@@ -256,6 +529,9 @@ class CTacName : public CTacAddr {
     /// @brief return the symbol
     const CSymbol* GetSymbol(void) const;
 
+    /// @brief returns true if @a t is a name
+    static bool classof(const CTac *t) { return t->GetKind() == tkName; };
+
     /// @}
 
 
@@ -273,35 +549,66 @@ class CTacName : public CTacAddr {
     const CSymbol *_symbol;          ///< symbol
 };
 
-class CTacTemp: public CTacName {
+class CTacTemp: public CTacAddr {
   public:
     /// @name constructors/destructors
     /// @{
 
     /// @brief constructor
     ///
-    /// Temp. values must be entered into the symbol table and are then
-    /// accessed using their symbol.
+    /// Temp. values are virtual registers: they are numbered densely per
+    /// scope and are not entered into the symbol table. Use
+    /// CScope::CreateTemp() to obtain a new temporary.
+    ///
+    /// @param id number of the temporary in its scope
+    /// @param type data type
+    CTacTemp(unsigned int id, const CType *type);
+
+    /// @}
+
+
+    /// @name properties
+    /// @{
+
+    /// @brief return the number of the temporary in its scope
+    unsigned int GetId(void) const;
+
+    /// @brief returns true if @a t is a temporary
+    static bool classof(const CTac *t) { return t->GetKind() == tkTemp; };
+
+    /// @}
+
+
+    /// @name output
+    /// @{
+
+    /// @brief print the node to an output stream
+    ///
+    /// temporaries are named 't' followed by their number
     ///
-    /// param symbol temporary value
-    CTacTemp(const CSymbol *symbol);
+    /// @param out output stream
+    /// @param indent indentation
+    virtual ostream& print(ostream &out, int indent=0) const;
 
     /// @}
+
+  protected:
+    unsigned int _id;                ///< number of the temporary
 };
 
-class CTacReference: public CTacName {
+class CTacReference: public CTacAddr {
   public:
     /// @name constructors/destructors
     /// @{
 
     /// @brief constructor
     ///
-    /// other than CTacName/Temp the symbol of a CTacReference is holding a
+    /// other than CTacName/Temp the temporary of a CTacReference is holding a
     /// reference to the storage location
     ///
-    /// param symbol value holding the reference
-    /// param deref  the symbol behind the reference
-    CTacReference(const CSymbol *symbol, const CSymbol *deref);
+    /// @param temp temporary holding the reference
+    /// @param deref the symbol behind the reference
+    CTacReference(CTacTemp *temp, const CSymbol *deref);
 
     /// @}
 
@@ -309,6 +616,12 @@ class CTacReference: public CTacName {
     /// @name properties
     /// @{
 
+    /// @brief return the temporary holding the reference
+    CTacTemp* GetTemp(void) const;
+
+    /// @brief returns true if @a t is a reference
+    static bool classof(const CTac *t) { return t->GetKind() == tkReference; };
+
     /// @brief return the symbol
     const CSymbol* GetDerefSymbol(void) const;
 
@@ -326,7 +639,10 @@ class CTacReference: public CTacName {
     /// @}
 
   protected:
+    CTacTemp *_temp;                 ///< temporary holding the reference
     const CSymbol *_deref;           ///< symbol this reference is pointing to
+
+    friend class CTacAddr;
 };
 
 
@@ -379,6 +695,26 @@ class CTacInstr : public CTac {
     /// @brief return the destination
     CTac* GetDest(void) const;
 
+    /// @brief set source @a index (index = 1/2) to @a src
+    void SetSrc(int index, CTacAddr *src);
+
+    /// @brief set the destination operand to @a dst
+    ///
+    /// the reference counts of branch targets are adjusted.
+    void SetDest(CTac *dst);
+
+    /// @brief return the code block containing this instruction (or NULL)
+    CCodeBlock* GetBlock(void) const { return _block; };
+
+    /// @brief return the previous instruction in the code block (or NULL)
+    CTacInstr* GetPrev(void) const { return _prev; };
+
+    /// @brief return the next instruction in the code block (or NULL)
+    CTacInstr* GetNext(void) const { return _next; };
+
+    /// @brief returns true if @a t is an instruction (including labels and phi functions)
+    static bool classof(const CTac *t) { return t->GetKind() <= tkPhi; };
+
     /// @}
 
     /// @name output
@@ -395,8 +731,20 @@ class CTacInstr : public CTac {
     /// @brief set the instruction @a id (unique per procedure)
     void SetId(int unsigned id);
 
-    /// @brief set the destination operand to @a dst
-    void SetDest(CTac *dst);
+    /// @brief return the number of operand slots (3, or 1 + number of arguments for phis)
+    int GetNumOperands(void) const;
+
+    /// @brief return operand slot @a index
+    CTacUse* GetSlot(int index);
+
+    /// @brief return the address in slot @a index (0 = destination, 1.. = source)
+    CTacAddr* GetOperand(int index) const;
+
+    /// @brief set slot @a index to @a op, keeping the def-use chains up to date
+    void SetOperand(int index, CTac *op);
+
+    /// @brief link slot @a index into the def or use list of its address
+    void LinkOperand(int index);
 
     unsigned int   _id;              ///< unique instruction id
     EOperation     _op;              ///< opcode
@@ -406,6 +754,13 @@ class CTacInstr : public CTac {
     CTacAddr      *_src2;            ///< source operand 2
     CTac          *_dst;             ///< destination operand
 
+    CTacInstr     *_prev;            ///< previous instruction in the code block
+    CTacInstr     *_next;            ///< next instruction in the code block
+    CCodeBlock    *_block;           ///< code block containing this instruction
+    CTacUse        _use[3];          ///< operand slots (destination, source 1, source 2)
+
+    friend class CTacUse;
+    friend class CTacAddr;
     friend class CCodeBlock;
 };
 
@@ -443,6 +798,9 @@ class CTacLabel : public CTacInstr {
     /// @brief read the reference counter
     int GetRefCnt(void) const;
 
+    /// @brief returns true if @a t is a label
+    static bool classof(const CTac *t) { return t->GetKind() == tkLabel; };
+
     /// @}
 
 
@@ -462,12 +820,91 @@ class CTacLabel : public CTacInstr {
 };
 
 
+//--------------------------------------------------------------------------------------------------
+/// @brief phi function class
+///
+/// TAC class for phi functions in static single assignment form (see ssa.h). A phi function
+/// selects argument i if control reaches its basic block from predecessor i. Predecessors are
+/// identified by the label at their start, which the phi function references so that it is not
+/// removed by CleanupControlFlow(); NULL denotes the entry into the code block. Phi functions
+/// follow the labels at the start of a basic block; the source operands of CTacInstr are not
+/// used.
+///
+
+class CTacPhi : public CTacInstr {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor
+    /// @param dst destination operand
+    /// @param nargs number of arguments (predecessors)
+    CTacPhi(CTacAddr *dst, unsigned int nargs);
+
+    /// @brief destructor
+    virtual ~CTacPhi(void);
+
+    /// @}
+
+
+    /// @name properties
+    /// @{
+
+    /// @brief return the number of arguments
+    unsigned int GetNumArgs(void) const;
+
+    /// @brief return argument @a index (0-based)
+    CTacAddr* GetArg(unsigned int index) const;
+
+    /// @brief set argument @a index to @a arg, keeping the def-use chains up to date
+    void SetArg(unsigned int index, CTacAddr *arg);
+
+    /// @brief return the label of the predecessor of argument @a index (NULL for the entry into
+    ///        the code block)
+    CTacLabel* GetPred(unsigned int index) const;
+
+    /// @brief set the predecessor of argument @a index, keeping the label reference counts up to
+    ///        date
+    /// @param index argument index
+    /// @param pred label at the start of the predecessor block or NULL
+    void SetPred(unsigned int index, CTacLabel *pred);
+
+    /// @brief returns true if @a t is a phi function
+    static bool classof(const CTac *t) { return t->GetKind() == tkPhi; };
+
+    /// @}
+
+
+    /// @name output
+    /// @{
+
+    /// @brief print the node to an output stream
+    ///
+    /// arguments are followed by the label of their predecessor or by 'entry'
+    ///
+    /// @param out output stream
+    /// @param indent indentation
+    virtual ostream& print(ostream &out, int indent=0) const;
+
+    /// @}
+
+  protected:
+    vector<CTacAddr*>  _args;         ///< arguments
+    vector<CTacLabel*> _preds;        ///< labels of the predecessor blocks
+    vector<CTacUse>    _argu;         ///< operand slots of the arguments
+
+    friend class CTacInstr;
+    friend class CTacUse;
+};
+
+
 //--------------------------------------------------------------------------------------------------
 /// @brief scope class
 ///
 /// This class represents a scope
 ///
 class CAstNode;
+class CAstFlat;
 class CCodeBlock;
 
 class CScope {
@@ -478,7 +915,17 @@ class CScope {
     /// @brief constructor
     /// @param ast abstract syntax tree for this scope
     /// @param parent superordinate scope, or NULL if none
-    CScope(CAstNode *ast, CScope *parent=NULL);
+    /// @param flat flattened AST of the module to generate TAC from, or NULL
+    /// @param lower generate the TAC of @a ast and its subscopes. If false, the code block is
+    ///        left empty for the caller to fill and the scope is appended to the subscopes of
+    ///        @a parent (single-pass compilation, see CParser::Compile()).
+    CScope(CAstNode *ast, CScope *parent=NULL, const CAstFlat *flat=NULL, bool lower=true);
+
+    /// @brief constructor for a scope without an AST (see CTacParser)
+    /// @param name name of the scope
+    /// @param symtab symbol table; owned by the scope
+    /// @param parent superordinate scope, or NULL if none. The scope is appended to its subscopes.
+    CScope(const string name, CSymtab *symtab, CScope *parent=NULL);
 
     /// @brief destructor
     virtual ~CScope(void);
@@ -523,9 +970,10 @@ class CScope {
 
     /// @brief create a new (unique) temporary
     /// @param type type of the temporary
-    /// @param name (optional) given name of temporary
-    /// @param store (optional) given storage location
-    CTacTemp* CreateTemp(const CType *type, string name="", CStorage *store=NULL);
+    CTacTemp* CreateTemp(const CType *type);
+
+    /// @brief return the temporaries of this scope, indexed by their number
+    const vector<CTacTemp*>& GetTemps(void) const;
 
     /// @brief create a new (unique) label
     /// @param hint optional descriptive string
@@ -558,6 +1006,11 @@ class CScope {
     /// @}
 
   protected:
+    /// @brief print the temporaries of this scope to an output stream
+    /// @param out output stream
+    /// @param indent indentation
+    void printTemps(ostream &out, int indent=0) const;
+
     CAstNode *_ast;                  ///< abstract syntax tree
     string _name;                    ///< name
     CSymtab *_symtab;                ///< symbol table
@@ -565,8 +1018,10 @@ class CScope {
     vector<CScope*> _children;       ///< list of functions
     CCodeBlock* _cb;                 ///< list of code blocks
 
-    unsigned int _temp_id;           ///< next id for temporaries
+    vector<CTacTemp*> _temps;        ///< temporaries (owned by the code block)
     unsigned int _label_id;          ///< next id for labels
+
+    friend class CTacParser;
 };
 
 /// @name CScope output operators
@@ -603,7 +1058,14 @@ class CModule : public CScope {
 
     /// @brief constructor
     /// @param ast abstract syntax tree (must be a CAstModule instance)
-    CModule(CAstNode *ast);
+    /// @param flat flattened AST of @a ast to generate TAC from, or NULL
+    /// @param lower generate the TAC of @a ast (see CScope::CScope())
+    CModule(CAstNode *ast, const CAstFlat *flat=NULL, bool lower=true);
+
+    /// @brief constructor for a module without an AST (see CScope::CScope())
+    /// @param name name of the module
+    /// @param symtab global symbol table; owned by the module
+    CModule(const string name, CSymtab *symtab);
 
     /// @brief destructor
     virtual ~CModule(void);
@@ -644,7 +1106,16 @@ class CProcedure : public CScope {
 
     /// @brief constructor
     /// @param ast abstract syntax tree (must be a CAstProcedure instance)
-    CProcedure(CAstNode *ast, CScope *parent);
+    /// @param parent superordinate scope
+    /// @param flat flattened AST of the module to generate TAC from, or NULL
+    /// @param lower generate the TAC of @a ast (see CScope::CScope())
+    CProcedure(CAstNode *ast, CScope *parent, const CAstFlat *flat=NULL, bool lower=true);
+
+    /// @brief constructor for a procedure without an AST (see CScope::CScope())
+    /// @param decl symbol of the procedure's declaration
+    /// @param parent superordinate scope
+    /// @param symtab local symbol table; owned by the procedure
+    CProcedure(CSymProc *decl, CScope *parent, CSymtab *symtab);
 
     /// @brief destructor
     virtual ~CProcedure(void);
@@ -669,6 +1140,9 @@ class CProcedure : public CScope {
     virtual ostream&  print(ostream &out, int indent=0) const;
 
     /// @}
+
+  private:
+    CSymProc *_decl;                 ///< declaration (scopes without an AST only)
 };
 
 
@@ -712,6 +1186,15 @@ class CCodeBlock {
     /// @param type type of the temporary
     CTacTemp* CreateTemp(const CType *type);
 
+    /// @brief return the constant (@a value, @a type)
+    ///
+    /// Constants are pooled per code block: every call with the same value and type returns the
+    /// same, immutable instance, so constants can be compared by pointer.
+    ///
+    /// @param value constant value
+    /// @param type data type
+    CTacConst* CreateConst(long long value, const CType *type);
+
     /// @brief create a new (unique) label
     /// @param hint optional descriptive string
     CTacLabel* CreateLabel(const char *hint=NULL);
@@ -719,6 +1202,15 @@ class CCodeBlock {
     /// @}
 
 
+    /// @name memory management
+    /// @{
+
+    /// @brief return the arena owning the instructions and addresses of this block
+    CTacArena* GetArena(void);
+
+    /// @}
+
+
     /// @name instruction management
     /// @{
 
@@ -726,12 +1218,41 @@ class CCodeBlock {
     /// @retval CTacInstr* inserted instruction
     CTacInstr* AddInstr(CTacInstr *instr);
 
-    /// @brief return (a reference to) the list of instructions
-    const list<CTacInstr*>& GetInstr(void) const;
+    /// @brief insert @a instr before @a pos
+    ///
+    /// the operands of @a instr are linked into the def-use chains of their addresses.
+    ///
+    /// @param pos instruction of this block, or NULL to append
+    /// @param instr instruction to insert (not part of any block)
+    /// @retval CTacInstr* inserted instruction
+    CTacInstr* InsertInstr(CTacInstr *pos, CTacInstr *instr);
+
+    /// @brief unlink @a instr from the list of instructions
+    ///
+    /// the instruction remains owned by the block's arena and its operands are unlinked from the
+    /// def-use chains. The reference count of a branch target is not changed.
+    ///
+    /// @retval CTacInstr* instruction following @a instr (or NULL)
+    CTacInstr* RemoveInstr(CTacInstr *instr);
+
+    /// @brief return the first instruction (or NULL)
+    ///
+    /// the instructions form an intrusive doubly-linked list; iterate with
+    /// CTacInstr::GetNext().
+    CTacInstr* GetFirst(void) const { return _first; };
+
+    /// @brief return the last instruction (or NULL)
+    CTacInstr* GetLast(void) const { return _last; };
+
+    /// @brief return the number of instructions
+    size_t GetNumInstr(void) const { return _ninstr; };
 
     /// @brief remove unused/superfluous labels and goto instructions
     void CleanupControlFlow(void);
 
+    /// @brief number the instructions consecutively in list order
+    void Renumber(void);
+
     /// @}
 
 
@@ -759,9 +1280,25 @@ class CCodeBlock {
     /// @}
 
   protected:
+    /// @brief key of the constant pool (type, value)
+    typedef pair<const CType*, long long> ConstKey;
+
+    /// @brief hash function of the constant pool
+    struct ConstKeyHash {
+      size_t operator()(const ConstKey &k) const
+      {
+        return hash<long long>()(k.second) * 31 + hash<const CType*>()(k.first);
+      }
+    };
+
+    CTacArena _arena;                ///< arena owning instructions and addresses
     CScope *_owner;                  ///< block owner
-    list<CTacInstr*> _ops;           ///< operation list
+    CTacInstr *_first;               ///< first instruction
+    CTacInstr *_last;                ///< last instruction
+    size_t _ninstr;                  ///< number of instructions
     unsigned int _inst_id;           ///< next id for instructions
+    /// constant pool
+    unordered_map<ConstKey, CTacConst*, ConstKeyHash> _consts;
 };
 
 /// @name CCodeBlock output operators
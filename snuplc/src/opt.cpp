@@ -0,0 +1,422 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL scalar optimizations
+///
+/// constant folding, copy propagation and dead code elimination on TAC
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <cassert>
+#include <climits>
+#include <vector>
+
+#include "opt.h"
+#include "cfg.h"
+#include "dataflow.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// constant folding
+//
+
+/// @brief returns true if constants of type @a t are folded
+static bool IsFoldable(const CType *t)
+{
+  return (t != NULL) && (t->IsInt() || t->IsBoolean());
+}
+
+/// @brief wrap @a v to the values of type @a t
+static long long Wrap(unsigned long long v, const CType *t)
+{
+  if (t->IsBoolean()) return v != 0;
+  if (t->IsInteger()) return (int)v;
+  return (long long)v;
+}
+
+/// @brief evaluate @a op on @a a and @a b of type @a t
+/// @param result result of the operation (the outcome for relational operations)
+/// @retval true if the operation can be evaluated at compile time
+static bool Evaluate(EOperation op, long long a, long long b, const CType *t, long long &result)
+{
+  unsigned long long ua = a, ub = b;
+  long long min = t->IsInteger() ? INT_MIN : LLONG_MIN;
+
+  switch (op) {
+    case opAdd:         result = Wrap(ua + ub, t); break;
+    case opSub:         result = Wrap(ua - ub, t); break;
+    case opMul:         result = Wrap(ua * ub, t); break;
+    case opDiv:
+      if ((b == 0) || ((a == min) && (b == -1))) return false;
+      result = Wrap(a / b, t);
+      break;
+    case opAnd:         result = a && b; break;
+    case opOr:          result = a || b; break;
+    case opNeg:         result = Wrap(0 - ua, t); break;
+    case opPos:         result = a; break;
+    case opNot:         result = !a; break;
+    case opEqual:       result = a == b; break;
+    case opNotEqual:    result = a != b; break;
+    case opLessThan:    result = a < b; break;
+    case opLessEqual:   result = a <= b; break;
+    case opBiggerThan:  result = a > b; break;
+    case opBiggerEqual: result = a >= b; break;
+    default:            return false;
+  }
+
+  // logical operations are defined on booleans, arithmetic operations on integers
+  bool logical = (op == opAnd) || (op == opOr) || (op == opNot);
+  return IsRelOp(op) || (logical == t->IsBoolean());
+}
+
+/// @brief returns true if @a a is the constant @a v of an integer type
+static bool IsIntConst(const CTacAddr *a, long long v)
+{
+  const CTacConst *c = dyn_cast<CTacConst>(a);
+  return (c != NULL) && c->GetType()->IsInt() && (c->GetValue() == v);
+}
+
+/// @brief return the source that an identity reduces @a i to (or NULL)
+static CTacAddr* Simplify(CTacInstr *i)
+{
+  CTacAddr *a = i->GetSrc(1), *b = i->GetSrc(2);
+
+  switch (i->GetOperation()) {
+    case opAdd:
+      if (IsIntConst(b, 0)) return a;
+      if (IsIntConst(a, 0)) return b;
+      break;
+    case opSub:
+      if (IsIntConst(b, 0)) return a;
+      break;
+    case opMul:
+      if (IsIntConst(b, 1) || IsIntConst(a, 0)) return a;
+      if (IsIntConst(a, 1) || IsIntConst(b, 0)) return b;
+      break;
+    case opDiv:
+      if (IsIntConst(b, 1)) return a;
+      break;
+    default:
+      break;
+  }
+
+  return NULL;
+}
+
+/// @brief replace the uses of the temporary that @a i assigns a constant to by the constant
+/// @retval true if @a i has been removed
+static bool PropagateConstant(CCodeBlock *cb, CTacInstr *i)
+{
+  CTacTemp *dst = dyn_cast<CTacTemp>(i->GetDest());
+  CTacConst *src = dyn_cast<CTacConst>(i->GetSrc(1));
+
+  if ((i->GetOperation() != opAssign) || (dst == NULL) || (src == NULL)) return false;
+  if ((dst->GetDef() != i) || !dst->ReplaceAllUsesWith(src)) return false;
+
+  cb->RemoveInstr(i);
+  return true;
+}
+
+bool FoldConstants(CCodeBlock *cb)
+{
+  assert(cb != NULL);
+
+  // new instructions are owned by the code block
+  CTacArena *prev = CTacArena::SetCurrent(cb->GetArena());
+  bool changed = false;
+
+  CTacInstr *i = cb->GetFirst();
+  while (i != NULL) {
+    CTacInstr *next = i->GetNext();
+    EOperation op = i->GetOperation();
+    CTacConst *a = dyn_cast<CTacConst>(i->GetSrc(1));
+    CTacConst *b = dyn_cast<CTacConst>(i->GetSrc(2));
+    long long result;
+
+    bool foldable = (a != NULL) && IsFoldable(a->GetType()) && ((b != NULL) || (i->GetNumSrc() == 1));
+
+    if (foldable && Evaluate(op, a->GetValue(), b != NULL ? b->GetValue() : 0, a->GetType(), result)) {
+      if (i->IsBranch()) {
+        // the branch is taken always or never; the target label loses this reference
+        CTacLabel *target = cast<CTacLabel>(i->GetDest());
+        if (result) cb->InsertInstr(i, new CTacInstr(opGoto, target));
+        target->AddReference(-1);
+        cb->RemoveInstr(i);
+      } else {
+        // relational operations on integers yield booleans
+        const CType *t = IsRelOp(op) ? CTypeManager::Get()->GetBool() : a->GetType();
+        CTacConst *c = cb->CreateConst(result, t);
+        CTacInstr *assign = cb->InsertInstr(i, new CTacInstr(opAssign, i->GetDest(), c));
+        cb->RemoveInstr(i);
+        PropagateConstant(cb, assign);
+      }
+      changed = true;
+
+    } else if (!i->IsBranch() && (i->GetDest() != NULL)) {
+      CTacAddr *src = Simplify(i);
+      if (src != NULL) {
+        CTacInstr *assign = cb->InsertInstr(i, new CTacInstr(opAssign, i->GetDest(), src));
+        cb->RemoveInstr(i);
+        PropagateConstant(cb, assign);
+        changed = true;
+      } else if (PropagateConstant(cb, i)) {
+        changed = true;
+      }
+    }
+
+    i = next;
+  }
+
+  CTacArena::SetCurrent(prev);
+
+  return changed;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// copy propagation
+//
+
+bool PropagateCopies(CCodeBlock *cb)
+{
+  assert(cb != NULL);
+
+  bool changed = false;
+
+  CTacInstr *i = cb->GetFirst();
+  while (i != NULL) {
+    CTacInstr *next = i->GetNext();
+
+    if (i->GetOperation() == opAssign) {
+      CTacTemp *dst = dyn_cast<CTacTemp>(i->GetDest());
+      CTacAddr *src = i->GetSrc(1);
+
+      bool copy = (dst != NULL) && (dst->GetDef() == i) && (src != dst) &&
+                  (isa<CTacConst>(src) || (isa<CTacTemp>(src) && (src->GetDef() != NULL)));
+
+      // references to the temporary cannot be replaced by a constant; keep the assignment then
+      if (copy && dst->ReplaceAllUsesWith(src)) {
+        cb->RemoveInstr(i);
+        changed = true;
+      }
+    }
+
+    i = next;
+  }
+
+  return changed;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// dead code elimination
+//
+
+/// @brief returns true if @a i only computes the value of its destination
+static bool IsPure(const CTacInstr *i)
+{
+  switch (i->GetOperation()) {
+    case opAdd: case opSub: case opMul: case opAnd: case opOr:
+    case opNeg: case opPos: case opNot:
+    case opAssign: case opAddress: case opCast: case opWiden: case opNarrow:
+    case opPhi:
+      return true;
+
+    case opDiv: {
+      // division by zero traps
+      const CTacConst *c = dyn_cast<CTacConst>(i->GetSrc(2));
+      return (c != NULL) && (c->GetValue() != 0);
+    }
+
+    default:
+      return false;
+  }
+}
+
+/// @brief returns true if @a i only computes the value of a temporary
+static bool IsRemovable(const CTacInstr *i)
+{
+  return isa<CTacTemp>(i->GetDest()) && IsPure(i);
+}
+
+/// @brief remove @a i from @a cb and release the labels it references
+static void Remove(CCodeBlock *cb, CTacInstr *i)
+{
+  // phi functions hold a reference to the labels of their predecessors
+  CTacPhi *phi = dyn_cast<CTacPhi>(i);
+  if (phi != NULL) {
+    for (unsigned int a=0; a<phi->GetNumArgs(); a++) phi->SetPred(a, NULL);
+  }
+  if (i->IsBranch()) cast<CTacLabel>(i->GetDest())->AddReference(-1);
+
+  cb->RemoveInstr(i);
+}
+
+/// @brief remove the instructions following unconditional jumps and returns up to the next
+///        referenced label
+/// @retval true if @a cb was changed
+static bool RemoveUnreachable(CCodeBlock *cb)
+{
+  bool changed = false, reachable = true;
+
+  CTacInstr *i = cb->GetFirst();
+  while (i != NULL) {
+    CTacInstr *next = i->GetNext();
+    CTacLabel *lbl = dyn_cast<CTacLabel>(i);
+
+    if ((lbl != NULL) && (lbl->GetRefCnt() > 0)) {
+      reachable = true;
+    } else if (!reachable) {
+      Remove(cb, i);
+      changed = true;
+    } else {
+      EOperation op = i->GetOperation();
+      reachable = (op != opGoto) && (op != opReturn);
+    }
+
+    i = next;
+  }
+
+  return changed;
+}
+
+/// @brief mark the definitions of the temporary read through @a a live
+static void MarkDefs(const CTacAddr *a, vector<bool> &live, vector<CTacInstr*> &work)
+{
+  const CTacTemp *t = dyn_cast<CTacTemp>(a);
+  if (isa<CTacReference>(a)) t = cast<CTacReference>(a)->GetTemp();
+  if (t == NULL) return;
+
+  for (CTacUse *u = t->GetDefs(); u != NULL; u = u->GetNext()) {
+    CTacInstr *d = u->GetUser();
+    if (!live[d->GetId()]) {
+      live[d->GetId()] = true;
+      work.push_back(d);
+    }
+  }
+}
+
+bool EliminateDeadCode(CCodeBlock *cb)
+{
+  assert(cb != NULL);
+
+  bool changed = RemoveUnreachable(cb);
+  cb->Renumber();
+
+  // mark: instructions with side effects and, transitively, the definitions they read
+  vector<bool> live(cb->GetNumInstr(), false);
+  vector<CTacInstr*> work;
+
+  for (CTacInstr *i = cb->GetFirst(); i != NULL; i = i->GetNext()) {
+    if (!IsRemovable(i)) {
+      live[i->GetId()] = true;
+      work.push_back(i);
+    }
+  }
+
+  while (!work.empty()) {
+    CTacInstr *i = work.back();
+    work.pop_back();
+
+    MarkDefs(i->GetSrc(1), live, work);
+    MarkDefs(i->GetSrc(2), live, work);
+    if (isa<CTacReference>(i->GetDest())) MarkDefs(cast<CTacAddr>(i->GetDest()), live, work);
+
+    CTacPhi *phi = dyn_cast<CTacPhi>(i);
+    if (phi != NULL) {
+      for (unsigned int a=0; a<phi->GetNumArgs(); a++) MarkDefs(phi->GetArg(a), live, work);
+    }
+  }
+
+  // sweep
+  CTacInstr *i = cb->GetFirst();
+  while (i != NULL) {
+    CTacInstr *next = i->GetNext();
+
+    if (!live[i->GetId()]) {
+      Remove(cb, i);
+      changed = true;
+    }
+
+    i = next;
+  }
+
+  return changed;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// dead store elimination
+//
+
+bool EliminateDeadStores(CCodeBlock *cb)
+{
+  assert(cb != NULL);
+
+  CCfg cfg(cb);
+  CLiveness live(&cfg);
+  const CVariables &vars = live.GetVariables();
+  bool changed = false;
+
+  // variables local to blocks are not live at the exit of any block
+  CBitSet local(vars.GetSize());
+  vector<int> uses, touched;
+
+  // walk each block backwards from the variables live at its exit
+  const vector<CBasicBlock*> &blocks = cfg.GetRPO();
+  for (size_t b=0; b<blocks.size(); b++) {
+    CBitSet s(live.GetOut(blocks[b]));
+    CTacInstr *first = blocks[b]->GetFirst();
+    CTacInstr *i = blocks[b]->GetLast();
+
+    while (i != NULL) {
+      CTacInstr *prev = i != first ? i->GetPrev() : NULL;
+      int v = vars.GetDef(i);
+      int f = v >= 0 ? live.GetFact(v) : -1;
+
+      if ((v >= 0) && !(f >= 0 ? s.Test(f) : local.Test(v)) && IsPure(i)) {
+        Remove(cb, i);
+        changed = true;
+      } else {
+        live.Transfer(i, s);
+
+        if ((v >= 0) && (f < 0)) local.Reset(v);
+        uses.clear();
+        vars.GetUses(i, uses);
+        for (size_t u=0; u<uses.size(); u++) {
+          if (live.GetFact(uses[u]) >= 0) continue;
+          local.Set(uses[u]);
+          touched.push_back(uses[u]);
+        }
+      }
+
+      i = prev;
+    }
+
+    for (size_t t=0; t<touched.size(); t++) local.Reset(touched[t]);
+    touched.clear();
+  }
+
+  return changed;
+}
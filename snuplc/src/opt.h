@@ -0,0 +1,94 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL scalar optimizations
+///
+/// constant folding, copy propagation and dead code elimination on TAC
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_OPT_H__
+#define __SnuPL_OPT_H__
+
+#include "ir.h"
+using namespace std;
+
+
+/// @name scalar optimizations
+///
+/// transformations of a single code block. They keep the def-use chains and the label reference
+/// counts up to date and may run on code in SSA form (see ssa.h). Each returns true if it
+/// changed the code block.
+///
+/// @{
+
+/// @brief fold operations on constants
+///
+/// arithmetic and logical operations on constants are replaced by an assignment of the result,
+/// wrapped to the size of the operand type. So are the identities x+0, 0+x, x-0, x*1, 1*x, x/1
+/// and x*0, 0*x. Conditional branches on constants become unconditional branches or are removed.
+/// Divisions by zero and operations on types other than integer, longint and boolean are not
+/// folded. Constants assigned to temporaries with a single definition replace the uses of the
+/// temporary, so a single pass in instruction order folds chains of constant expressions.
+///
+/// @param cb code block
+/// @retval true if @a cb was changed
+bool FoldConstants(CCodeBlock *cb);
+
+/// @brief propagate copies
+///
+/// the uses of a temporary defined only by an assignment of a constant or of a temporary with a
+/// single definition are replaced by the source of the assignment, which is then removed.
+/// Temporaries with a single definition are not redefined before their uses in the code the
+/// TAC generator emits and in SSA form, so no other condition is checked.
+///
+/// @param cb code block
+/// @retval true if @a cb was changed
+bool PropagateCopies(CCodeBlock *cb);
+
+/// @brief remove dead code
+///
+/// instructions without side effects that define a temporary are removed unless their result
+/// is used, directly or through other such instructions, by an instruction with side effects
+/// (stores, branches, calls, parameters, returns). Dead cycles of phi functions are removed as
+/// well, and so are instructions that follow an unconditional jump or a return and are not
+/// preceded by a referenced label.
+///
+/// @param cb code block
+/// @retval true if @a cb was changed
+bool EliminateDeadCode(CCodeBlock *cb);
+
+/// @brief remove dead stores
+///
+/// instructions without side effects that define a temporary or a local scalar variable that
+/// is not live after the instruction (see CLiveness) are removed. Unlike EliminateDeadCode(),
+/// this also removes stores to local variables that are overwritten or never read again.
+/// Unreachable basic blocks are left unchanged.
+///
+/// @param cb code block
+/// @retval true if @a cb was changed
+bool EliminateDeadStores(CCodeBlock *cb);
+
+/// @}
+
+#endif // __SnuPL_OPT_H__
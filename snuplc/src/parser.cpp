@@ -41,6 +41,8 @@
 #include <vector>
 #include <iostream>
 #include <exception>
+#include <atomic>
+#include <thread>
 
 #include "parser.h"
 using namespace std;
@@ -52,11 +54,100 @@ CParser::CParser(CScanner* scanner)
 {
 	_scanner = scanner;
 	_module = NULL;
+	_abort = false;
+	_semantic = false;
+	_threads = 1;
+	_defer = false;
+	_tac = NULL;
+	_scratch = NULL;
+	_dim = NULL;
+	_dofs = NULL;
 }
 
 CAstNode* CParser::Parse(void)
 {
 	_abort = false;
+	_semantic = false;
+	_operands.clear();
+	_ops.clear();
+	_jobs.clear();
+
+	if (_module != NULL)
+	{
+		delete _module;
+		_module = NULL;
+	}
+
+	// deferring subroutine bodies requires random access to the token stream
+	_defer = (_threads > 1) && (_scanner != NULL) && _scanner->Prescan();
+	size_t start = _defer ? _scanner->GetTokenIndex() : 0;
+
+	// string constants are entered into the module's symbol table as "_str_N" while the bodies
+	// are parsed. Modules that refer to these names depend on the parsing order; parse serially.
+	for (size_t i = start, n = _defer ? _scanner->GetTokenCount() : 0; _defer && (i < n); i++)
+	{
+		const CToken& t = _scanner->GetToken(i);
+		if ((t.GetType() == tIdent) && (t.GetValue().compare(0, 5, "_str_") == 0)) _defer = false;
+	}
+	int strings = CAstStringConstant::GetIndex();
+
+	// module() makes the new module's arena current and sets _module as soon as it exists
+	CAstArena *arena = CAstArena::SetCurrent(NULL);
+
+	try
+	{
+		if (_scanner != NULL) _module = module();
+	}
+	catch (...)
+	{
+		// the error has been recorded by SetError()
+	}
+
+	if (_defer)
+	{
+		_defer = false;
+
+		if (!ParseBodies())
+		{
+			delete _module;
+			_module = NULL;
+			_abort = false;
+			_scanner->SetTokenIndex(start);
+			CAstStringConstant::SetIndex(strings);
+			CAstArena::SetCurrent(NULL);
+
+			try
+			{
+				_module = module();
+			}
+			catch (...)
+			{
+			}
+		}
+	}
+
+	// release the AST of an erroneous module in one go
+	if (_abort)
+	{
+		delete _module;
+		_module = NULL;
+	}
+
+	CAstArena::SetCurrent(arena);
+
+	return _module;
+}
+
+CAstNode* CParser::Compile(CModule **tac)
+{
+	assert(tac != NULL);
+
+	_abort = false;
+	_semantic = false;
+	_operands.clear();
+	_ops.clear();
+	_jobs.clear();
+	_defer = false;
 
 	if (_module != NULL)
 	{
@@ -64,18 +155,75 @@ CAstNode* CParser::Parse(void)
 		_module = NULL;
 	}
 
+	// statements are parsed into the scratch arena and released once they are lowered; module()
+	// creates the TAC of the module along with the AST node
+	CAstArena scratch;
+	_scratch = &scratch;
+	CAstArena *arena = CAstArena::SetCurrent(NULL);
+
 	try
 	{
 		if (_scanner != NULL) _module = module();
 	}
 	catch (...)
 	{
+		// the error has been recorded by SetError()
+	}
+
+	if (_abort)
+	{
+		delete _tac;
+		_tac = NULL;
+		delete _module;
 		_module = NULL;
 	}
 
+	CAstArena::SetCurrent(arena);
+
+	*tac = _tac;
+	_tac = NULL;
+	_scratch = NULL;
+
 	return _module;
 }
 
+void CParser::CompileStatement(CAstScope *s, CAstStatement *st, CCodeBlock *cb)
+{
+	CToken t;
+	string msg;
+	bool ok;
+
+	try
+	{
+		ok = st->TypeCheck(&t, &msg);
+	}
+	catch (...)
+	{
+		ok = false;
+	}
+
+	if (!ok)
+	{
+		_semantic = true;
+		SetError(t, msg);
+	}
+
+	// same lowering as CAstScope::ToTac()
+	CTacArena *prev = CTacArena::SetCurrent(cb->GetArena());
+	CTacLabel *next = cb->CreateLabel();
+	st->ToTac(cb, next);
+	cb->AddInstr(next);
+	CTacArena::SetCurrent(prev);
+
+	_scratch->Reset();
+}
+
+CAstFlat* CParser::Flatten(void) const
+{
+	if (_abort || (_module == NULL)) return NULL;
+	return new CAstFlat(_module);
+}
+
 const CToken* CParser::GetErrorToken(void) const
 {
 	if (_abort) return &_error_token;
@@ -113,6 +261,160 @@ bool CParser::Consume(EToken type, CToken* token)
 	return t.GetType() == type;
 }
 
+//--------------------------------------------------------------------------------------------------
+// parallel parsing of subroutine bodies
+//
+// The module is parsed serially with all declarations, subroutine headers and the module body.
+// Subroutine bodies are skipped by a pre-scan of the token stream that matches "begin", "if" and
+// "while" with their "end". The deferred bodies are parsed afterwards on worker threads, each with
+// its own parser and a fork of the scanner. Every body sees the global declarations preceding it
+// (CSymtab::SetParentLimit()) and numbers its string constants as the serial parser would. The
+// first error in source order is reported. If a body is not consumed exactly as found by the
+// pre-scan, the module is parsed again serially.
+//
+bool CParser::DeferBody(CAstProcedure* s)
+{
+	size_t begin = _scanner->GetTokenIndex();
+	size_t n = _scanner->GetTokenCount();
+	int depth = 0, strings = 0;
+
+	for (size_t i = begin; i < n; i++)
+	{
+		switch (_scanner->GetToken(i).GetType())
+		{
+		case tBegin:
+		case tIf:
+		case tWhile:
+			depth++;
+			break;
+
+		case tEnd:
+			if (--depth < 0) return false;
+			if (depth == 0)
+			{
+				SParseJob j;
+				j.scope = s;
+				j.begin = begin;
+				j.end = i + 1;
+				j.strbase = CAstStringConstant::GetIndex();
+				j.strings = strings;
+				j.done = j.error = false;
+				_jobs.push_back(j);
+
+				CAstStringConstant::SetIndex(j.strbase + strings);
+				_scanner->SetTokenIndex(j.end);
+				return true;
+			}
+			break;
+
+		case tStringConst:
+			strings++;
+			break;
+
+		case tModule:
+		case tProcedure:
+		case tFunction:
+		case tEOF:
+		case tIOError:
+			return false;
+
+		default:
+			break;
+		}
+	}
+
+	return false;
+}
+
+bool CParser::ParseBodies(void)
+{
+	if (_jobs.empty()) return true;
+
+	CSymtab* global = _jobs[0].scope->GetSymbolTable()->GetParent();
+	int strings = CAstStringConstant::GetIndex();
+
+	CInterner::Get()->SetConcurrent(true);
+	CTypeManager::Get()->SetConcurrent(true);
+	global->SetConcurrent(true);
+	for (size_t i = 0; i < _jobs.size(); i++) _jobs[i].scope->GetSymbolTable()->SetParentLimit(true);
+
+	// every worker builds its nodes in an arena of its own
+	vector<CAstArena*> arenas;
+	for (size_t i = 0; (i < _threads) && (i < _jobs.size()); i++) arenas.push_back(new CAstArena());
+
+	atomic<size_t> next(0);
+	auto ParseJobs = [this, &next](CAstArena* arena) {
+		CAstArena* prev = CAstArena::SetCurrent(arena);
+		CScanner* scanner = _scanner->Fork(_jobs[0].begin);
+		CParser parser(scanner);
+		parser._dim = _dim;
+		parser._dofs = _dofs;
+
+		size_t i;
+		while ((i = next++) < _jobs.size())
+		{
+			SParseJob& j = _jobs[i];
+
+			scanner->SetTokenIndex(j.begin);
+			CAstStringConstant::SetIndex(j.strbase);
+			parser._abort = false;
+			parser._operands.clear();
+			parser._ops.clear();
+
+			try
+			{
+				parser.subroutineBody(j.scope);
+			}
+			catch (...)
+			{
+			}
+
+			j.error = parser._abort;
+			j.error_token = parser._error_token;
+			j.message = parser._message;
+			j.done = !j.error && (scanner->GetTokenIndex() == j.end) &&
+				(CAstStringConstant::GetIndex() == j.strbase + j.strings);
+		}
+
+		delete scanner;
+		CAstArena::SetCurrent(prev);
+	};
+
+	vector<thread> workers;
+	for (size_t i = 1; i < arenas.size(); i++) workers.push_back(thread(ParseJobs, arenas[i]));
+	ParseJobs(arenas[0]);
+	for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+
+	for (size_t i = 0; i < arenas.size(); i++)
+	{
+		_module->GetArena()->Merge(arenas[i]);
+		delete arenas[i];
+	}
+
+	for (size_t i = 0; i < _jobs.size(); i++) _jobs[i].scope->GetSymbolTable()->SetParentLimit(false);
+	global->SetConcurrent(false);
+	CTypeManager::Get()->SetConcurrent(false);
+	CInterner::Get()->SetConcurrent(false);
+	CAstStringConstant::SetIndex(strings);
+
+	// report the first error in source order. Errors in bodies precede errors found by the
+	// serial pass, since the serial pass continues after a deferred body
+	for (size_t i = 0; i < _jobs.size(); i++)
+	{
+		const SParseJob& j = _jobs[i];
+		if (j.error)
+		{
+			_error_token = j.error_token;
+			_message = j.message;
+			_abort = true;
+			return true;
+		}
+		if (!j.done) return false;
+	}
+
+	return true;
+}
+
 void CParser::InitSymbolTable(CSymtab* st)
 {
 	CTypeManager* tm = CTypeManager::Get();
@@ -146,6 +448,19 @@ void CParser::InitSymbolTable(CSymtab* st)
 	f = new CSymProc("WriteLn", tm->GetNull(), true);
 	st->AddSymbol(f);
 
+	// return the number of elements in dimension ‘dim’ of array ‘array’.
+	f = new CSymProc("DIM", tm->GetInteger(), true);
+	f->AddParam(new CSymParam(0, "array", tm->GetVoidPtr()));
+	f->AddParam(new CSymParam(1, "dim", tm->GetInteger()));
+	st->AddSymbol(f);
+	_dim = f;
+
+	// return the offset of the data of array ‘array’ from its start.
+	f = new CSymProc("DOFS", tm->GetInteger(), true);
+	f->AddParam(new CSymParam(0, "array", tm->GetVoidPtr()));
+	st->AddSymbol(f);
+	_dofs = f;
+
 }
 
 CAstModule* CParser::module()
@@ -169,9 +484,13 @@ CAstModule* CParser::module()
 	Consume(tSemicolon);
 
 	m = new CAstModule(mt, id);
+	_module = m;
+	CAstArena::SetCurrent(m->GetArena());
 
 	InitSymbolTable(m->GetSymbolTable());
 
+	if (_scratch != NULL) _tac = new CModule(m, NULL, false);
+
 	EToken tt = _scanner->Peek().GetType();
 	while ((tt == tConstDecl) || (tt == tVarDecl) || (tt == tProcedure) || (tt == tFunction))
 	{
@@ -186,6 +505,7 @@ CAstModule* CParser::module()
 		case tProcedure:
 		{
 			CAstProcedure* sub = procedureDecl(m);
+			CScope* proc = _tac != NULL ? new CProcedure(sub, _tac, NULL, false) : NULL;
 			if (_scanner->Peek().GetValue() == "Extern")
 			{
 				Consume(tIdent);
@@ -193,7 +513,8 @@ CAstModule* CParser::module()
 			}
 			else
 			{
-				subroutineBody(sub);
+				if (proc != NULL) subroutineBody(sub, proc->GetCodeBlock());
+				else if (!_defer || !DeferBody(sub)) subroutineBody(sub);
 				Consume(tIdent);
 				Consume(tSemicolon);
 			}
@@ -202,6 +523,7 @@ CAstModule* CParser::module()
 		case tFunction:
 		{
 			CAstProcedure* sub = functionDecl(m);
+			CScope* proc = _tac != NULL ? new CProcedure(sub, _tac, NULL, false) : NULL;
 			if (_scanner->Peek().GetValue() == "Extern")
 			{
 				Consume(tIdent);
@@ -209,7 +531,8 @@ CAstModule* CParser::module()
 			}
 			else
 			{
-				subroutineBody(sub);
+				if (proc != NULL) subroutineBody(sub, proc->GetCodeBlock());
+				else if (!_defer || !DeferBody(sub)) subroutineBody(sub);
 				Consume(tIdent);
 				Consume(tSemicolon);
 			}
@@ -223,9 +546,10 @@ CAstModule* CParser::module()
 	if (tt == tBegin)
 	{
 		Consume(tBegin);
-		statseq = statSequence(m);
+		statseq = statSequence(m, _tac != NULL ? _tac->GetCodeBlock() : NULL);
 		m->SetStatementSequence(statseq);
 	}
+	if (_tac != NULL) _tac->GetCodeBlock()->CleanupControlFlow();
 
 	Consume(tEnd);
 
@@ -241,7 +565,7 @@ CAstModule* CParser::module()
 	return m;
 }
 
-void CParser::subroutineBody(CAstScope* s)
+void CParser::subroutineBody(CAstScope* s, CCodeBlock* cb)
 {
 	// subroutineBody ::= { constDeclaration | varOeclaration }
 	// 						"begin" statSequence "end"
@@ -264,13 +588,14 @@ void CParser::subroutineBody(CAstScope* s)
 		tt = _scanner->Peek().GetType();
 	}
 	Consume(tBegin);
-	statseq = statSequence(s);
+	statseq = statSequence(s, cb);
 	Consume(tEnd);
 
 	s->SetStatementSequence(statseq);
+	if (cb != NULL) cb->CleanupControlFlow();
 }
 
-CAstStatement* CParser::statSequence(CAstScope* s)
+CAstStatement* CParser::statSequence(CAstScope* s, CCodeBlock* cb)
 {
 	//
 	// statSequence ::= [ statement { ";" statement } ].
@@ -290,11 +615,14 @@ CAstStatement* CParser::statSequence(CAstScope* s)
 	// is present.
 	// In the loop, we track the end of the linked list using 'tail' and
 	// attach new statements to that tail.
+	// If a code block is given (single-pass compilation), the statements are
+	// parsed into the scratch arena and lowered one by one instead.
 	CAstStatement* head = nullptr;
 
 	if (_scanner->Peek().GetType() != tDot)
 	{
 		CAstStatement* tail = nullptr;
+		CAstArena* arena = cb != nullptr ? CAstArena::SetCurrent(_scratch) : nullptr;
 
 		do
 		{
@@ -318,9 +646,9 @@ CAstStatement* CParser::statSequence(CAstScope* s)
 			case tIdent:
 			{
 				CToken tt = _scanner->Peek();
-				const CSymbol* sym = s->GetSymbolTable()->FindSymbol(tt.GetValue(), sLocal);
+				const CSymbol* sym = s->GetSymbolTable()->FindSymbol(tt.GetValueId(), sLocal);
 				if (sym == NULL){
-					sym = s->GetSymbolTable()->FindSymbol(tt.GetValue(), sGlobal);
+					sym = s->GetSymbolTable()->FindSymbol(tt.GetValueId(), sGlobal);
 				}
 				ESymbolType stype = sym->GetSymbolType();
 				if (stype == stProcedure) st = subroutineCall(s);
@@ -335,15 +663,25 @@ CAstStatement* CParser::statSequence(CAstScope* s)
 			}
 			if (_scanner->Peek().GetType() == tEnd) break;
 			assert(st != NULL);
-			if (head == NULL) head = st;
-			else tail->SetNext(st);
-			tail = st;
+			if (cb != nullptr) CompileStatement(s, st, cb);
+			else
+			{
+				if (head == NULL) head = st;
+				else tail->SetNext(st);
+				tail = st;
+			}
 
 			if (_scanner->Peek().GetType() == tDot) break;
 			if (_scanner->Peek().GetType() == tEnd) break;
 			if (_scanner->Peek().GetType() == tElse) break;
 			Consume(tSemicolon);
 		} while (!_abort);
+
+		if (cb != nullptr)
+		{
+			_scratch->Reset();
+			CAstArena::SetCurrent(arena);
+		}
 	}
 
 	return head;
@@ -364,130 +702,151 @@ CAstStatAssign* CParser::assignment(CAstScope* s)
 	return new CAstStatAssign(t, lhs, rhs);
 }
 
+//--------------------------------------------------------------------------------------------------
+// expression parsing
+//
+// Expressions are parsed by precedence climbing over an explicit operator stack instead of the
+// recursive chain expression -> simpleexpr -> term -> factor. Parenthesized sub-expressions and
+// "!" prefixes are kept on the same stack, so the recursion depth no longer grows with the
+// nesting depth of an expression; only array indices and call arguments recurse.
+//
+// The trees and their node creation order are identical to those of the recursive descent
+// parser: a leading sign binds to the first term of a simpleexpr and is kept as a CAstUnaryOp,
+// independently of the INT_CONST_* sign-parsing mode. A sign in front of a constant is folded
+// only when the operation is lowered to TAC (CAstUnaryOp::ToTac), so all modes behave as before.
+//
+// The operand and operator stacks are members so that they are allocated once per parser; an
+// expression nested in an array index or a call argument works on top of the enclosing one.
+//
 CAstExpression* CParser::expression(CAstScope* s)
 {
 	//
 	// expression ::= simpleexpr [ relOp simpleexpr ].
 	//
-	CToken t;
-	EOperation relop = opEqual;        //silent compiler warnings
-	CAstExpression* left = NULL, * right = NULL;
-
-	left = simpleexpr(s);
-
-	if (_scanner->Peek().GetType() == tRelOp)
-	{
-		Consume(tRelOp, &t);
-		right = simpleexpr(s);
-
-		if (t.GetValue() == "=") relop = opEqual;
-		else if (t.GetValue() == "#") relop = opNotEqual;
-		else if (t.GetValue() == "<") relop = opLessThan;
-		else if (t.GetValue() == "<=") relop = opLessEqual;
-		else if (t.GetValue() == ">") relop = opBiggerThan;
-		else if (t.GetValue() == ">=") relop = opBiggerEqual;
-		else SetError(t, "invalid relation.");
-
-		return new CAstBinaryOp(t, relop, left, right);
-	}
-	else
-	{
-		return left;
-	}
+	return operatorExpr(s, true);
 }
 
 CAstExpression* CParser::simpleexpr(CAstScope* s)
 {
 	//
-	// simpleexpr ::= term { termOp term }.
+	// simpleexpr ::= ["+"|"-"] term { termOp term }.
 	//
-	CAstExpression* n = NULL;
-
-	bool fUnary = false;
-	CToken tpm;
-	EOperation opUnary;
-	if (tPlusMinus == _scanner->Peek().GetType())
-	{
-		Consume(tPlusMinus, &tpm);
-		fUnary = true;
-		if (tpm.GetValue() == "-")
-			opUnary = opNeg;
-		else if (tpm.GetValue() == "+")
-			opUnary = opPos;
-		else
-		{
-			opUnary = opNop;
-			fUnary = false;
-		}
-	}
-
-	n = term(s);
-
-	if (fUnary)
-	{
-		CAstExpression* u = n;
-		n = new CAstUnaryOp(tpm, opUnary, u);
-	}
-
-	EOperation termop;
-
-	while (_scanner->Peek().GetType() == tPlusMinus || _scanner->Peek().GetType() == tOr)
-	{
-		CToken t;
-		CAstExpression* l = n, * r;
-
-		if (_scanner->Peek().GetType() == tPlusMinus)
-			Consume(tPlusMinus, &t);
-		if (_scanner->Peek().GetType() == tOr)
-			Consume(tOr, &t);
-
-		r = term(s);
-		if (t.GetValue() == "+") termop = opAdd;
-		else if (t.GetValue() == "-") termop = opSub;
-		else if (t.GetValue() == "||") termop = opOr;
-		else SetError(t, "invalid relation.");
-
-		n = new CAstBinaryOp(t, termop, l, r);
-	}
-
-	return n;
+	return operatorExpr(s, false);
 }
 
-CAstExpression* CParser::term(CAstScope* s)
+CAstExpression* CParser::operatorExpr(CAstScope* s, bool relop)
 {
 	//
-	// term ::= factor { ("*"|"/") factor }.
+	// term   ::= factor { factOp factor }.
+	// factor ::= ... | "(" expression ")" | "!" factor.
 	//
-	CAstExpression* n = NULL;
+	vector<CAstExpression*>& operands = _operands;
+	vector<SExprOp>& ops = _ops;
+	const size_t obase = operands.size(), base = ops.size();
+	bool rel = !relop;                 // no (further) relOp allowed in the current group
+	bool sign = true;                  // a simpleexpr starts here and may have a sign
+
+	// apply all operators on the stack that bind at least as strongly as 'prec'
+	auto reduce = [&](EExprPrec prec) {
+		while ((ops.size() > base) && (ops.back().prec >= prec)) {
+			SExprOp o = ops.back();
+			ops.pop_back();
+
+			CAstExpression* r = operands.back();
+			if (o.unary) {
+				operands.back() = new CAstUnaryOp(o.t, o.op, r);
+			} else {
+				operands.pop_back();
+				operands.back() = new CAstBinaryOp(o.t, o.op, operands.back(), r);
+			}
+		}
+	};
+
+	int parens = 0;
+
+	while (true) {
+		// prefix operators and open parentheses, then a factor
+		while (true) {
+			CToken t = _scanner->Peek();
+			EToken tt = t.GetType();
+
+			if (sign && (tt == tPlusMinus)) {
+				Consume(tPlusMinus, &t);
+				ops.push_back({ t, t.GetValue() == "-" ? opNeg : opPos, precSign, true, rel });
+				sign = false;
+			} else if (tt == tNot) {
+				Consume(tNot, &t);
+				ops.push_back({ t, opNot, precNot, true, rel });
+				sign = false;
+			} else if (tt == tLParens) {
+				Consume(tLParens, &t);
+				ops.push_back({ t, opNop, precParens, false, rel });
+				parens++;
+				rel = false;
+				sign = true;
+			} else {
+				break;
+			}
+		}
 
-	n = factor(s);
+		operands.push_back(factor(s));
+		sign = false;
 
-	EToken tt = _scanner->Peek().GetType();
+		// closing parentheses, then a binary operator or the end of the expression
+		while (true) {
+			CToken t = _scanner->Peek();
+			EToken tt = t.GetType();
+			EExprPrec prec = precParens;
 
-	while (tt == tMulDiv || tt == tAnd)
-	{
-		CToken t;
-		CAstExpression* l = n, * r;
-		EOperation factop = opMul;        // Silent compiler warning
+			if ((tt == tRelOp) && !rel) prec = precRel;
+			else if ((tt == tPlusMinus) || (tt == tOr)) prec = precTerm;
+			else if ((tt == tMulDiv) || (tt == tAnd)) prec = precFact;
 
-		if (tt == tMulDiv)
-			Consume(tMulDiv, &t);
-		if (tt == tAnd)
-			Consume(tAnd, &t);
+			if (prec != precParens) {
+				EOperation op = opNop;
+				Consume(tt, &t);
 
-		r = factor(s);
+				const string& v = t.GetValue();
+				switch (v[0])
+				{
+				case '=': op = opEqual; break;
+				case '#': op = opNotEqual; break;
+				case '<': op = (v.size() == 1) ? opLessThan : opLessEqual; break;
+				case '>': op = (v.size() == 1) ? opBiggerThan : opBiggerEqual; break;
+				case '+': op = opAdd; break;
+				case '-': op = opSub; break;
+				case '|': op = opOr; break;
+				case '*': op = opMul; break;
+				case '/': op = opDiv; break;
+				case '&': op = opAnd; break;
+				default: SetError(t, "invalid relation."); break;
+				}
 
-		if (t.GetValue() == "*") factop = opMul;
-		else if (t.GetValue() == "/") factop = opDiv;
-		else if (t.GetValue() == "&&") factop = opAnd;
-		else SetError(t, "invalid relation.");
+				reduce(prec);
+				ops.push_back({ t, op, prec, false, rel });
 
-		n = new CAstBinaryOp(t, factop, l, r);
+				if (prec == precRel) {
+					rel = true;
+					sign = true;
+				}
+				break;
+			}
 
-		tt = _scanner->Peek().GetType();
-	}
+			reduce(precRel);
 
-	return n;
+			if (parens == 0) {
+				assert((ops.size() == base) && (operands.size() == obase + 1));
+				CAstExpression* e = operands.back();
+				operands.pop_back();
+				return e;
+			}
+
+			Consume(tRParens);
+			rel = ops.back().rel;
+			ops.pop_back();
+			parens--;
+		}
+	}
 }
 
 CAstExpression* CParser::factor(CAstScope* s)
@@ -498,6 +857,8 @@ CAstExpression* CParser::factor(CAstScope* s)
 	//
 	// FIRST(factor) = { tDigit, tLBrak }
 	//
+	// "(" expression ")" and "!" factor are handled by operatorExpr.
+	//
 
 	CToken tt = _scanner->Peek();
 	CAstExpression* numbr = NULL;
@@ -509,13 +870,6 @@ CAstExpression* CParser::factor(CAstScope* s)
 		numbr = number();
 		break;
 
-		// factor ::= "(" expression ")"
-	case tLParens:
-		Consume(tLParens);
-		numbr = expression(s);
-		Consume(tRParens);
-		break;
-
 	case tCharConst :
 		numbr = character();
 		break;
@@ -530,7 +884,7 @@ CAstExpression* CParser::factor(CAstScope* s)
 
 	case tIdent:
 	{    // necessary for var decl
-		const CSymbol* sym = s->GetSymbolTable()->FindSymbol(tt.GetValue());
+		const CSymbol* sym = s->GetSymbolTable()->FindSymbol(tt.GetValueId());
 		if (sym)
 		{
 			ESymbolType stype = sym->GetSymbolType();
@@ -544,14 +898,6 @@ CAstExpression* CParser::factor(CAstScope* s)
 		break;
 	}
 
-	case tNot:
-	{    // necessary for var decl
-		Consume(tNot, &tt);
-		CAstExpression* e = factor(s);
-		numbr = new CAstUnaryOp(tt, opNot, e);
-		break;
-	}
-
 	default:
 		SetError(_scanner->Peek(), "factor expected.");
 		break;
@@ -591,14 +937,14 @@ void CParser::varDeclaration(CAstScope* s)
 	{
 		Consume(tVarDecl, &t);
 
-		vector<string> variables;
+		unordered_set<int> variables;
 
 		do
 		{
 			vector<string> liste;
 			CAstType* ttype;
 
-			varDecl(liste, ttype, variables);
+			varDecl(liste, ttype, variables, s);
 
 			for (const auto& str : liste)
 			{
@@ -612,7 +958,7 @@ void CParser::varDeclaration(CAstScope* s)
 	}
 }
 
-void CParser::varDecl(vector<string>& variables, CAstType*& ttype, vector<string>& toutesVariables)
+void CParser::varDecl(vector<string>& variables, CAstType*& ttype, unordered_set<int>& toutesVariables, CAstScope* s)
 {
 	//
 	// varDecl = ident {"," ident} ":" type.
@@ -624,16 +970,13 @@ void CParser::varDecl(vector<string>& variables, CAstType*& ttype, vector<string
 		if (tt != tIdent)
 			SetError(t, "invalid identifier");
 
-		for (const auto& var : toutesVariables)
+		// names are interned, so duplicates are found by their id
+		if (!toutesVariables.insert(t.GetValueId()).second)
 		{
-			if (var == t.GetValue())
-			{
-				SetError(t, "re-decalaration variable \"" + t.GetValue() + "\"");
-				return;
-			}
+			SetError(t, "re-decalaration variable \"" + t.GetValue() + "\"");
+			return;
 		}
 		variables.push_back(t.GetValue());
-		toutesVariables.push_back(t.GetValue());
 
 		t = _scanner->Peek();
 		tt = t.GetType();
@@ -645,67 +988,48 @@ void CParser::varDecl(vector<string>& variables, CAstType*& ttype, vector<string
 		tt = _scanner->Peek().GetType();
 	}
 	Consume(tColon);
-	ttype = type();
+	ttype = type(s);
 }
 
 void CParser::constDeclaration(CAstScope* s)
 {
 	//
 	// constDeclaration = [ "const" constDeclSequence ].
-	// constDeclSequence = constDecl ";" { constDecl ";" }
-	// FOLLOW(constDeclaration) = {tBegin}
+	// constDeclSequence = constDecl ";" { constDecl ";" }.
+	// constDecl = varDecl "=" expression.
 	//
-	CAstExpression* express = NULL;
-	EToken tt = _scanner->Peek().GetType();
-	CToken t;
-
-	if (tt == tConstDecl)
-	{
-		Consume(tConstDecl, &t);
-
-		do
-		{
-			if (tt == tVarDecl)
-			{
-				Consume(tVarDecl, &t);
+	if (_scanner->Peek().GetType() != tConstDecl) return;
+	Consume(tConstDecl);
 
-				vector<string> variables;
+	unordered_set<int> constants;
 
-				do
-				{
-					vector<string> liste;
-					CAstType* ttype;
-
-					varDecl(liste, ttype, variables);
-
-					for (const auto& str : liste)
-					{
-						t = _scanner->Get();
-						tt = t.GetType();
+	do
+	{
+		vector<string> liste;
+		CAstType* ttype;
+		CToken t;
 
-						express = expression(s);
+		varDecl(liste, ttype, constants, s);
 
-						if (tt == tRelOp && t.GetValue() == "=")
-							Consume(tRelOp);
-						else if (tt != tRelOp || t.GetValue() != "=")
-							SetError(t, "\"=\" expected");
+		Consume(tRelOp, &t);
+		if (t.GetValue() != "=") SetError(t, "\"=\" expected");
 
-						CSymbol* constante = s->CreateConst(str, ttype->GetType(),
-							reinterpret_cast<const CDataInitializer*>(express));
-						s->GetSymbolTable()->AddSymbol(constante);
-					}
+		// the value is folded once here; uses of the constant read it from the symbol
+		CAstExpression* value = expression(s);
+		const CDataInitializer* data = value->Evaluate();
+		if (data == NULL) SetError(value->GetToken(), "constant expression expected");
 
-					Consume(tSemicolon);
-					tt = _scanner->Peek().GetType();
-				} while (tt != tBegin && tt != tRelOp);
-			}
+		for (const auto& str : liste)
+		{
+			CSymbol* constante = s->CreateConst(str, ttype->GetType(), data);
+			s->GetSymbolTable()->AddSymbol(constante);
+		}
 
-			tt = _scanner->Peek().GetType();
-		} while (tt != tBegin);
-	}
+		Consume(tSemicolon);
+	} while (_scanner->Peek().GetType() == tIdent);
 }
 
-void CParser::constDecl(vector<string>& variables, CAstType*& ttype, vector<string>& toutesVariables, CAstScope* s)
+void CParser::constDecl(vector<string>& variables, CAstType*& ttype, unordered_set<int>& toutesVariables, CAstScope* s)
 {
 //
 //varDecl = ident {"," ident} ":" type.
@@ -720,16 +1044,13 @@ void CParser::constDecl(vector<string>& variables, CAstType*& ttype, vector<stri
 		if (tt != tIdent)
 			SetError(t, "invalid identifier");
 
-		for (const auto& var : toutesVariables)
+		// names are interned, so duplicates are found by their id
+		if (!toutesVariables.insert(t.GetValueId()).second)
 		{
-			if (var == t.GetValue())
-			{
-				SetError(t, "re-decalaration variable \"" + t.GetValue() + "\"");
-				return;
-			}
+			SetError(t, "re-decalaration variable \"" + t.GetValue() + "\"");
+			return;
 		}
 		variables.push_back(t.GetValue());
-		toutesVariables.push_back(t.GetValue());
 
 		t = _scanner->Peek();
 		tt = t.GetType();
@@ -741,7 +1062,7 @@ void CParser::constDecl(vector<string>& variables, CAstType*& ttype, vector<stri
 		tt = _scanner->Peek().GetType();
 	}
 	Consume(tColon);
-	ttype = type();
+	ttype = type(s);
 
 	CToken t = _scanner->Get();
 	EToken tt = t.GetType();
@@ -845,7 +1166,7 @@ bool CParser::_isexpressionfirst(EToken tt)
 	);
 }
 
-CAstType* CParser::type()
+CAstType* CParser::type(CAstScope* s)
 {
 	//
 	// type = basetype | type "[" [simpleexpr] "]".
@@ -885,9 +1206,12 @@ CAstType* CParser::type()
 		Consume(tLBrak);
 		if (_scanner->Peek().GetType() != tRBrak)
 		{
-			if (_scanner->Peek().GetType() == tPlusMinus)
-				Consume(tPlusMinus);
-			insideBrackets.push_back(number()->GetValue());
+			// the dimension is a constant expression; it may refer to named constants
+			CAstExpression* dim = simpleexpr(s);
+			const SConstValue& v = dim->Fold();
+			if ((v.type == NULL) || !(v.type->IsInteger() || v.type->IsLongint()) || (v.value <= 0))
+				SetError(dim->GetToken(), "positive constant integer expected");
+			insideBrackets.push_back(v.value);
 		}
 		else
 			insideBrackets.push_back(CArrayType::OPEN);
@@ -919,7 +1243,7 @@ CAstDesignator* CParser::qualident(CAstScope* s)
 		const CToken saveToken = id->GetToken();
 		const CSymbol* saveSymbol = id->GetSymbol();
 
-		free(id);
+		// the plain designator is released with the module's arena
 		auto* arrayId = new CAstArrayDesignator(saveToken, saveSymbol);
 		while (tt == tLBrak)
 		{
@@ -930,7 +1254,7 @@ CAstDesignator* CParser::qualident(CAstScope* s)
 			Consume(tRBrak);
 			tt = _scanner->Peek().GetType();
 		}
-		arrayId->IndicesComplete();
+		arrayId->IndicesComplete(_dim, _dofs);
 		return arrayId;
 	}
 
@@ -944,9 +1268,9 @@ CAstDesignator* CParser::ident(CAstScope* s)
 	Consume(tIdent, &t);
 
 	CSymtab* symtab = s->GetSymbolTable();
-	const CSymbol* symbol = symtab->FindSymbol(t.GetValue(), sLocal);
+	const CSymbol* symbol = symtab->FindSymbol(t.GetValueId(), sLocal);
 	if (symbol == NULL)
-		symbol = symtab->FindSymbol(t.GetValue(), sGlobal);
+		symbol = symtab->FindSymbol(t.GetValueId(), sGlobal);
 
 	return new CAstDesignator(t, symbol);
 }
@@ -974,7 +1298,7 @@ CAstFunctionCall* CParser::functionCall(CAstScope* s)
 	CToken t;
 
 	Consume(tIdent, &t);
-	const CSymbol* symbol = s->GetSymbolTable()->FindSymbol(t.GetValue(), sGlobal);
+	const CSymbol* symbol = s->GetSymbolTable()->FindSymbol(t.GetValueId(), sGlobal);
 	if (!symbol)
 		SetError(t, "undeclared subroutine name");
 
@@ -1010,7 +1334,7 @@ CAstProcedure* CParser::functionDecl(CAstScope* s)
 		SetError(t2, "expected function identifier");
 
 	const string& functionName = t2.GetValue();
-	if (s->GetSymbolTable()->FindSymbol(functionName, sGlobal))
+	if (s->GetSymbolTable()->FindSymbol(t2.GetValueId(), sGlobal))
 		SetError(t2, "re-declaration function \"" + functionName + "\"");
 
 	vector<string> paramNames;
@@ -1021,7 +1345,7 @@ CAstProcedure* CParser::functionDecl(CAstScope* s)
 	switch (t2.GetType())
 	{
 	case tLParens:
-		formalParam(paramNames, paramTypes);
+		formalParam(paramNames, paramTypes, s);
 		break;
 	case tColon:
 		break;
@@ -1031,7 +1355,7 @@ CAstProcedure* CParser::functionDecl(CAstScope* s)
 	}
 
 	Consume(tColon);
-	returnType = type();
+	returnType = type(s);
 	Consume(tSemicolon);
 
 	auto* symbol = new CSymProc(functionName, returnType->GetType());
@@ -1057,7 +1381,7 @@ CAstProcedure* CParser::procedureDecl(CAstScope* s)
 		SetError(t2, "expected procedure identifier");
 
 	const string& procedureName = t2.GetValue();
-	if (s->GetSymbolTable()->FindSymbol(procedureName, sGlobal))
+	if (s->GetSymbolTable()->FindSymbol(t2.GetValueId(), sGlobal))
 		SetError(t2, "re-declaration procedure \"" + procedureName + "\"");
 
 	vector<string> noms;
@@ -1067,7 +1391,7 @@ CAstProcedure* CParser::procedureDecl(CAstScope* s)
 	switch (t2.GetType())
 	{
 	case tLParens:
-		formalParam(noms, parametresTypes);
+		formalParam(noms, parametresTypes, s);
 		break;
 	case tSemicolon:
 		break;
@@ -1087,7 +1411,7 @@ CAstProcedure* CParser::procedureDecl(CAstScope* s)
 	return ret;
 }
 
-void CParser::formalParam(vector<string>& noms, vector<CAstType*>& types)
+void CParser::formalParam(vector<string>& noms, vector<CAstType*>& types, CAstScope* s)
 {
 	//
 	// formalParam = "(" [ varDeclSequence ] ")".
@@ -1097,12 +1421,14 @@ void CParser::formalParam(vector<string>& noms, vector<CAstType*>& types)
 	CToken t = _scanner->Peek();
 	if (t.GetType() == tIdent)
 	{
+		unordered_set<int> declared;
 		do
 		{
 			vector<string> liste;
 			CAstType* ttype;
-			varDecl(liste, ttype, noms);
+			varDecl(liste, ttype, declared, s);
 
+			noms.insert(noms.end(), liste.begin(), liste.end());
 			for (int i = 0; i < (int)liste.size(); i++)
 				types.push_back(ttype);
 			t = _scanner->Peek();
@@ -36,9 +36,51 @@
 #ifndef __SnuPL_PARSER_H__
 #define __SnuPL_PARSER_H__
 
+#include <unordered_set>
+
 #include "scanner.h"
 #include "symtab.h"
 #include "ast.h"
+#include "astflat.h"
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief binding power of the operators of an expression
+///
+enum EExprPrec {
+  precParens = 0,                     ///< marker for an open parenthesis
+  precRel,                            ///< relOp (non-associative)
+  precTerm,                           ///< termOp ("+", "-", "||")
+  precSign,                           ///< leading sign of a simpleexpr
+  precFact,                           ///< factOp ("*", "/", "&&")
+  precNot,                            ///< "!" factor
+};
+
+//--------------------------------------------------------------------------------------------------
+/// @brief operator stack entry of the expression parser
+///
+struct SExprOp {
+  CToken t;                           ///< operator token
+  EOperation op;                      ///< operation
+  EExprPrec prec;                     ///< binding power
+  bool unary;                         ///< prefix operator
+  bool rel;                           ///< (parentheses) enclosing group has seen a relOp
+};
+
+//--------------------------------------------------------------------------------------------------
+/// @brief subroutine body deferred to a worker thread (see CParser::ParseParallel())
+///
+struct SParseJob {
+  CAstProcedure *scope;               ///< subroutine
+  size_t begin;                       ///< index of the first token of the body
+  size_t end;                         ///< index of the token following the body's "end"
+  int strbase;                        ///< number of string constants preceding the body
+  int strings;                        ///< number of string constants in the body
+  bool done;                          ///< body parsed exactly as by the serial parser
+  bool error;                         ///< parse error in the body
+  CToken error_token;                 ///< error token
+  string message;                     ///< error message
+};
 
 
 //--------------------------------------------------------------------------------------------------
@@ -53,10 +95,41 @@ class CParser {
     /// @param scanner  CScanner from which the input stream is read
     CParser(CScanner *scanner);
 
+    /// @brief parse subroutine bodies on several threads
+    ///
+    /// Parse() then first parses the module with all declarations and subroutine headers,
+    /// skipping over the bodies (found by a pre-scan of the token stream), and afterwards parses
+    /// the bodies concurrently. Each body only sees the global declarations that precede it.
+    /// The resulting AST and errors are the same as those of the serial parser; only the node
+    /// ids (dot output) differ. Must be called before Parse().
+    ///
+    /// @param nthreads number of threads (<= 1: serial parsing)
+    void ParseParallel(unsigned int nthreads) { _threads = nthreads; };
+
     /// @brief parse a module
     /// @retval CAstNode program node
     CAstNode* Parse(void);
 
+    /// @brief parse a module and generate its TAC in a single pass
+    ///
+    /// Every statement of a scope's body is type checked and lowered into the scope's code block
+    /// as soon as it has been parsed; its AST is released right after. The returned module thus
+    /// holds the scopes and symbol tables, but no statements, and must outlive @a tac.
+    /// Subroutine bodies are parsed serially (see ParseParallel()). Semantic errors are reported
+    /// like parse errors (see IsSemanticError()).
+    ///
+    /// @param tac receives the TAC of the module (NULL on error); owned by the caller
+    /// @retval CAstNode program node, or NULL on error
+    CAstNode* Compile(CModule **tac);
+
+    /// @brief flatten the AST of the parsed module
+    ///
+    /// The flattened AST shares symbols and types with the module returned by Parse() and must
+    /// not outlive it. The caller owns the returned object.
+    ///
+    /// @retval CAstFlat flattened AST, or NULL if there was a parse error
+    CAstFlat* Flatten(void) const;
+
     /// @name error handling
     ///@{
 
@@ -72,6 +145,9 @@ class CParser {
     /// @brief returns a human-readable error message
     /// @retval error message
     string GetErrorMessage(void) const;
+
+    /// @brief indicates whether the error was found by the type checker (see Compile())
+    bool IsSemanticError(void) const { return _semantic; };
     ///@}
 
   private:
@@ -97,13 +173,13 @@ class CParser {
 
     CAstModule*       module(void);
 
-    CAstStatement*    statSequence(CAstScope *s);
+    CAstStatement*    statSequence(CAstScope *s, CCodeBlock *cb=NULL);
 
     CAstStatAssign*   assignment(CAstScope *s);
 
     CAstExpression*   expression(CAstScope *s);
     CAstExpression*   simpleexpr(CAstScope *s);
-    CAstExpression*   term(CAstScope *s);
+    CAstExpression*   operatorExpr(CAstScope *s, bool relop);
     CAstExpression*   factor(CAstScope *s);
 
     CAstConstant*     number(void);
@@ -119,24 +195,64 @@ class CParser {
     CToken        _error_token;   ///< error token
     string        _message;       ///< error message
     bool          _abort;         ///< error flag
+    bool          _semantic;      ///< error found by the type checker
+
+    /// @name parallel parsing of subroutine bodies
+    unsigned int  _threads;       ///< number of threads
+    bool          _defer;         ///< defer subroutine bodies to worker threads
+    vector<SParseJob> _jobs;      ///< deferred subroutine bodies
+
+    /// @name runtime functions for array accesses (declared by InitSymbolTable())
+    const CSymProc *_dim;         ///< DIM(array, dim): size of a dimension
+    const CSymProc *_dofs;        ///< DOFS(array): offset of the data
+
+    /// @brief defer the body of a subroutine to a worker thread
+    ///
+    /// Pre-scans the token stream for the end of the body and continues after it.
+    ///
+    /// @param s subroutine
+    /// @retval true if the body has been deferred
+    /// @retval false if the end of the body was not found (the body must be parsed now)
+    bool DeferBody(CAstProcedure *s);
+
+    /// @brief parse the deferred subroutine bodies concurrently
+    ///
+    /// @retval true if all bodies have been parsed as by the serial parser (or an error has
+    ///         been found)
+    /// @retval false if the module has to be parsed serially
+    bool ParseBodies(void);
+
+    /// @name single-pass compilation (see Compile())
+    CModule      *_tac;           ///< TAC of the module, or NULL when building the full AST
+    CAstArena    *_scratch;       ///< arena of the statement being compiled
+
+    /// @brief type check @a st and lower it into @a cb, then release its AST
+    /// @param s scope of the statement
+    /// @param st statement
+    /// @param cb code block of @a s
+    void CompileStatement(CAstScope *s, CAstStatement *st, CCodeBlock *cb);
+
+    /// @name expression parser stacks (shared by nested expressions)
+    vector<CAstExpression*> _operands; ///< operand stack
+    vector<SExprOp> _ops;             ///< operator stack
 
-	void subroutineBody(CAstScope* S);
+	void subroutineBody(CAstScope* S, CCodeBlock* cb = nullptr);
 	void varDeclaration(CAstScope* s);
 	void constDeclaration(CAstScope* s);
 	CAstStatIf* ifstatement(CAstScope* s);
 	CAstStatWhile* whilestatement(CAstScope* s);
 	bool _isexpressionfirst(EToken tt);
 	CAstStatReturn* returnstatement(CAstScope* s);
-	void varDecl(vector<string>& variables, CAstType*& ttype, vector<string>& toutesVariables);
-	void constDecl(vector<string>& variables, CAstType*& ttype, vector<string>& toutesVariables, CAstScope* s);
-	CAstType* type();
+	void varDecl(vector<string>& variables, CAstType*& ttype, unordered_set<int>& toutesVariables, CAstScope* s);
+	void constDecl(vector<string>& variables, CAstType*& ttype, unordered_set<int>& toutesVariables, CAstScope* s);
+	CAstType* type(CAstScope* s);
 	CAstDesignator* qualident(CAstScope* s);
 	CAstDesignator* ident(CAstScope* pScope);
 	CAstStatCall* subroutineCall(CAstScope* s);
 	CAstFunctionCall* functionCall(CAstScope* s);
 	CAstProcedure* functionDecl(CAstScope* s);
 	CAstProcedure* procedureDecl(CAstScope* s);
-	void formalParam(vector<string>& noms, vector<CAstType*>& types);
+	void formalParam(vector<string>& noms, vector<CAstType*>& types, CAstScope* s);
 	void AddParameters(CAstScope* s, CSymProc* symbol, vector<string>& noms, vector<CAstType*>& types);
 	CAstConstant* boolean();
 	CAstConstant* character();
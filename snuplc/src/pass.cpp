@@ -0,0 +1,265 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL pass manager
+///
+/// ordered pipelines of TAC transformations per scope, selected by optimization level
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <cassert>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+#include "pass.h"
+#include "ssa.h"
+#include "opt.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// available passes and pipelines
+//
+
+/// @brief remove superfluous branches and labels
+static bool Cleanup(CCodeBlock *cb)
+{
+  size_t n = cb->GetNumInstr();
+  cb->CleanupControlFlow();
+  return cb->GetNumInstr() != n;
+}
+
+/// @brief convert into SSA form
+static bool ToSSA(CCodeBlock *cb)
+{
+  ConstructSSA(cb);
+  return true;
+}
+
+/// @brief convert out of SSA form
+static bool FromSSA(CCodeBlock *cb)
+{
+  DestructSSA(cb);
+  return true;
+}
+
+/// @brief available passes
+struct {
+  const char *name;
+  bool (*run)(CCodeBlock *cb);
+} Passes[] =
+{
+  { "cleanup",    Cleanup },
+  { "ssa",        ToSSA },
+  { "out-of-ssa", FromSSA },
+  { "constfold",  FoldConstants },
+  { "copyprop",   PropagateCopies },
+  { "dce",        EliminateDeadCode },
+  { "dse",        EliminateDeadStores },
+  { NULL }
+};
+
+/// @brief pipelines of the optimization levels (NULL-terminated)
+static const char *Pipeline0[] = { NULL };
+static const char *Pipeline1[] = { "constfold", "copyprop", "dse", "dce", "cleanup", NULL };
+static const char *Pipeline2[] = { "ssa", "constfold", "copyprop", "constfold", "dce", "out-of-ssa",
+                                   "dce", "cleanup", NULL };
+static const char **Pipelines[] = { Pipeline0, Pipeline1, Pipeline2 };
+
+
+//--------------------------------------------------------------------------------------------------
+// CPass
+//
+CPass::CPass(const string name)
+  : _name(name)
+{
+}
+
+CPass::~CPass(void)
+{
+}
+
+string CPass::GetName(void) const
+{
+  return _name;
+}
+
+
+/// @brief pass running a transformation of the code block
+class CCodeBlockPass : public CPass {
+  public:
+    CCodeBlockPass(const string name, bool (*run)(CCodeBlock *cb))
+      : CPass(name), _run(run)
+    {
+    }
+
+    virtual bool Run(CScope *scope)
+    {
+      return _run(scope->GetCodeBlock());
+    }
+
+  private:
+    bool (*_run)(CCodeBlock *cb);    ///< transformation
+};
+
+
+//--------------------------------------------------------------------------------------------------
+// CPassManager
+//
+CPassManager::CPassManager(void)
+  : _dump(""), _dumpout(NULL)
+{
+}
+
+CPassManager::~CPassManager(void)
+{
+  for (size_t p=0; p<_passes.size(); p++) delete _passes[p];
+}
+
+CPass* CPassManager::CreatePass(const string name)
+{
+  for (unsigned int i=0; Passes[i].name != NULL; i++) {
+    if (name == Passes[i].name) return new CCodeBlockPass(name, Passes[i].run);
+  }
+
+  return NULL;
+}
+
+vector<string> CPassManager::GetPassNames(void)
+{
+  vector<string> names;
+  for (unsigned int i=0; Passes[i].name != NULL; i++) names.push_back(Passes[i].name);
+  return names;
+}
+
+bool CPassManager::AddPasses(int level)
+{
+  if ((level < 0) || (level >= (int)(sizeof(Pipelines)/sizeof(Pipelines[0])))) return false;
+
+  for (const char **name = Pipelines[level]; *name != NULL; name++) {
+    CPass *pass = CreatePass(*name);
+    assert(pass != NULL);
+    AddPass(pass);
+  }
+
+  return true;
+}
+
+void CPassManager::AddPass(CPass *pass)
+{
+  assert(pass != NULL);
+
+  SPassStats stats = { 0.0, 0, 0, 0 };
+  _passes.push_back(pass);
+  _stats.push_back(stats);
+}
+
+const vector<CPass*>& CPassManager::GetPasses(void) const
+{
+  return _passes;
+}
+
+bool CPassManager::HasPass(const string name) const
+{
+  for (size_t p=0; p<_passes.size(); p++) {
+    if (_passes[p]->GetName() == name) return true;
+  }
+
+  return false;
+}
+
+void CPassManager::DumpAfter(const string name, ostream *out)
+{
+  _dump = name;
+  _dumpout = out;
+}
+
+void CPassManager::Run(CModule *m)
+{
+  assert(m != NULL);
+
+  Run(static_cast<CScope*>(m));
+
+  const vector<CScope*> &proc = m->GetSubscopes();
+  for (size_t p=0; p<proc.size(); p++) Run(proc[p]);
+}
+
+void CPassManager::Run(CScope *scope)
+{
+  assert(scope != NULL);
+
+  CCodeBlock *cb = scope->GetCodeBlock();
+
+  for (size_t p=0; p<_passes.size(); p++) {
+    SPassStats &stats = _stats[p];
+    size_t before = cb->GetNumInstr();
+
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    bool changed = _passes[p]->Run(scope);
+    stats.time += chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    stats.before += before;
+    stats.after += cb->GetNumInstr();
+    if (changed) stats.changed++;
+
+    if ((_dumpout != NULL) && (_passes[p]->GetName() == _dump)) {
+      cb->Renumber();
+      *_dumpout << "after " << _dump << " (pass " << p+1 << "):" << endl
+                << cb << endl;
+    }
+  }
+
+  cb->Renumber();
+}
+
+ostream& CPassManager::PrintTimings(ostream &out, int indent) const
+{
+  string ind(indent, ' ');
+  ios::fmtflags flags = out.flags();
+  streamsize precision = out.precision();
+
+  out << ind << left << setw(14) << "pass" << right << setw(10) << "time"
+      << setw(29) << "instructions" << setw(15) << "changed" << endl;
+
+  double total = 0.0;
+  for (size_t p=0; p<_passes.size(); p++) {
+    const SPassStats &stats = _stats[p];
+    ostringstream delta;
+    delta << "(" << showpos << (long long)stats.after - (long long)stats.before << ")";
+
+    out << ind << left << setw(14) << _passes[p]->GetName() << right
+        << fixed << setprecision(6) << setw(9) << stats.time << "s"
+        << setw(9) << stats.before << " ->" << setw(9) << stats.after << setw(10) << delta.str()
+        << setw(8) << stats.changed << " scopes" << endl;
+    total += stats.time;
+  }
+
+  out << ind << left << setw(14) << "total" << right
+      << fixed << setprecision(6) << setw(9) << total << "s" << endl;
+
+  out.flags(flags);
+  out.precision(precision);
+
+  return out;
+}
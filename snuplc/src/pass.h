@@ -0,0 +1,192 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL pass manager
+///
+/// ordered pipelines of TAC transformations per scope, selected by optimization level
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_PASS_H__
+#define __SnuPL_PASS_H__
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ir.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief function pass
+///
+/// base class for transformations of the code block of one scope
+///
+
+class CPass {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor
+    /// @param name name of the pass
+    CPass(const string name);
+
+    /// @brief destructor
+    virtual ~CPass(void);
+
+    /// @}
+
+
+    /// @name properties
+    /// @{
+
+    /// @brief return the name of the pass
+    string GetName(void) const;
+
+    /// @}
+
+
+    /// @name transformation
+    /// @{
+
+    /// @brief run the pass on the code block of @a scope
+    /// @param scope scope
+    /// @retval true if the code block was changed
+    virtual bool Run(CScope *scope) = 0;
+
+    /// @}
+
+  private:
+    const string _name;              ///< name
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief pass manager
+///
+/// runs an ordered pipeline of passes on every scope of a module. The manager records the wall
+/// time and the change in the number of instructions of every pass of the pipeline and prints
+/// the code after the runs of a selected pass.
+///
+/// Available passes:
+///   cleanup     remove superfluous branches and labels (CCodeBlock::CleanupControlFlow())
+///   ssa         convert into SSA form (ConstructSSA())
+///   out-of-ssa  convert out of SSA form (DestructSSA())
+///   constfold   fold constants (FoldConstants())
+///   copyprop    propagate copies (PropagateCopies())
+///   dce         remove dead code (EliminateDeadCode())
+///   dse         remove dead stores (EliminateDeadStores())
+///
+/// Optimization levels:
+///   0           no passes
+///   1           constfold copyprop dse dce cleanup
+///   2           ssa constfold copyprop constfold dce out-of-ssa dce cleanup
+///
+
+class CPassManager {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor (empty pipeline)
+    CPassManager(void);
+
+    /// @brief destructor; deletes the passes of the pipeline
+    ~CPassManager(void);
+
+    /// @}
+
+
+    /// @name pipeline
+    /// @{
+
+    /// @brief create the pass @a name
+    /// @param name name of the pass
+    /// @retval CPass* new pass, or NULL if there is no pass @a name
+    static CPass* CreatePass(const string name);
+
+    /// @brief return the names of all available passes
+    static vector<string> GetPassNames(void);
+
+    /// @brief append the pipeline of optimization level @a level
+    /// @param level optimization level (0-2)
+    /// @retval true on success, false if @a level is not supported
+    bool AddPasses(int level);
+
+    /// @brief append @a pass to the pipeline; the manager takes ownership
+    void AddPass(CPass *pass);
+
+    /// @brief return the passes of the pipeline
+    const vector<CPass*>& GetPasses(void) const;
+
+    /// @brief returns true if the pipeline contains pass @a name
+    bool HasPass(const string name) const;
+
+    /// @}
+
+
+    /// @name execution
+    /// @{
+
+    /// @brief print the code block of every scope to @a out after each run of pass @a name
+    /// @param name name of the pass
+    /// @param out output stream (NULL to stop printing)
+    void DumpAfter(const string name, ostream *out);
+
+    /// @brief run the pipeline on the module @a m and all its subscopes
+    void Run(CModule *m);
+
+    /// @brief run the pipeline on @a scope
+    void Run(CScope *scope);
+
+    /// @}
+
+
+    /// @name output
+    /// @{
+
+    /// @brief print the accumulated time and instruction count delta of every pass
+    /// @param out output stream
+    /// @param indent indentation
+    ostream& PrintTimings(ostream &out, int indent=0) const;
+
+    /// @}
+
+  private:
+    /// @brief statistics of a pass of the pipeline
+    struct SPassStats {
+      double time;                   ///< wall time in seconds
+      size_t before;                 ///< instructions before the pass
+      size_t after;                  ///< instructions after the pass
+      unsigned int changed;          ///< number of scopes changed
+    };
+
+    vector<CPass*> _passes;          ///< pipeline
+    vector<SPassStats> _stats;       ///< statistics (indexed like _passes)
+    string _dump;                    ///< pass after which the code is printed
+    ostream *_dumpout;               ///< output stream for printing
+};
+
+#endif // __SnuPL_PASS_H__
@@ -0,0 +1,1375 @@
+//------------------------------------------------------------------------------
+/// @brief SnuPL/1 scanner
+/// @author Bernhard Egger <bernhard@csap.snu.ac.kr>
+/// @section changelog Change Log
+/// 2012/09/14 Bernhard Egger created
+/// 2013/03/07 Bernhard Egger adapted to SnuPL/0
+/// 2016/03/11 Bernhard Egger adapted to SnuPL/1
+/// 2017/09/22 Bernhard Egger fixed implementation of strings and characters
+/// 2019/09/13 Bernhard Egger added const token, better string/char handling
+///
+/// @section license_section License
+/// Copyright (c) 2012-2019, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms,  with or without modifi-
+/// cation, are permitted provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice,
+///   this list of conditions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice,
+///   this list of conditions and the following disclaimer in the documentation
+///   and/or other materials provided with the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+/// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+/// IMPLIED WARRANTIES OF MERCHANTABILITY  AND FITNESS FOR A PARTICULAR PURPOSE
+/// ARE DISCLAIMED. IN NO  EVENT SHALL THE COPYRIGHT HOLDER  OR CONTRIBUTORS BE
+/// LIABLE FOR ANY DIRECT,  INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+/// GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+/// HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN  CONTRACT, STRICT
+/// LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY  WAY
+/// OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <cassert>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <thread>
+
+#if defined(__SSE2__) && !defined(SCANNER_NO_SIMD)
+#define SCANNER_SIMD
+#include <immintrin.h>
+#endif
+
+#include "scanner.h"
+using namespace std;
+
+//------------------------------------------------------------------------------
+// token names
+//
+#define TOKEN_STRLEN 24
+
+char ETokenName[][TOKEN_STRLEN] = {
+  "tIdent",                         ///< ident
+  "tNumber",                        ///< number
+  "tBoolConst",                     ///< boolean constant
+  "tCharConst",                     ///< character constant
+  "tStringConst",                   ///< string constant
+  "tPlusMinus",                     ///< '+' or '-'
+  "tMulDiv",                        ///< '*' or '/'
+  "tOr",                            ///< '||'
+  "tAnd",                           ///< '&&'
+  "tNot",                           ///< '!'
+  "tRelOp",                         ///< relational operator
+  "tAssign",                        ///< assignment operator
+  "tComma",                         ///< a comma
+  "tSemicolon",                     ///< a semicolon
+  "tColon",                         ///< a colon
+  "tDot",                           ///< a dot
+  "tLParens",                       ///< a left parenthesis
+  "tRParens",                       ///< a right parenthesis
+  "tLBrak",                         ///< a left bracket
+  "tRBrak",                         ///< a right bracket
+
+  "tModule",                        ///< 'module'
+  "tProcedure",                     ///< 'procedure'
+  "tFunction",                      ///< 'function'
+  "tVarDecl",                       ///< 'var'
+  "tConstDecl",                     ///< 'const'
+  "tInteger",                       ///< 'integer'
+  "tBoolean",                       ///< 'boolean'
+  "tChar",                          ///< 'char'
+  "tBegin",                         ///< 'begin'
+  "tEnd",                           ///< 'end'
+  "tIf",                            ///< 'if'
+  "tThen",                          ///< 'then'
+  "tElse",                          ///< 'else'
+  "tWhile",                         ///< 'while'
+  "tDo",                            ///< 'do'
+  "tReturn",                        ///< 'return'
+
+  "tComment",                       ///< comment ('// .... \n')
+  "tEOF",                           ///< end of file
+  "tIOError",                       ///< I/O error
+  "tInvCharConst",                  ///< invalid character constant
+  "tInvStringConst",                ///< invalid string constant
+  "tUndefined",                     ///< undefined
+};
+
+
+//------------------------------------------------------------------------------
+// format strings used for printing tokens
+//
+
+char ETokenStr[][TOKEN_STRLEN] = {
+  "tIdent (%s)",                    ///< ident
+  "tNumber (%s)",                   ///< number
+  "tBoolConst (%s)",                ///< boolean constant
+  "tCharConst (%s)",                ///< character constant
+  "tStringConst (\"%s\")",          ///< string constant
+  "tPlusMinus (%s)",                ///< '+' or '-'
+  "tMulDiv (%s)",                   ///< '*' or '/'
+  "tOr",                            ///< '||'
+  "tAnd",                           ///< '&&'
+  "tNot",                           ///< '!'
+  "tRelOp (%s)",                    ///< relational operator
+  "tAssign",                        ///< assignment operator
+  "tComma",                         ///< a comma
+  "tSemicolon",                     ///< a semicolon
+  "tColon",                         ///< a colon
+  "tDot",                           ///< a dot
+  "tLParens",                       ///< a left parenthesis
+  "tRParens",                       ///< a right parenthesis
+  "tLBrak",                         ///< a left bracket
+  "tRBrak",                         ///< a right bracket
+
+  "tModule",                        ///< 'module'
+  "tProcedure",                     ///< 'procedure'
+  "tFunction",                      ///< 'function'
+  "tVarDecl",                       ///< 'var'
+  "tConstDecl",                     ///< 'const'
+  "tInteger",                       ///< 'integer'
+  "tBoolean",                       ///< 'boolean'
+  "tChar",                          ///< 'char'
+  "tBegin",                         ///< 'begin'
+  "tEnd",                           ///< 'end'
+  "tIf",                            ///< 'if'
+  "tThen",                          ///< 'then'
+  "tElse",                          ///< 'else'
+  "tWhile",                         ///< 'while'
+  "tDo",                            ///< 'do'
+  "tReturn",                        ///< 'return'
+
+  "tComment (%s)",                  ///< comment ('// .... \n')
+  "tEOF",                           ///< end of file
+  "tIOError",                       ///< I/O error
+  "tInvCharConst",                  ///< invalid character constant
+  "tInvStringConst (%s)",           ///< invalid string constant
+  "tUndefined (%s)",                ///< undefined
+};
+
+
+//------------------------------------------------------------------------------
+// scanning kernels
+//
+// The scanner spends most of its time skipping white space and finding the end
+// of identifiers and numbers. The kernels below do this 16 (SSE2) or 32 (AVX2)
+// bytes at a time; the scalar versions handle the tail of the buffer and targets
+// without SIMD support (or builds with -DSCANNER_NO_SIMD). The AVX2 kernels are
+// selected at run time if the CPU supports them. Comments are skipped with
+// memchr(), which the C library already implements with vector instructions.
+//
+
+/// @brief skip a run of white space (' ', '\t', '\n')
+///
+/// @param p start of the run
+/// @param end end of the buffer
+/// @param lines number of newlines in the run (output)
+/// @param nl position of the last newline in the run (output, valid iff lines > 0)
+/// @retval pointer to the first non-white character (or @a end)
+typedef const char* (*SkipWhiteFn)(const char *p, const char *end,
+                                   int *lines, const char **nl);
+
+/// @brief skip a run of characters of a given class
+///
+/// @param p start of the run
+/// @param end end of the buffer
+/// @retval pointer to the first character not in the class (or @a end)
+typedef const char* (*SkipClassFn)(const char *p, const char *end);
+
+static const char* SkipWhiteScalar(const char *p, const char *end,
+                                   int *lines, const char **nl)
+{
+  while (p < end) {
+    if (*p == '\n') { (*lines)++; *nl = p; }
+    else if ((*p != ' ') && (*p != '\t')) break;
+    p++;
+  }
+  return p;
+}
+
+static const char* SkipIDCharsScalar(const char *p, const char *end)
+{
+  while ((p < end) &&
+         ((((*p | 0x20) >= 'a') && ((*p | 0x20) <= 'z')) ||
+          ((*p >= '0') && (*p <= '9')) || (*p == '_'))) p++;
+  return p;
+}
+
+static const char* SkipDigitsScalar(const char *p, const char *end)
+{
+  while ((p < end) && (*p >= '0') && (*p <= '9')) p++;
+  return p;
+}
+
+#ifdef SCANNER_SIMD
+
+/// @brief mask of bytes in [lo, lo+n) (unsigned range check via signed compare)
+#define IN_RANGE(v, lo, n, set1, add, cmplt)                                   \
+  cmplt(add(v, set1((char)(-128 - (lo)))), set1((char)(-128 + (n))))
+
+/// @brief mask of white-space and newline bytes in a vector
+#define WHITE_MASKS(v, set1, cmpeq, or_, movemask, ws, nlm)                    \
+  {                                                                            \
+    auto n_ = cmpeq(v, set1('\n'));                                            \
+    ws = movemask(or_(or_(cmpeq(v, set1(' ')), cmpeq(v, set1('\t'))), n_));   \
+    nlm = movemask(n_);                                                        \
+  }
+
+/// @brief account for the newlines among the first @a k bytes of a block
+static inline void CountNewlines(const char *p, unsigned int nlm, int k,
+                                 int *lines, const char **nl)
+{
+  if (k < 32) nlm &= (1u << k) - 1;
+  if (nlm != 0) {
+    *lines += __builtin_popcount(nlm);
+    *nl = p + 31 - __builtin_clz(nlm);
+  }
+}
+
+static const char* SkipWhiteSSE2(const char *p, const char *end,
+                                 int *lines, const char **nl)
+{
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    unsigned int ws, nlm;
+    WHITE_MASKS(v, _mm_set1_epi8, _mm_cmpeq_epi8, _mm_or_si128, _mm_movemask_epi8, ws, nlm);
+
+    int k = (ws == 0xffff) ? 16 : __builtin_ctz(~ws);
+    CountNewlines(p, nlm, k, lines, nl);
+    p += k;
+    if (k < 16) return p;
+  }
+  return SkipWhiteScalar(p, end, lines, nl);
+}
+
+static const char* SkipIDCharsSSE2(const char *p, const char *end)
+{
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i l = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i m = _mm_or_si128(
+                  _mm_or_si128(IN_RANGE(l, 'a', 26, _mm_set1_epi8, _mm_add_epi8, _mm_cmplt_epi8),
+                               IN_RANGE(v, '0', 10, _mm_set1_epi8, _mm_add_epi8, _mm_cmplt_epi8)),
+                  _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+    unsigned int mask = _mm_movemask_epi8(m);
+    if (mask != 0xffff) return p + __builtin_ctz(~mask);
+    p += 16;
+  }
+  return SkipIDCharsScalar(p, end);
+}
+
+static const char* SkipDigitsSSE2(const char *p, const char *end)
+{
+  while (end - p >= 16) {
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i m = IN_RANGE(v, '0', 10, _mm_set1_epi8, _mm_add_epi8, _mm_cmplt_epi8);
+    unsigned int mask = _mm_movemask_epi8(m);
+    if (mask != 0xffff) return p + __builtin_ctz(~mask);
+    p += 16;
+  }
+  return SkipDigitsScalar(p, end);
+}
+
+#define AVX2_CMPLT(a, b) _mm256_cmpgt_epi8(b, a)
+
+__attribute__((target("avx2")))
+static const char* SkipWhiteAVX2(const char *p, const char *end,
+                                 int *lines, const char **nl)
+{
+  while (end - p >= 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)p);
+    unsigned int ws, nlm;
+    WHITE_MASKS(v, _mm256_set1_epi8, _mm256_cmpeq_epi8, _mm256_or_si256, _mm256_movemask_epi8,
+                ws, nlm);
+
+    int k = (ws == 0xffffffff) ? 32 : __builtin_ctz(~ws);
+    CountNewlines(p, nlm, k, lines, nl);
+    p += k;
+    if (k < 32) return p;
+  }
+  return SkipWhiteSSE2(p, end, lines, nl);
+}
+
+__attribute__((target("avx2")))
+static const char* SkipIDCharsAVX2(const char *p, const char *end)
+{
+  while (end - p >= 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)p);
+    __m256i l = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i m = _mm256_or_si256(
+                  _mm256_or_si256(IN_RANGE(l, 'a', 26, _mm256_set1_epi8, _mm256_add_epi8, AVX2_CMPLT),
+                                  IN_RANGE(v, '0', 10, _mm256_set1_epi8, _mm256_add_epi8, AVX2_CMPLT)),
+                  _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+    unsigned int mask = _mm256_movemask_epi8(m);
+    if (mask != 0xffffffff) return p + __builtin_ctz(~mask);
+    p += 32;
+  }
+  return SkipIDCharsSSE2(p, end);
+}
+
+__attribute__((target("avx2")))
+static const char* SkipDigitsAVX2(const char *p, const char *end)
+{
+  while (end - p >= 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)p);
+    __m256i m = IN_RANGE(v, '0', 10, _mm256_set1_epi8, _mm256_add_epi8, AVX2_CMPLT);
+    unsigned int mask = _mm256_movemask_epi8(m);
+    if (mask != 0xffffffff) return p + __builtin_ctz(~mask);
+    p += 32;
+  }
+  return SkipDigitsSSE2(p, end);
+}
+
+/// @brief run-time CPU check for AVX2
+static bool HasAVX2(void)
+{
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+static const bool UseAVX2 = HasAVX2();
+static const SkipWhiteFn SkipWhite     = UseAVX2 ? SkipWhiteAVX2   : SkipWhiteSSE2;
+static const SkipClassFn SkipIDChars   = UseAVX2 ? SkipIDCharsAVX2 : SkipIDCharsSSE2;
+static const SkipClassFn SkipDigits    = UseAVX2 ? SkipDigitsAVX2  : SkipDigitsSSE2;
+
+#else
+
+static const SkipWhiteFn SkipWhite     = SkipWhiteScalar;
+static const SkipClassFn SkipIDChars   = SkipIDCharsScalar;
+static const SkipClassFn SkipDigits    = SkipDigitsScalar;
+
+#endif
+
+
+//------------------------------------------------------------------------------
+// CToken
+//
+CToken::CToken()
+{
+  _type = tUndefined;
+  _value = 0;
+  _line = _char = 0;
+}
+
+CToken::CToken(int line, int charpos, EToken type, const string value)
+{
+  _type = type;
+  _value = CInterner::Get()->Intern(((type == tStringConst) || (type == tCharConst)) ?
+                                     escape(type, value) : value);
+  _line = line;
+  _char = charpos;
+}
+
+CToken::CToken(int line, int charpos, EToken type, int valueid)
+{
+  _type = type;
+  _value = valueid;
+  _line = line;
+  _char = charpos;
+}
+
+CToken::CToken(const CToken &token)
+{
+  _type = token.GetType();
+  _value = token.GetValueId();
+  _line = token.GetLineNumber();
+  _char = token.GetCharPosition();
+}
+
+CToken::CToken(const CToken *token)
+{
+  _type = token->GetType();
+  _value = token->GetValueId();
+  _line = token->GetLineNumber();
+  _char = token->GetCharPosition();
+}
+
+const string CToken::Name(EToken type)
+{
+  return string(ETokenName[type]);
+}
+
+const string CToken::GetName(void) const
+{
+  return CToken::Name(GetType());
+}
+
+ostream& CToken::print(ostream &out) const
+{
+  const string &value = GetValue();
+  int str_len = value.length();
+  str_len = TOKEN_STRLEN + (str_len < 128 ? str_len : 128);
+  char *str = (char*)malloc(str_len);
+  snprintf(str, str_len, ETokenStr[GetType()], value.c_str());
+  out << dec << _line << ":" << _char << ": " << str;
+  free(str);
+  return out;
+}
+
+string CToken::escape(EToken type, const string text)
+{
+  const char *t = text.c_str();
+  string s;
+
+  while ((type == tCharConst) || (*t != '\0')) {
+    char c = *t;
+
+    switch (c) {
+      case '\n': s += "\\n";  break;
+      case '\t': s += "\\t";  break;
+      case '\0': s += "\\0";  break;
+      case '\'': if (type == tCharConst) s += "\\'"; else s += c; break;
+      case '\"': if (type == tStringConst) s += "\\\""; else s += c; break;
+      case '\\': s += "\\\\"; break;
+      default :  if ((c <= 0x1f) || (c == 0x7f)) {
+                   char str[5];
+                   snprintf(str, sizeof(str), "\\x%02x", (unsigned char)c);
+                   s += str;
+                 } else {
+                   s += c;
+                 }
+    }
+
+    if (type == tCharConst) break;
+    t++;
+  }
+
+  return s;
+}
+
+string CToken::unescape(const string text)
+{
+  const char *t = text.c_str();
+  char c;
+  string s;
+
+  while (*t != '\0') {
+    if (*t == '\\') {
+      switch (*++t) {
+        case 'n':  s += "\n";  break;
+        case 't':  s += "\t";  break;
+        case '0':  s += "\0";  break;
+        case '\'': s += "'";  break;
+        case '"':  s += "\""; break;
+        case '\\': s += "\\"; break;
+        case 'x':  c = digitValue(*++t)<<4;
+                   c += digitValue(*++t);
+                   s += c;
+                   break;
+        default :  s += '?'; // should never happen
+      }
+    } else {
+      s += *t;
+    }
+    t++;
+  }
+
+  return s;
+}
+
+int CToken::digitValue(char c)
+{
+  c = tolower(c);
+  if ((c >= '0') && (c <= '9')) return c - '0';
+  if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+  return -1;
+}
+
+ostream& operator<<(ostream &out, const CToken &t)
+{
+  return t.print(out);
+}
+
+ostream& operator<<(ostream &out, const CToken *t)
+{
+  return t->print(out);
+}
+
+
+//------------------------------------------------------------------------------
+// CScanner
+//
+// The scanner operates on a contiguous source buffer. The buffer is either a
+// read-only memory mapping of the source file (FromFile()) or a copy of the
+// input stream read in large blocks. The character-level routines emulate the
+// istream semantics of the original, stream-based implementation: peeking or
+// reading past the end of the buffer sets the EOF state, and reading past the
+// end still advances the character position.
+//
+#define BLOCK_SIZE (1 << 20)
+
+/// @brief number of tokens in the ring buffer of the pipelined mode (power of 2)
+#define PIPE_SIZE 4096
+
+/// @brief token ring buffer of the pipelined mode (single producer, single consumer)
+struct SScanPipe {
+  CToken ring[PIPE_SIZE];           ///< ring buffer
+  atomic<size_t> head;              ///< next slot to write (producer)
+  char   pad[64];                   ///< keep head and tail in different cache lines
+  atomic<size_t> tail;              ///< next slot to read (consumer)
+  atomic<bool> stop;                ///< request to stop the producer
+  thread producer;                  ///< scanner thread
+};
+
+CScanner::CScanner(istream *in)
+{
+  _interner = CInterner::Get();
+  _buf = _end = _pos = NULL;
+  _mapped = 0;
+  _eof = false;
+  _ioerror = !in->good();
+
+  if (!_ioerror) ReadStream(in);
+
+  Init();
+}
+
+CScanner::CScanner(string in)
+{
+  _interner = CInterner::Get();
+  _data = in;
+  _buf = _data.data();
+  _end = _buf + _data.size();
+  _mapped = 0;
+  _eof = false;
+  _ioerror = false;
+
+  Init();
+}
+
+CScanner::CScanner(void)
+{
+  _interner = CInterner::Get();
+  _token = _scan = NULL;
+  _pipe = NULL;
+  _stream = NULL;
+  _next = 0;
+  _buf = _end = _pos = NULL;
+  _mapped = 0;
+  _eof = false;
+  _ioerror = false;
+}
+
+CScanner* CScanner::FromFile(const string filename)
+{
+  CScanner *s = new CScanner();
+
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    s->_ioerror = true;
+  } else {
+    struct stat st;
+    void *m = MAP_FAILED;
+
+    if ((fstat(fd, &st) == 0) && S_ISREG(st.st_mode) && (st.st_size > 0)) {
+      m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    if (m != MAP_FAILED) {
+      madvise(m, st.st_size, MADV_SEQUENTIAL);
+      s->_mapped = st.st_size;
+      s->_buf = (const char*)m;
+      s->_end = s->_buf + s->_mapped;
+    } else {
+      s->ReadFile(fd);
+    }
+
+    close(fd);
+  }
+
+  s->Init();
+  return s;
+}
+
+CScanner::~CScanner()
+{
+  if (_pipe != NULL) {
+    _pipe->stop = true;
+    _pipe->producer.join();
+    delete _pipe;
+    _interner->SetConcurrent(false);
+  }
+
+  if (_scan != _token) delete _scan;
+  if (_token != NULL) delete _token;
+  if (_mapped > 0) munmap((void*)_buf, _mapped);
+}
+
+/// @brief match a lexeme against a single keyword candidate
+///
+/// @param str lexeme
+/// @param kw keyword (of the same length as the lexeme)
+/// @param len length of lexeme and keyword
+/// @param type token type of the keyword
+/// @retval type if the lexeme is the keyword, tIdent otherwise
+static inline EToken MatchKeyword(const char *str, const char *kw, size_t len, EToken type)
+{
+  return (memcmp(str, kw, len) == 0) ? type : tIdent;
+}
+
+EToken CScanner::Keyword(const char *str, size_t len)
+{
+  // reserved keywords:
+  //   module procedure function var const integer char boolean begin end
+  //   if then else while do return true false
+  //
+  // the length and the first character single out at most one keyword candidate
+  // (except for "then"/"true", which differ in the second character). A single
+  // compare then decides between the keyword and an identifier.
+  switch (len) {
+    case 2:
+      switch (str[0]) {
+        case 'd': return MatchKeyword(str, "do", 2, tDo);
+        case 'i': return MatchKeyword(str, "if", 2, tIf);
+      }
+      break;
+
+    case 3:
+      switch (str[0]) {
+        case 'e': return MatchKeyword(str, "end", 3, tEnd);
+        case 'v': return MatchKeyword(str, "var", 3, tVarDecl);
+      }
+      break;
+
+    case 4:
+      switch (str[0]) {
+        case 'c': return MatchKeyword(str, "char", 4, tChar);
+        case 'e': return MatchKeyword(str, "else", 4, tElse);
+        case 't':
+          if (str[1] == 'h') return MatchKeyword(str, "then", 4, tThen);
+          else return MatchKeyword(str, "true", 4, tBoolConst);
+      }
+      break;
+
+    case 5:
+      switch (str[0]) {
+        case 'b': return MatchKeyword(str, "begin", 5, tBegin);
+        case 'c': return MatchKeyword(str, "const", 5, tConstDecl);
+        case 'f': return MatchKeyword(str, "false", 5, tBoolConst);
+        case 'w': return MatchKeyword(str, "while", 5, tWhile);
+      }
+      break;
+
+    case 6:
+      switch (str[0]) {
+        case 'm': return MatchKeyword(str, "module", 6, tModule);
+        case 'r': return MatchKeyword(str, "return", 6, tReturn);
+      }
+      break;
+
+    case 7:
+      switch (str[0]) {
+        case 'b': return MatchKeyword(str, "boolean", 7, tBoolean);
+        case 'i': return MatchKeyword(str, "integer", 7, tInteger);
+      }
+      break;
+
+    case 8:
+      return MatchKeyword(str, "function", 8, tFunction);
+
+    case 9:
+      return MatchKeyword(str, "procedure", 9, tProcedure);
+  }
+
+  return tIdent;
+}
+
+void CScanner::Init(void)
+{
+  _pos = _buf;
+  _line = 1;
+  _char = 1;
+  _good = InputGood();
+  _token = _scan = new CToken();
+  _tokstart = _pos;
+  _stream = NULL;
+  _next = 0;
+  _pipe = NULL;
+
+  NextToken();
+}
+
+void CScanner::ReadStream(istream *in)
+{
+  streambuf *sb = in->rdbuf();
+  size_t len = 0;
+  streamsize n;
+
+  do {
+    _data.resize(len + BLOCK_SIZE);
+    n = sb->sgetn(&_data[len], BLOCK_SIZE);
+    len += n;
+  } while (n == BLOCK_SIZE);
+
+  _data.resize(len);
+  _buf = _data.data();
+  _end = _buf + len;
+}
+
+void CScanner::ReadFile(int fd)
+{
+  size_t len = 0;
+  ssize_t n;
+
+  do {
+    _data.resize(len + BLOCK_SIZE);
+    n = read(fd, &_data[len], BLOCK_SIZE);
+    if (n < 0) {
+      _ioerror = true;
+      n = 0;
+    }
+    len += n;
+  } while (n > 0);
+
+  _data.resize(len);
+  _buf = _data.data();
+  _end = _buf + len;
+}
+
+CToken CScanner::Get()
+{
+  CToken result(_token);
+
+  EToken type = _token->GetType();
+  _good = !(type == tIOError);
+
+  NextToken();
+  return result;
+}
+
+CToken CScanner::Peek() const
+{
+  return CToken(_token);
+}
+
+void CScanner::NextToken()
+{
+  if (_pipe != NULL) {
+    // pipelined: take the next token from the ring; the last token (tEOF or
+    // tIOError) is returned repeatedly
+    EToken type = _token->GetType();
+    if ((type == tEOF) || (type == tIOError)) return;
+
+    size_t tail = _pipe->tail.load(memory_order_relaxed);
+    while (_pipe->head.load(memory_order_acquire) == tail) this_thread::yield();
+
+    *_token = _pipe->ring[tail & (PIPE_SIZE-1)];
+    _pipe->tail.store(tail + 1, memory_order_release);
+    return;
+  }
+
+  if (_stream != NULL) {
+    // pre-scanned tokens; the last token (tEOF) is returned repeatedly
+    if (_next < _stream->size()) *_token = (*_stream)[_next++];
+    return;
+  }
+
+  _token = Scan();
+}
+
+//------------------------------------------------------------------------------
+// parallel scanning
+//
+
+/// @brief minimal chunk size for parallel scanning
+#define MIN_CHUNK_SIZE (256*1024)
+
+/// @brief chunk of the source buffer lexed by one worker
+struct SScanChunk {
+  const char *begin;                ///< start of chunk (at a line start)
+  const char *end;                  ///< end of chunk (after a newline or end of buffer)
+  bool        last;                 ///< last chunk (owns tEOF)
+  CScanner   *scanner;              ///< worker scanner (with local interner)
+  vector<CToken> tokens;            ///< tokens starting in this chunk
+  int         newlines;             ///< number of newlines in [begin, end)
+  int         line_base;            ///< line number corresponding to line 1 of the worker
+  const char *first;                ///< start of the first token seen by the worker
+  const char *stop;                 ///< start of the first token not owned by this chunk
+  const char *resume_pos;           ///< scanner state before that token (position)
+  int         resume_line;          ///< scanner state before that token (line)
+  int         resume_char;          ///< scanner state before that token (character pos)
+};
+
+void CScanner::ScanChunk(SScanChunk *chunk)
+{
+  chunk->tokens.clear();
+  chunk->first = chunk->stop = NULL;
+
+  while (true) {
+    const char *pos = _pos;
+    int line = _line, charpos = _char;
+
+    CToken *t = Scan();
+    if (chunk->first == NULL) chunk->first = _tokstart;
+
+    if (!chunk->last && (_tokstart >= chunk->end)) {
+      chunk->stop = _tokstart;
+      chunk->resume_pos = pos;
+      chunk->resume_line = line;
+      chunk->resume_char = charpos;
+      break;
+    }
+
+    chunk->tokens.push_back(*t);
+    if ((t->GetType() == tEOF) || (t->GetType() == tIOError)) break;
+  }
+}
+
+/// @brief worker: translate interned ids and line numbers to the global ones and store the
+///        tokens in the token buffer
+static void RelocateChunk(SScanChunk *chunk, const vector<int> *remap, CToken *out)
+{
+  for (size_t i=0; i<chunk->tokens.size(); i++) {
+    const CToken &t = chunk->tokens[i];
+    out[i] = CToken(t.GetLineNumber() + chunk->line_base - 1, t.GetCharPosition(), t.GetType(),
+                    (*remap)[t.GetValueId()]);
+  }
+}
+
+void CScanner::ScanParallel(unsigned int nthreads)
+{
+  size_t size = _end - _buf;
+
+  if ((nthreads <= 1) || (_ioerror) || (size < 2*MIN_CHUNK_SIZE)) return;
+  if (size / nthreads < MIN_CHUNK_SIZE) nthreads = size / MIN_CHUNK_SIZE;
+
+  // split the buffer into chunks that start at line boundaries
+  vector<SScanChunk> chunks;
+  const char *begin = _buf;
+  for (unsigned int i=0; (i<nthreads) && (begin < _end); i++) {
+    const char *end = _end;
+    if (i+1 < nthreads) {
+      end = _buf + size/nthreads*(i+1);
+      if (end < begin) end = begin;
+      end = (const char*)memchr(end, '\n', _end - end);
+      end = (end == NULL) ? _end : end + 1;
+    }
+
+    SScanChunk c;
+    c.begin = begin;
+    c.end = end;
+    c.last = (end == _end);
+
+    CScanner *w = new CScanner();
+    w->_interner = new CInterner();
+    w->_buf = _buf;
+    w->_end = _end;
+    w->_pos = begin;
+    w->_line = w->_char = 1;
+    w->_token = w->_scan = new CToken();
+    c.scanner = w;
+
+    chunks.push_back(c);
+    begin = end;
+  }
+
+  // lex all chunks concurrently and count their newlines
+  auto LexChunk = [](SScanChunk *chunk) {
+    int n = 0;
+    const char *p = chunk->begin;
+    while ((p = (const char*)memchr(p, '\n', chunk->end - p)) != NULL) { n++; p++; }
+    chunk->newlines = n;
+
+    chunk->scanner->ScanChunk(chunk);
+  };
+
+  vector<thread> workers;
+  for (size_t i=1; i<chunks.size(); i++) workers.push_back(thread(LexChunk, &chunks[i]));
+  LexChunk(&chunks[0]);
+  for (size_t i=0; i<workers.size(); i++) workers[i].join();
+
+  // resolve: the scan of chunk i+1 is valid iff it synchronizes with the scan of chunk i, i.e.,
+  // the first token seen by chunk i+1 starts where chunk i stopped. Otherwise (chunk i+1 starts
+  // inside a token of chunk i, e.g., a string or character literal) re-lex chunk i+1 starting
+  // from the state of chunk i
+  int line = 1;
+  for (size_t i=0; i<chunks.size(); i++) {
+    chunks[i].line_base = line;
+    line += chunks[i].newlines;
+  }
+
+  for (size_t i=0; i+1<chunks.size(); i++) {
+    SScanChunk &c = chunks[i], &n = chunks[i+1];
+
+    if (n.first != c.stop) {
+      CScanner *w = n.scanner;
+      w->_pos = c.resume_pos;
+      w->_line = c.resume_line;
+      w->_char = c.resume_char;
+      w->_eof = false;
+      w->ScanChunk(&n);
+      n.line_base = c.line_base;
+    }
+  }
+
+  // merge local interners into the global one and relocate the tokens
+  vector<vector<int> > remap(chunks.size());
+  for (size_t i=0; i<chunks.size(); i++) {
+    CInterner *in = chunks[i].scanner->_interner;
+    remap[i].resize(in->GetSize());
+    for (size_t id=0; id<in->GetSize(); id++) remap[i][id] = _interner->Intern(in->GetString(id));
+  }
+
+  vector<size_t> offset(chunks.size() + 1, 0);
+  for (size_t i=0; i<chunks.size(); i++) offset[i+1] = offset[i] + chunks[i].tokens.size();
+  _tokens.resize(offset[chunks.size()]);
+
+  workers.clear();
+  for (size_t i=1; i<chunks.size(); i++) {
+    workers.push_back(thread(RelocateChunk, &chunks[i], &remap[i], &_tokens[offset[i]]));
+  }
+  RelocateChunk(&chunks[0], &remap[0], &_tokens[0]);
+  for (size_t i=0; i<workers.size(); i++) workers[i].join();
+
+  for (size_t i=0; i<chunks.size(); i++) {
+    delete chunks[i].scanner->_interner;
+    delete chunks[i].scanner;
+  }
+
+  _pos = _end;
+  _eof = true;
+  _stream = &_tokens;
+  _next = 0;
+  NextToken();
+}
+
+//------------------------------------------------------------------------------
+// pre-scanned token stream
+//
+bool CScanner::Prescan(void)
+{
+  if (_stream != NULL) return true;
+  if (_pipe != NULL) return false;
+
+  // the current token becomes the first token of the stream. Scan() reuses the
+  // token instance, so the current token is restored afterwards
+  CToken first = *_token;
+  _tokens.push_back(first);
+
+  EToken type = first.GetType();
+  while ((type != tEOF) && (type != tIOError)) {
+    CToken *t = Scan();
+    _tokens.push_back(*t);
+    type = t->GetType();
+  }
+
+  *_token = first;
+  _stream = &_tokens;
+  _next = 1;
+
+  return true;
+}
+
+void CScanner::SetTokenIndex(size_t index)
+{
+  assert((_stream != NULL) && (index < _stream->size()));
+
+  _next = index;
+  NextToken();
+}
+
+CScanner* CScanner::Fork(size_t index) const
+{
+  assert(_stream != NULL);
+
+  CScanner *s = new CScanner();
+  s->_interner = _interner;
+  s->_line = s->_char = 1;
+  s->_good = true;
+  s->_token = s->_scan = new CToken();
+  s->_stream = _stream;
+  s->SetTokenIndex(index);
+
+  return s;
+}
+
+//------------------------------------------------------------------------------
+// pipelined scanning
+//
+void CScanner::Pipeline(void)
+{
+  EToken type = _token->GetType();
+
+  if ((_pipe != NULL) || (_stream != NULL)) return;
+  if ((type == tEOF) || (type == tIOError)) return;
+
+  // the parser interns symbol names while the scanner thread interns tokens
+  _interner->SetConcurrent(true);
+
+  // the current token has already been scanned; the scanner thread continues
+  // from there with its own token instance
+  _scan = new CToken();
+  _pipe = new SScanPipe();
+  _pipe->head = 0;
+  _pipe->tail = 0;
+  _pipe->stop = false;
+  _pipe->producer = thread(&CScanner::Produce, this);
+}
+
+void CScanner::Produce(void)
+{
+  size_t head = _pipe->head.load(memory_order_relaxed);
+
+  while (!_pipe->stop.load(memory_order_relaxed)) {
+    CToken *t = Scan();
+
+    // wait for a free slot
+    while (head - _pipe->tail.load(memory_order_acquire) == PIPE_SIZE) {
+      if (_pipe->stop.load(memory_order_relaxed)) return;
+      this_thread::yield();
+    }
+
+    _pipe->ring[head & (PIPE_SIZE-1)] = *t;
+    _pipe->head.store(++head, memory_order_release);
+
+    if ((t->GetType() == tEOF) || (t->GetType() == tIOError)) break;
+  }
+}
+
+void CScanner::RecordStreamPosition()
+{
+  _saved_line = _line;
+  _saved_char = _char;
+}
+
+void CScanner::GetRecordedStreamPosition(int *lineno, int *charpos)
+{
+  *lineno = _saved_line;
+  *charpos = _saved_char;
+}
+
+CToken* CScanner::NewToken(EToken type, const string token)
+{
+  int id = _interner->Intern(((type == tStringConst) || (type == tCharConst)) ?
+                             CToken::escape(type, token) : token);
+  *_scan = CToken(_saved_line, _saved_char, type, id);
+  return _scan;
+}
+
+CToken* CScanner::NewToken(EToken type, int tokenid)
+{
+  *_scan = CToken(_saved_line, _saved_char, type, tokenid);
+  return _scan;
+}
+
+CToken* CScanner::Scan()
+{
+  EToken token;
+  string tokval;
+  unsigned char c;
+  ECharacter res;
+  const char *p;
+
+  do {
+    // skip white space
+    if (InputGood()) {
+      int lines = 0;
+      const char *nl = NULL;
+
+      p = SkipWhite(_pos, _end, &lines, &nl);
+      if (lines > 0) {
+        _line += lines;
+        _char = 1 + (p - (nl + 1));
+      } else {
+        _char += p - _pos;
+      }
+      _pos = p;
+      if (_pos == _end) _eof = true;
+    }
+
+    _tokstart = _pos;
+    RecordStreamPosition();
+
+    if (_eof) return NewToken(tEOF);
+    if (!InputGood()) return NewToken(tIOError);
+
+    c = GetChar();
+    tokval = c;
+    token = tUndefined;
+
+    switch (c) {
+      case ':':
+        if (PeekChar() == '=') {
+          tokval += GetChar();
+          token = tAssign;
+        } else {
+          token = tColon;
+        }
+        break;
+
+      case '+':
+      case '-':
+        token = tPlusMinus;
+        break;
+
+      case '*':
+        token = tMulDiv;
+        break;
+
+      case '/':
+        if (PeekChar() == '/') {
+          // skip to the end of the line; the comment itself is not returned
+          _pos++;
+          p = (const char*)memchr(_pos, '\n', _end - _pos);
+          if (p == NULL) p = _end;
+          _char += p - _pos + 1;
+          _pos = p;
+          if (_pos == _end) {
+            // the original stream-based loop reads once past the end
+            _eof = true;
+            _char++;
+          }
+          token = tComment;
+        } else {
+          token = tMulDiv;
+        }
+        break;
+
+      case '|':
+        if (PeekChar() == '|') {
+          tokval += GetChar();
+          token = tOr;
+        }
+        break;
+
+      case '&':
+        if (PeekChar() == '&') {
+          tokval += GetChar();
+          token = tAnd;
+        }
+        break;
+
+      case '!':
+        token = tNot;
+        break;
+
+      case '<':
+      case '>':
+        if (PeekChar() == '=') {
+          tokval += GetChar();
+        }
+        token = tRelOp;
+        break;
+
+      case '=':
+      case '#':
+        token = tRelOp;
+        break;
+
+      case ',':
+        token = tComma;
+        break;
+
+      case ';':
+        token = tSemicolon;
+        break;
+
+      case '.':
+        token = tDot;
+        break;
+
+      case '(':
+        token = tLParens;
+        break;
+
+      case ')':
+        token = tRParens;
+        break;
+
+      case '[':
+        token = tLBrak;
+        break;
+
+      case ']':
+        token = tRBrak;
+        break;
+
+      case '\'':
+        token = tInvCharConst;
+        if (PeekChar() == '\'') {
+          GetChar();
+          tokval = "Empty character constants are not allowed.";
+        } else {
+          res = GetCharacter(c, tCharConst);
+          if ((res == cOkay) && (PeekChar() != '\'')) {
+            tokval = "Character constant not closed.";
+          } else {
+            switch (res) {
+              case cOkay:    GetChar(); token = tCharConst; tokval = c; break;
+              case cInvChar: tokval = "Invalid character constant."; break;
+              case cInvEnc:  tokval = "Invalid escape character."; break;
+              case cEOF:     token = tEOF; break;
+              case cIOError: token = tIOError; break;
+            }
+          }
+        }
+        break;
+
+      case '"':
+        token = tInvStringConst;
+        tokval = "";
+        res = cOkay;
+        while (PeekChar() != '"') {
+          if (_eof) break;
+          res = GetCharacter(c, tStringConst);
+          if (res != cOkay) break;
+          tokval += c;
+        }
+
+        if (_eof && (res == cOkay)) {
+          tokval = "String constant not closed.";
+        } else {
+          switch (res) {
+            case cOkay:    GetChar(); token = tStringConst; break;
+            case cInvChar: tokval = "Invalid character in string."; break;
+            case cInvEnc:  tokval = "Invalid escape character in string."; break;
+            case cEOF:     token = tEOF; break;
+            case cIOError: token = tIOError; break;
+          }
+        }
+        break;
+
+      default:
+        if (IsAlpha(c) || IsNum(c)) {
+          // identifiers and numbers are scanned in one go over the buffer and interned
+          // directly from there without building a temporary string
+          bool ident = IsAlpha(c);
+          const char *start = _pos - 1;
+          p = ident ? SkipIDChars(_pos, _end) : SkipDigits(_pos, _end);
+          int id = _interner->Intern(start, p - start);
+          token = ident ? Keyword(start, p - start) : tNumber;
+          _char += p - _pos;
+          _pos = p;
+          if (_pos == _end) _eof = true;
+
+          return NewToken(token, id);
+        } else {
+          tokval = "invalid character '";
+          tokval += c;
+          tokval += "'";
+        }
+        break;
+    }
+  } while (token == tComment);
+
+  return NewToken(token, tokval);
+}
+
+CScanner::ECharacter CScanner::GetCharacter(unsigned char &c, EToken mode)
+{
+  ECharacter res = cOkay;
+  int v, d;
+
+  c = PeekChar();
+  if (c == '\\') {
+    c = GetChar();
+    if (_eof) return cEOF;
+    if (!InputGood()) return cIOError;
+
+    switch (PeekChar()) {
+      case 'n':  c = '\n'; break;
+      case 't':  c = '\t'; break;
+      case '0':  if (mode == tCharConst) c = '\0';
+                 else res = cInvEnc; // '\0' not allowed in strings
+                 break;
+      case '\'': c = '\''; break;
+      case '"':  c = '"'; break;
+      case '\\': c = '\\'; break;
+      case 'x':  v = 0;
+                 for (int i=0; i<2; i++) {
+                   GetChar();
+                   d = CToken::digitValue(PeekChar());
+                   if (d == -1) break;
+                   v = v*16 + d;
+                 }
+                 c = v;
+                 if (d == -1) res = cInvChar;
+                 else if ((mode != tCharConst) && (v == 0)) res = cInvEnc;
+                 break;
+      default:   res = cInvEnc;
+    }
+  } else if ((c < ' ') || (c == 0x7f)) {
+    res = cInvChar;
+  }
+
+  if (res != cOkay) RecordStreamPosition();
+  GetChar();
+
+  return res;
+}
+
+unsigned char CScanner::PeekChar()
+{
+  if (_pos == _end) {
+    _eof = true;
+    return (unsigned char)EOF;
+  }
+
+  return *_pos;
+}
+
+unsigned char CScanner::GetChar()
+{
+  unsigned char c;
+
+  if (_pos == _end) {
+    _eof = true;
+    c = (unsigned char)EOF;
+  } else {
+    c = *_pos++;
+  }
+
+  if (c == '\n') { _line++; _char = 1; }
+  else _char++;
+
+  return c;
+}
+
+string CScanner::GetChar(int n)
+{
+  string str;
+  for (int i=0; i<n; i++) str += GetChar();
+  return str;
+}
+
+bool CScanner::IsWhite(unsigned char c)
+{
+  return ((c == ' ') || (c == '\t') || (c == '\n'));
+}
+
+bool CScanner::IsAlpha(unsigned char c)
+{
+  return (((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) ||
+          (c == '_'));
+}
+
+bool CScanner::IsNum(unsigned char c)
+{
+  return ((c >= '0') && (c <= '9'));
+}
+
+bool CScanner::IsHexDigit(unsigned char c)
+{
+  return (((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'f')) ||
+          ((c >= 'A') && (c <= 'F')));
+}
+
+bool CScanner::IsIDChar(unsigned char c)
+{
+  return (IsAlpha(c) || IsNum(c));
+}
@@ -41,9 +41,15 @@
 #include <ostream>
 #include <iomanip>
 #include <map>
+#include <vector>
+
+#include "intern.h"
 
 using namespace std;
 
+struct SScanChunk;
+struct SScanPipe;
+
 //------------------------------------------------------------------------------
 /// @brief SnuPL/1 token type
 ///
@@ -123,6 +129,14 @@ class CToken {
     /// @param value token value
     CToken(int line, int charpos, EToken type, const string value="");
 
+    /// @brief constructor taking an already interned (and escaped) value
+    ///
+    /// @param line line number in the input stream
+    /// @param charpos character position in the input stream
+    /// @param type token type
+    /// @param valueid interned token value
+    CToken(int line, int charpos, EToken type, int valueid);
+
     /// @brief copy contructor
     ///
     /// @param token token to copy
@@ -155,7 +169,14 @@ class CToken {
     /// @brief return the token value of this instance
     ///
     /// @retval token value
-    string GetValue(void) const { return _value; };
+    const string& GetValue(void) const { return CInterner::Get()->GetString(_value); };
+
+    /// @brief return the interned id of the token value of this instance
+    ///
+    /// Two tokens have the same value iff their value ids are equal.
+    ///
+    /// @retval token value id
+    int GetValueId(void) const { return _value; };
 
     /// @}
 
@@ -206,7 +227,7 @@ class CToken {
 
   private:
     EToken _type;                   ///< token type
-    string _value;                  ///< token value
+    int    _value;                  ///< token value (interned id)
     int    _line;                   ///< input stream position (line)
     int    _char;                   ///< input stream position (character pos)
 };
@@ -251,11 +272,82 @@ class CScanner {
     /// @param in input stream containing the source code
     CScanner(string in);
 
+    /// @brief create a scanner operating directly on a memory-mapped file
+    ///
+    /// Falls back to block-wise reading if the file cannot be mapped. If the
+    /// file cannot be opened, the scanner's state is not Good().
+    ///
+    /// @param filename name of the source file
+    /// @retval CScanner instance
+    static CScanner* FromFile(const string filename);
+
     /// @brief destructor
     ~CScanner();
 
     /// @}
 
+    /// @brief lex the entire input on several threads
+    ///
+    /// Splits the source buffer into chunks at line boundaries, lexes the
+    /// chunks concurrently and stitches the per-chunk token vectors together.
+    /// Get() and Peek() then return the exact same token sequence as in
+    /// serial mode. Must be called before the first call to Get(). Inputs
+    /// that are too small to benefit are lexed serially.
+    ///
+    /// @param nthreads number of threads (<= 1: serial scanning)
+    void ScanParallel(unsigned int nthreads);
+
+    /// @brief run the scanner in its own thread
+    ///
+    /// A scanner thread lexes ahead into a bounded single-producer/single-
+    /// consumer ring buffer of tokens from which Get() and Peek() are served,
+    /// so lexing overlaps with the consumer (parser). Must be called before
+    /// the first call to Get(). While the pipeline is active,
+    /// GetLineNumber() and GetCharPosition() are not meaningful.
+    void Pipeline(void);
+
+    /// @name pre-scanned token stream
+    /// @{
+
+    /// @brief lex the rest of the input into a token buffer
+    ///
+    /// Provides random access to the token stream (GetToken(), SetTokenIndex(),
+    /// Fork()). Does nothing if the input has already been lexed by
+    /// ScanParallel(). Not available in pipelined mode.
+    ///
+    /// @retval true if the token stream is pre-scanned
+    /// @retval false otherwise (pipelined mode)
+    bool Prescan(void);
+
+    /// @brief return the number of tokens in the pre-scanned token stream
+    size_t GetTokenCount(void) const { return _stream->size(); };
+
+    /// @brief return the index of the next token (see Peek()) in the pre-scanned token stream
+    size_t GetTokenIndex(void) const { return _next - 1; };
+
+    /// @brief return a token of the pre-scanned token stream
+    ///
+    /// @param index token index
+    /// @retval token token
+    const CToken& GetToken(size_t index) const { return (*_stream)[index]; };
+
+    /// @brief continue scanning at a given index of the pre-scanned token stream
+    ///
+    /// @param index index of the next token
+    void SetTokenIndex(size_t index);
+
+    /// @brief create a scanner reading the same pre-scanned token stream
+    ///
+    /// The new scanner has its own position and can be used concurrently with
+    /// this one (e.g., by a parser on a worker thread). It must be deleted
+    /// before this scanner.
+    ///
+    /// @param index index of the next token of the new scanner
+    /// @retval CScanner instance
+    CScanner* Fork(size_t index) const;
+
+    /// @}
+
     /// @brief return and remove the next token from the input stream
     ///
     /// @retval token token
@@ -282,6 +374,14 @@ class CScanner {
     /// @retval character position
     int GetCharPosition() const { return _char; };
 
+    /// @brief classify an identifier-shaped lexeme
+    ///
+    /// @param str pointer to the first character of the lexeme
+    /// @param len length of the lexeme
+    /// @retval EToken keyword token if the lexeme is a reserved keyword
+    /// @retval tIdent otherwise
+    static EToken Keyword(const char *str, size_t len);
+
   private:
     /// @brief result type for the GetCharacter() method
     enum ECharacter {
@@ -292,12 +392,43 @@ class CScanner {
       cIOError,                     ///< input stream error
     };
 
-    /// @brief initialize list of reserved keywords
-    void InitKeywords(void);
+    /// @brief constructor for FromFile()
+    CScanner(void);
+
+    /// @brief initialize the scanner state and scan the first token
+    void Init(void);
+
+    /// @brief read the entire input stream into the source buffer
+    ///
+    /// @param in input stream
+    void ReadStream(istream *in);
+
+    /// @brief read the entire file into the source buffer
+    ///
+    /// @param fd file descriptor
+    void ReadFile(int fd);
+
+    /// @brief check the state of the source buffer (cf. istream::good())
+    ///
+    /// @retval true if no read past the end and no I/O error has occurred
+    /// @retval false otherwise
+    bool InputGood(void) const { return !_eof && !_ioerror; };
 
     /// @brief scan the next token
     void NextToken(void);
 
+    /// @brief scanner thread of the pipelined mode (see Pipeline())
+    void Produce(void);
+
+    /// @brief lex one chunk of the source buffer (worker of ScanParallel())
+    ///
+    /// Scans from the current position and collects all tokens that start
+    /// before the end of the chunk. The state before the first token that
+    /// belongs to the next chunk is recorded in @a chunk.
+    ///
+    /// @param chunk chunk descriptor
+    void ScanChunk(SScanChunk *chunk);
+
     /// @brief store the current position of the input stream internally
     void RecordStreamPosition(void);
 
@@ -307,13 +438,23 @@ class CScanner {
     /// @param charpos character position
     void GetRecordedStreamPosition(int *lineno, int *charpos);
 
-    /// @brief create and return a new token
+    /// @brief set and return the current token
+    ///
+    /// Tokens only hold an interned value id, the scanner thus reuses its token instance instead
+    /// of allocating a new one for every token.
     ///
     /// @param type token type
     /// @param token  token value
     /// @retval CToken instance
     CToken* NewToken(EToken type, const string token="");
 
+    /// @brief set and return the current token with an interned value
+    ///
+    /// @param type token type
+    /// @param tokenid interned token value
+    /// @retval CToken instance
+    CToken* NewToken(EToken type, int tokenid);
+
 
     /// @name low-level scanner routines
     /// @{
@@ -385,15 +526,27 @@ class CScanner {
 
 
   private:
-    static map<string, EToken> keywords;///< reserved keywords with corr. tokens
-    istream *_in;                   ///< input stream
-    bool    _delete_in;             ///< delete input stream upon destruction
+    string  _data;                  ///< source buffer (if not memory-mapped)
+    const char *_buf;               ///< start of source buffer
+    const char *_end;               ///< end of source buffer
+    const char *_pos;               ///< current read position
+    size_t  _mapped;                ///< size of memory mapping (0: not mapped)
+    bool    _eof;                   ///< read past the end of the source buffer
+    bool    _ioerror;               ///< source could not be read
     bool    _good;                  ///< scanner status flag
     int     _line;                  ///< current stream position (line)
     int     _char;                  ///< current stream position (character pos)
     int     _saved_line;            ///< saved stream position (line)
     int     _saved_char;            ///< saved stream position (character pos)
     CToken *_token;                 ///< next token in input stream
+    CToken *_scan;                  ///< token being scanned (== _token unless pipelined)
+    const char *_tokstart;          ///< start of the last scanned token
+    CInterner *_interner;           ///< interner for token values
+
+    vector<CToken> _tokens;         ///< pre-scanned tokens (ScanParallel(), Prescan())
+    const vector<CToken> *_stream;  ///< pre-scanned token stream (NULL: scan on demand)
+    size_t  _next;                  ///< index of the token following the current token
+    SScanPipe *_pipe;               ///< token ring buffer (Pipeline())
 };
 
 
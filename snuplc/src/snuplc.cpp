@@ -42,6 +42,8 @@
 #include "scanner.h"
 #include "parser.h"
 #include "ir.h"
+#include "cfg.h"
+#include "pass.h"
 #include "backend.h"
 using namespace std;
 
@@ -159,10 +161,62 @@ void DumpTAC(string file, CModule *m)
       dot.flush();
 
       RunDOT(fn);
+
+      // control flow graphs with dominator tree and loops
+      fn = file + ".cfg.dot";
+      ofstream cfg(fn);
+
+      cfg << "digraph CFG {" << endl
+          << "  graph [fontname=\"Times New Roman\",fontsize=10];" << endl
+          << "  node  [fontname=\"Courier New\",fontsize=10];" << endl
+          << "  edge  [fontname=\"Times New Roman\",fontsize=10];" << endl
+          << endl;
+      CCfg(m->GetCodeBlock()).toDot(cfg, 2);
+      for (size_t p=0; p<proc.size(); p++) {
+        CCfg(proc[p]->GetCodeBlock()).toDot(cfg, 2);
+      }
+      cfg << "}" << endl;
+      cfg.flush();
+
+      RunDOT(fn);
     }
   }
 }
 
+void Optimize(string file, CModule *m)
+{
+  CEnvironment *env = CEnvironment::Get();
+
+  string level;
+  if (!env->GetSetting("opt-level", level)) level = "0";
+
+  CPassManager pm;
+  pm.AddPasses(atoi(level.c_str()));
+
+  // output the IR after each run of the selected pass
+  string pass;
+  ofstream *dump = NULL;
+  if (env->GetSetting("dump-after", pass) && (pass != "")) {
+    if (pm.HasPass(pass)) {
+      dump = new ofstream(file + "." + pass + ".tac");
+      *dump << file << ":" << endl;
+      pm.DumpAfter(pass, dump);
+    } else {
+      cout << "  pass '" << pass << "' is not run at -O" << level << "." << endl;
+    }
+  }
+
+  pm.Run(m);
+
+  bool b;
+  if (env->GetFlag("time-passes", b) && b) {
+    cout << "  IR passes at -O" << level << ":" << endl;
+    pm.PrintTimings(cout, 4);
+  }
+
+  delete dump;
+}
+
 int main(int argc, char *argv[])
 {
   CEnvironment *env = CEnvironment::Get();
@@ -183,38 +237,72 @@ int main(int argc, char *argv[])
     //
     // scanning, parsing
     //
-    CScanner *s = new CScanner(new ifstream(file));
+    CScanner *s = CScanner::FromFile(file);
+
+    string lex_threads;
+    if (env->GetSetting("lex-threads", lex_threads)) {
+      s->ScanParallel(atoi(lex_threads.c_str()));
+    }
+
+    bool pipeline;
+    if (env->GetFlag("pipeline", pipeline) && pipeline) s->Pipeline();
+
     CParser *p = new CParser(s);
 
+    string parse_threads;
+    if (env->GetSetting("parse-threads", parse_threads)) {
+      p->ParseParallel(atoi(parse_threads.c_str()));
+    }
+
     cout << "compiling " << file << "..." << endl;
-    CAstNode *ast = p->Parse();
+
+    // single-pass mode: type checking and TAC generation while parsing, no AST
+    bool single;
+    if (!env->GetFlag("single-pass", single)) single = false;
+
+    CModule *tac = NULL;
+    CAstNode *ast = single ? p->Compile(&tac) : p->Parse();
 
     if (p->HasError()) {
       const CToken *error = p->GetErrorToken();
-      cout << "syntax error at " << error->GetLineNumber() << ":"
+      cout << (p->IsSemanticError() ? "semantic" : "syntax") << " error at "
+           << error->GetLineNumber() << ":"
            << error->GetCharPosition() << " : "
            << p->GetErrorMessage() << endl;
     } else {
       CAstModule *m = dynamic_cast<CAstModule*>(ast);
       assert(m != NULL);
 
-      //
-      // semantic analysis
-      //
-      CToken t;
-      string msg;
-      if (!m->TypeCheck(&t, &msg)) {
-        cout << "semantic error at " << t.GetLineNumber() << ":"
-          << t.GetCharPosition() << " : " << msg << endl;
-      } else {
-        DumpAST(file, m);
+      CAstFlat *flat = NULL;
+      if (tac == NULL) {
+        //
+        // semantic analysis
+        //
+        bool flatten;
+        if (env->GetFlag("flat-ast", flatten) && flatten) flat = p->Flatten();
+
+        CToken t;
+        string msg;
+        if (!(flat != NULL ? flat->TypeCheck(&t, &msg) : m->TypeCheck(&t, &msg))) {
+          cout << "semantic error at " << t.GetLineNumber() << ":"
+            << t.GetCharPosition() << " : " << msg << endl;
+        } else {
+          DumpAST(file, m);
+
+          //
+          // AST to TAC conversion
+          //
+          tac = new CModule(ast, flat);
+        }
+      }
 
+      if (tac != NULL) {
         //
-        // AST to TAC conversion
+        // optimization
         //
-        CModule *m = new CModule(ast);
+        Optimize(file, tac);
 
-        DumpTAC(file, m);
+        DumpTAC(file, tac);
 
         // output assembly to console or file
         ostream *out = &cout;
@@ -236,7 +324,7 @@ int main(int argc, char *argv[])
           return EXIT_FAILURE;
         }
 
-        be->Emit(m);
+        be->Emit(tac);
 
         if (sout != NULL) {
           sout->flush();
@@ -250,8 +338,10 @@ int main(int argc, char *argv[])
         }
 
         delete be;
+        delete tac;
       }
 
+      delete flat;
       delete m;
     }
 
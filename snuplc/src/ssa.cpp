@@ -0,0 +1,667 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL static single assignment form
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <cassert>
+#include <unordered_map>
+#include <vector>
+
+#include "cfg.h"
+#include "ssa.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// SSA construction
+//
+
+/// @brief variable renamed by the SSA construction
+struct SVariable {
+  CTacTemp *temp;                   ///< temporary (NULL for symbols)
+  const CSymbol *symbol;            ///< local variable or parameter (NULL for temporaries)
+  const CType *type;                ///< data type
+  bool excluded;                    ///< not renamed (references, address taken)
+  bool reused;                      ///< the temporary has been used as the first version
+  vector<CBasicBlock*> defs;        ///< blocks defining the variable
+  vector<CBasicBlock*> uses;        ///< blocks using the variable before defining it
+  vector<CTacAddr*> stack;          ///< current versions during renaming (innermost last)
+};
+
+/// @brief SSA construction of a code block (Cytron et al., pruned by liveness)
+class CSSAConstruction {
+  public:
+    /// @param cb code block
+    CSSAConstruction(CCodeBlock *cb);
+
+    /// @brief convert the code block into SSA form
+    void Run(void);
+
+  private:
+    /// @brief return the variable of address @a a, or -1 if @a a is not renamed
+    int GetVar(const CTacAddr *a) const;
+
+    /// @brief enter the temporaries and symbols of the code block into the list of variables
+    void FindVars(void);
+
+    /// @brief collect the defining and (upward-exposed) using blocks of every variable
+    void CollectDefsUses(void);
+
+    /// @brief compute the dominance frontiers of all reachable blocks
+    void ComputeFrontiers(void);
+
+    /// @brief place phi functions where variables are live and definitions merge
+    void PlacePhis(void);
+
+    /// @brief insert a phi function for variable @a v at the start of block @a b
+    void InsertPhi(CBasicBlock *b, int v);
+
+    /// @brief return the label at the start of block @a b, inserting one if necessary
+    CTacLabel* GetLabel(CBasicBlock *b);
+
+    /// @brief rename definitions and uses in a preorder walk of the dominator tree
+    void Rename(void);
+
+    /// @brief rename the instructions of block @a b and the phi arguments of its successors
+    void RenameBlock(CBasicBlock *b);
+
+    /// @brief create a new version of variable @a v and make it current
+    CTacAddr* NewVersion(int v);
+
+    /// @brief return the current version of variable @a v
+    CTacAddr* GetVersion(int v);
+
+    CCodeBlock *_cb;                ///< code block
+    CCfg _cfg;                      ///< control flow graph of the code block
+    vector<SVariable> _vars;        ///< variables
+    vector<int> _tempvar;           ///< variable of each temporary (indexed by id, or -1)
+    unordered_map<const CSymbol*, int> _symvar; ///< variable of each symbol
+    vector<vector<CBasicBlock*> > _df; ///< dominance frontiers (indexed by block id)
+    vector<vector<pair<CTacPhi*, int> > > _phis; ///< phi functions (indexed by block id)
+    vector<CTacLabel*> _labels;     ///< labels identifying predecessors (indexed by block id)
+    vector<int> _log;               ///< variables of the versions pushed during renaming
+};
+
+CSSAConstruction::CSSAConstruction(CCodeBlock *cb)
+  : _cb(cb), _cfg(cb)
+{
+}
+
+void CSSAConstruction::Run(void)
+{
+  if (_cfg.GetEntry() == NULL) return;
+
+  // phi functions, names and temporaries are owned by the code block
+  CTacArena *prev = CTacArena::SetCurrent(_cb->GetArena());
+
+  FindVars();
+  CollectDefsUses();
+  ComputeFrontiers();
+  PlacePhis();
+  Rename();
+
+  CTacArena::SetCurrent(prev);
+
+  _cb->Renumber();
+}
+
+int CSSAConstruction::GetVar(const CTacAddr *a) const
+{
+  int v = -1;
+
+  if (isa<CTacTemp>(a)) {
+    unsigned int id = cast<CTacTemp>(a)->GetId();
+    if (id < _tempvar.size()) v = _tempvar[id];
+  } else if (isa<CTacName>(a)) {
+    unordered_map<const CSymbol*, int>::const_iterator it =
+      _symvar.find(cast<CTacName>(a)->GetSymbol());
+    if (it != _symvar.end()) v = it->second;
+  }
+
+  return (v >= 0) && !_vars[v].excluded ? v : -1;
+}
+
+void CSSAConstruction::FindVars(void)
+{
+  _tempvar.assign(_cb->GetOwner()->GetTemps().size(), -1);
+
+  // variables are numbered in order of appearance, so phi functions are placed deterministically
+  for (CTacInstr *i = _cb->GetFirst(); i != NULL; i = i->GetNext()) {
+    CTacAddr *op[3] = { dyn_cast<CTacAddr>(i->GetDest()), i->GetSrc(1), i->GetSrc(2) };
+
+    for (int k=0; k<3; k++) {
+      if (isa<CTacReference>(op[k])) {
+        // the temporary holds an address; references to it are not renamed
+        CTacTemp *t = cast<CTacReference>(op[k])->GetTemp();
+        if (t->GetId() >= _tempvar.size()) continue;
+
+        int &v = _tempvar[t->GetId()];
+        if (v < 0) {
+          v = _vars.size();
+          _vars.push_back(SVariable());
+          _vars[v].temp = t;
+          _vars[v].symbol = NULL;
+          _vars[v].type = t->GetType();
+          _vars[v].reused = false;
+        }
+        _vars[v].excluded = true;
+      } else if (isa<CTacTemp>(op[k])) {
+        CTacTemp *t = cast<CTacTemp>(op[k]);
+        if ((t->GetId() >= _tempvar.size()) || (_tempvar[t->GetId()] >= 0)) continue;
+
+        _tempvar[t->GetId()] = _vars.size();
+        _vars.push_back(SVariable());
+        _vars.back().temp = t;
+        _vars.back().symbol = NULL;
+        _vars.back().type = t->GetType();
+        _vars.back().excluded = false;
+        _vars.back().reused = false;
+      } else if (isa<CTacName>(op[k])) {
+        // local scalar variables and parameters
+        const CSymbol *s = cast<CTacName>(op[k])->GetSymbol();
+        ESymbolType st = s->GetSymbolType();
+        const CType *type = s->GetDataType();
+        if (((st != stLocal) && (st != stParam)) || !type->IsScalar() || type->IsPointer()) {
+          continue;
+        }
+
+        unordered_map<const CSymbol*, int>::iterator it = _symvar.find(s);
+        int v;
+        if (it == _symvar.end()) {
+          v = _vars.size();
+          _symvar[s] = v;
+          _vars.push_back(SVariable());
+          _vars[v].temp = NULL;
+          _vars[v].symbol = s;
+          _vars[v].type = type;
+          _vars[v].excluded = false;
+          _vars[v].reused = false;
+        } else {
+          v = it->second;
+        }
+
+        // variables whose address is taken live in memory
+        if ((k == 1) && (i->GetOperation() == opAddress)) _vars[v].excluded = true;
+      }
+    }
+  }
+}
+
+void CSSAConstruction::CollectDefsUses(void)
+{
+  // block id + 1 of the last block that defined/used a variable
+  vector<unsigned int> def(_vars.size(), 0), use(_vars.size(), 0);
+  const vector<CBasicBlock*> &blocks = _cfg.GetBlocks();
+
+  for (size_t b=0; b<blocks.size(); b++) {
+    CBasicBlock *bb = blocks[b];
+    if (!bb->IsReachable()) continue;
+
+    unsigned int stamp = bb->GetId() + 1;
+    for (CTacInstr *i = bb->GetFirst(); ; i = i->GetNext()) {
+      // sources are read before the destination is written
+      for (int k=1; k<=2; k++) {
+        int v = GetVar(i->GetSrc(k));
+        if ((v >= 0) && (def[v] != stamp) && (use[v] != stamp)) {
+          use[v] = stamp;
+          _vars[v].uses.push_back(bb);
+        }
+      }
+
+      int v = GetVar(dyn_cast<CTacAddr>(i->GetDest()));
+      if ((v >= 0) && (def[v] != stamp)) {
+        def[v] = stamp;
+        _vars[v].defs.push_back(bb);
+      }
+
+      if (i == bb->GetLast()) break;
+    }
+  }
+}
+
+void CSSAConstruction::ComputeFrontiers(void)
+{
+  // Cooper, Harvey, Kennedy: b is in the frontier of every block on the dominator tree path
+  // from a predecessor of b up to (excluding) the immediate dominator of b
+  const vector<CBasicBlock*> &rpo = _cfg.GetRPO();
+  _df.resize(_cfg.GetBlocks().size());
+
+  for (size_t r=0; r<rpo.size(); r++) {
+    CBasicBlock *b = rpo[r];
+    const vector<CBasicBlock*> &pred = b->GetPredecessors();
+    if ((pred.size() < 2) && (b != _cfg.GetEntry())) continue;
+
+    for (size_t p=0; p<pred.size(); p++) {
+      if (!pred[p]->IsReachable()) continue;
+
+      for (CBasicBlock *run = pred[p]; run != b->GetIDom(); run = run->GetIDom()) {
+        vector<CBasicBlock*> &df = _df[run->GetId()];
+        if (df.empty() || (df.back() != b)) df.push_back(b);
+      }
+    }
+  }
+}
+
+void CSSAConstruction::PlacePhis(void)
+{
+  size_t n = _cfg.GetBlocks().size();
+  vector<size_t> live(n, 0), def(n, 0), phi(n, 0), work(n, 0);
+  vector<CBasicBlock*> wl;
+
+  _phis.resize(n);
+  _labels.assign(n, NULL);
+
+  for (size_t v=0; v<_vars.size(); v++) {
+    SVariable &var = _vars[v];
+    if (var.excluded || var.defs.empty()) continue;
+
+    size_t stamp = v + 1;
+
+    // blocks the variable is live on entry to: propagate upward-exposed uses backwards until a
+    // definition is reached
+    for (size_t d=0; d<var.defs.size(); d++) def[var.defs[d]->GetId()] = stamp;
+    wl = var.uses;
+    for (size_t u=0; u<wl.size(); u++) live[wl[u]->GetId()] = stamp;
+
+    while (!wl.empty()) {
+      CBasicBlock *b = wl.back();
+      wl.pop_back();
+
+      const vector<CBasicBlock*> &pred = b->GetPredecessors();
+      for (size_t p=0; p<pred.size(); p++) {
+        unsigned int id = pred[p]->GetId();
+        if (pred[p]->IsReachable() && (live[id] != stamp) && (def[id] != stamp)) {
+          live[id] = stamp;
+          wl.push_back(pred[p]);
+        }
+      }
+    }
+
+    // iterated dominance frontier of the definitions; a phi function is a definition itself
+    wl = var.defs;
+    for (size_t d=0; d<wl.size(); d++) work[wl[d]->GetId()] = stamp;
+
+    while (!wl.empty()) {
+      CBasicBlock *b = wl.back();
+      wl.pop_back();
+
+      const vector<CBasicBlock*> &df = _df[b->GetId()];
+      for (size_t f=0; f<df.size(); f++) {
+        unsigned int id = df[f]->GetId();
+        if (phi[id] == stamp) continue;
+
+        phi[id] = stamp;
+        if (live[id] != stamp) continue;
+
+        InsertPhi(df[f], v);
+        if (work[id] != stamp) {
+          work[id] = stamp;
+          wl.push_back(df[f]);
+        }
+      }
+    }
+  }
+}
+
+void CSSAConstruction::InsertPhi(CBasicBlock *b, int v)
+{
+  // one argument per reachable predecessor, plus one for the entry into the code block
+  const vector<CBasicBlock*> &pred = b->GetPredecessors();
+  vector<CTacLabel*> from;
+
+  if (b == _cfg.GetEntry()) from.push_back(NULL);
+  for (size_t p=0; p<pred.size(); p++) {
+    if (pred[p]->IsReachable()) from.push_back(GetLabel(pred[p]));
+  }
+
+  CTacPhi *phi = new CTacPhi(NULL, from.size());
+  for (size_t a=0; a<from.size(); a++) phi->SetPred(a, from[a]);
+
+  // insert after the labels and the phi functions already placed
+  CTacInstr *pos = b->GetFirst();
+  while (isa<CTacLabel>(pos)) {
+    bool last = pos == b->GetLast();
+    pos = pos->GetNext();
+    if (last) break;
+  }
+  while (isa<CTacPhi>(pos)) pos = pos->GetNext();
+  _cb->InsertInstr(pos, phi);
+
+  _phis[b->GetId()].push_back(make_pair(phi, v));
+}
+
+CTacLabel* CSSAConstruction::GetLabel(CBasicBlock *b)
+{
+  CTacLabel *&l = _labels[b->GetId()];
+
+  if (l == NULL) {
+    CTacInstr *first = b->GetFirst();
+
+    if (isa<CTacLabel>(first)) {
+      l = cast<CTacLabel>(first);
+    } else {
+      // the new label precedes the phi functions already placed in the block. The control flow
+      // graph is not updated: the first instruction of the block stays the same.
+      while (isa<CTacPhi>(first->GetPrev())) first = first->GetPrev();
+      l = _cb->CreateLabel();
+      _cb->InsertInstr(first, l);
+    }
+  }
+
+  return l;
+}
+
+void CSSAConstruction::Rename(void)
+{
+  CBasicBlock *entry = _cfg.GetEntry();
+
+  // the entry into the code block provides the initial values
+  vector<pair<CTacPhi*, int> > &phis = _phis[entry->GetId()];
+  for (size_t p=0; p<phis.size(); p++) {
+    CTacPhi *phi = phis[p].first;
+    for (unsigned int a=0; a<phi->GetNumArgs(); a++) {
+      if (phi->GetPred(a) == NULL) phi->SetArg(a, GetVersion(phis[p].second));
+    }
+  }
+
+  // iterative preorder walk of the dominator tree; the versions pushed by a block are popped
+  // when its subtree has been renamed
+  struct SFrame {
+    CBasicBlock *block;             ///< block
+    size_t child;                   ///< next dominator tree child
+    size_t log;                     ///< size of the log on entry
+  };
+  vector<SFrame> stack;
+
+  SFrame f = { entry, 0, _log.size() };
+  RenameBlock(entry);
+  stack.push_back(f);
+
+  while (!stack.empty()) {
+    SFrame &top = stack.back();
+    const vector<CBasicBlock*> &children = top.block->GetDomChildren();
+
+    if (top.child < children.size()) {
+      CBasicBlock *c = children[top.child++];
+      SFrame f = { c, 0, _log.size() };
+      RenameBlock(c);
+      stack.push_back(f);
+    } else {
+      while (_log.size() > top.log) {
+        _vars[_log.back()].stack.pop_back();
+        _log.pop_back();
+      }
+      stack.pop_back();
+    }
+  }
+}
+
+void CSSAConstruction::RenameBlock(CBasicBlock *b)
+{
+  vector<pair<CTacPhi*, int> > &phis = _phis[b->GetId()];
+  for (size_t p=0; p<phis.size(); p++) phis[p].first->SetDest(NewVersion(phis[p].second));
+
+  for (CTacInstr *i = b->GetFirst(); ; i = i->GetNext()) {
+    if (!isa<CTacPhi>(i)) {
+      for (int k=1; k<=2; k++) {
+        int v = GetVar(i->GetSrc(k));
+        if ((v >= 0) && !_vars[v].stack.empty()) i->SetSrc(k, _vars[v].stack.back());
+      }
+
+      int v = GetVar(dyn_cast<CTacAddr>(i->GetDest()));
+      if (v >= 0) i->SetDest(NewVersion(v));
+    }
+
+    if (i == b->GetLast()) break;
+  }
+
+  // arguments of the phi functions in the successors
+  const vector<CBasicBlock*> &succ = b->GetSuccessors();
+  for (size_t s=0; s<succ.size(); s++) {
+    vector<pair<CTacPhi*, int> > &sphis = _phis[succ[s]->GetId()];
+
+    for (size_t p=0; p<sphis.size(); p++) {
+      CTacPhi *phi = sphis[p].first;
+      for (unsigned int a=0; a<phi->GetNumArgs(); a++) {
+        if ((_labels[b->GetId()] != NULL) && (phi->GetPred(a) == _labels[b->GetId()])) {
+          phi->SetArg(a, GetVersion(sphis[p].second));
+        }
+      }
+    }
+  }
+}
+
+CTacAddr* CSSAConstruction::NewVersion(int v)
+{
+  SVariable &var = _vars[v];
+  CTacAddr *a;
+
+  // the first version of a temporary is the temporary itself
+  if ((var.temp != NULL) && !var.reused) {
+    var.reused = true;
+    a = var.temp;
+  } else {
+    a = _cb->CreateTemp(var.type);
+  }
+
+  var.stack.push_back(a);
+  _log.push_back(v);
+
+  return a;
+}
+
+CTacAddr* CSSAConstruction::GetVersion(int v)
+{
+  SVariable &var = _vars[v];
+
+  if (!var.stack.empty()) return var.stack.back();
+
+  // not defined on this path: the initial value
+  if (var.temp != NULL) return var.temp;
+  return new CTacName(var.symbol);
+}
+
+void ConstructSSA(CCodeBlock *cb)
+{
+  assert(cb != NULL);
+
+  CSSAConstruction ssa(cb);
+  ssa.Run();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// SSA destruction
+//
+
+/// @brief copy dst <- src of a parallel copy
+struct SCopy {
+  CTacAddr *dst;                    ///< destination
+  CTacAddr *src;                    ///< source
+};
+
+/// @brief block splitting a critical edge
+struct SSplit {
+  CTacLabel *label;                 ///< label of the new block
+  CTacLabel *target;                ///< original branch target
+  vector<CTacInstr*> copies;        ///< copies of the edge
+};
+
+/// @brief sequentialize the parallel copy @a copies into assignments
+///
+/// a copy is emitted once no pending copy reads its destination. If only cycles remain, the
+/// destination of one copy is saved in a new temporary first.
+///
+/// @param cb code block
+/// @param copies parallel copy (destinations are distinct)
+/// @param out assignments (output)
+static void Sequentialize(CCodeBlock *cb, vector<SCopy> copies, vector<CTacInstr*> &out)
+{
+  for (size_t c=0; c<copies.size(); ) {
+    if (copies[c].dst == copies[c].src) copies.erase(copies.begin() + c);
+    else c++;
+  }
+
+  while (!copies.empty()) {
+    bool emitted = false;
+
+    for (size_t c=0; (c<copies.size()) && !emitted; c++) {
+      bool read = false;
+      for (size_t r=0; (r<copies.size()) && !read; r++) {
+        read = (r != c) && (copies[r].src == copies[c].dst);
+      }
+
+      if (!read) {
+        out.push_back(new CTacInstr(opAssign, copies[c].dst, copies[c].src));
+        copies.erase(copies.begin() + c);
+        emitted = true;
+      }
+    }
+
+    if (!emitted) {
+      CTacAddr *dst = copies[0].dst;
+      CTacTemp *t = cb->CreateTemp(dst->GetType());
+      out.push_back(new CTacInstr(opAssign, t, dst));
+      for (size_t r=0; r<copies.size(); r++) {
+        if (copies[r].src == dst) copies[r].src = t;
+      }
+    }
+  }
+}
+
+void DestructSSA(CCodeBlock *cb)
+{
+  assert(cb != NULL);
+
+  CCfg cfg(cb);
+  if (cfg.GetEntry() == NULL) return;
+
+  // copies, labels and temporaries are owned by the code block
+  CTacArena *prev = CTacArena::SetCurrent(cb->GetArena());
+
+  CTacInstr *first = cb->GetFirst();
+  vector<CTacPhi*> allphis;
+  vector<SSplit> splits;
+  const vector<CBasicBlock*> &blocks = cfg.GetBlocks();
+
+  for (size_t b=0; b<blocks.size(); b++) {
+    CBasicBlock *bb = blocks[b];
+
+    vector<CTacPhi*> phis;
+    for (CTacInstr *i = bb->GetFirst(); ; i = i->GetNext()) {
+      if (isa<CTacPhi>(i)) phis.push_back(cast<CTacPhi>(i));
+      if (i == bb->GetLast()) break;
+    }
+    if (phis.empty()) continue;
+    allphis.insert(allphis.end(), phis.begin(), phis.end());
+
+    // one parallel copy per incoming edge
+    for (unsigned int a=0; a<phis[0]->GetNumArgs(); a++) {
+      CTacLabel *from = phis[0]->GetPred(a);
+
+      vector<SCopy> copies;
+      for (size_t p=0; p<phis.size(); p++) {
+        for (unsigned int pa=0; pa<phis[p]->GetNumArgs(); pa++) {
+          if (phis[p]->GetPred(pa) == from) {
+            SCopy c = { cast<CTacAddr>(phis[p]->GetDest()), phis[p]->GetArg(pa) };
+            copies.push_back(c);
+            break;
+          }
+        }
+      }
+
+      vector<CTacInstr*> seq;
+      Sequentialize(cb, copies, seq);
+      if (seq.empty()) continue;
+
+      // entry into the code block: before the first instruction
+      if (from == NULL) {
+        for (size_t s=0; s<seq.size(); s++) cb->InsertInstr(first, seq[s]);
+        continue;
+      }
+
+      CBasicBlock *pred = cfg.GetBlock(from);
+      assert(pred != NULL);
+      CTacInstr *last = pred->GetLast();
+      EOperation op = last->GetOperation();
+
+      bool taken = last->IsBranch() && (cfg.GetBlock(cast<CTacInstr>(last->GetDest())) == bb);
+      bool fall = (op != opGoto) && (op != opReturn) && (last->GetNext() == bb->GetFirst());
+
+      // the edge has been removed since the phi function was placed
+      if (!taken && !fall) continue;
+
+      if (taken && (op == opGoto)) {
+        // unconditional branch: before the branch
+        for (size_t s=0; s<seq.size(); s++) cb->InsertInstr(last, seq[s]);
+      } else if (taken) {
+        // conditional branch: the edge is critical, split it
+        SSplit split = { cb->CreateLabel("split"), cast<CTacLabel>(last->GetDest()), seq };
+        last->SetDest(split.label);
+        splits.push_back(split);
+
+        if (fall) {
+          vector<CTacInstr*> fseq;
+          Sequentialize(cb, copies, fseq);
+          seq = fseq;
+        }
+      }
+
+      if (fall) {
+        // fall-through: between the predecessor and the block
+        for (size_t s=0; s<seq.size(); s++) cb->InsertInstr(bb->GetFirst(), seq[s]);
+      }
+    }
+  }
+
+  // release the references to the predecessor labels
+  for (size_t p=0; p<allphis.size(); p++) {
+    for (unsigned int a=0; a<allphis[p]->GetNumArgs(); a++) allphis[p]->SetPred(a, NULL);
+    cb->RemoveInstr(allphis[p]);
+  }
+
+  // blocks splitting critical edges are appended to the code block
+  if (!splits.empty()) {
+    CTacInstr *last = cb->GetLast();
+    CTacLabel *end = NULL;
+
+    if ((last->GetOperation() != opGoto) && (last->GetOperation() != opReturn)) {
+      end = cb->CreateLabel("end");
+      cb->AddInstr(new CTacInstr(opGoto, end));
+    }
+
+    for (size_t s=0; s<splits.size(); s++) {
+      cb->AddInstr(splits[s].label);
+      for (size_t c=0; c<splits[s].copies.size(); c++) cb->AddInstr(splits[s].copies[c]);
+      cb->AddInstr(new CTacInstr(opGoto, splits[s].target));
+    }
+
+    if (end != NULL) cb->AddInstr(end);
+  }
+
+  CTacArena::SetCurrent(prev);
+
+  cb->CleanupControlFlow();
+}
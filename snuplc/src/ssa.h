@@ -0,0 +1,73 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL static single assignment form
+///
+/// conversion of code blocks into and out of static single assignment (SSA) form
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_SSA_H__
+#define __SnuPL_SSA_H__
+
+#include "ir.h"
+using namespace std;
+
+
+/// @name static single assignment form
+///
+/// In SSA form, every temporary of a code block is defined by exactly one instruction and this
+/// definition dominates all uses. Phi functions (CTacPhi) at the start of basic blocks merge the
+/// values arriving from different predecessors.
+///
+/// Local scalar variables and parameters whose address is never taken are replaced by
+/// temporaries; a use that is not reached by any definition keeps referring to the symbol (the
+/// value of a parameter on entry). Temporaries that hold a reference (CTacReference), global
+/// variables and arrays are not renamed.
+///
+/// @{
+
+/// @brief convert @a cb into SSA form
+///
+/// phi functions are placed at the iterated dominance frontiers of the definitions of a
+/// variable, but only where the variable is live (pruned SSA). Instructions in unreachable
+/// basic blocks are left unchanged. Predecessor blocks without a label receive one so that the
+/// phi functions can identify them.
+///
+/// @param cb code block (not in SSA form)
+void ConstructSSA(CCodeBlock *cb);
+
+/// @brief convert @a cb out of SSA form
+///
+/// every phi function is replaced by copies at the end of its predecessors. Critical edges
+/// taken by a conditional branch are split by a new block at the end of @a cb. The copies of an
+/// edge are a parallel copy; they are ordered such that no source is overwritten before it is
+/// read, cycles are broken with a new temporary. Arguments of edges that no longer exist are
+/// ignored. The result contains only operations the backend emits.
+///
+/// @param cb code block (in SSA form)
+void DestructSSA(CCodeBlock *cb);
+
+/// @}
+
+#endif // __SnuPL_SSA_H__
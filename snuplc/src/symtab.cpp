@@ -32,6 +32,7 @@
 /// DAMAGE.
 //--------------------------------------------------------------------------------------------------
 
+#include <algorithm>
 #include <cassert>
 #include <iomanip>
 #include <sstream>
@@ -101,9 +102,11 @@ ostream& operator<<(ostream &out, const CStorage *s)
 // CSymbol
 //
 CSymbol::CSymbol(const string name, ESymbolType stype, const CType *dtype)
-  : _symtab(NULL), _name(name), _symboltype(stype), _datatype(dtype), _location(NULL), _data(NULL)
+  : _symtab(NULL), _decl(0), _name(CInterner::Get()->Intern(name)), _symboltype(stype),
+    _datatype(dtype),
+    _location(NULL), _data(NULL)
 {
-  assert(_name != "");
+  assert(_name != 0);
   assert(_datatype != NULL);
 }
 
@@ -112,7 +115,12 @@ CSymbol::~CSymbol(void)
   if (_location != NULL) delete _location;
 }
 
-string CSymbol::GetName(void) const
+const string& CSymbol::GetName(void) const
+{
+  return CInterner::Get()->GetString(_name);
+}
+
+int CSymbol::GetNameId(void) const
 {
   return _name;
 }
@@ -332,20 +340,24 @@ ostream& CSymConstant::print(ostream &out, int indent) const
 // CSymtab
 //
 CSymtab::CSymtab(void)
-  : _parent(NULL)
+  : _parent(NULL), _parent_decls(0), _limit(false), _concurrent(false)
 {
 }
 
 CSymtab::CSymtab(CSymtab *parent)
-  : _parent(parent)
+  : _parent(parent), _parent_decls(0), _limit(false), _concurrent(false)
 {
   assert(parent != NULL);
+
+  unique_lock<mutex> guard(parent->_lock, defer_lock);
+  if (parent->_concurrent) guard.lock();
+  _parent_decls = parent->_decl.size();
 }
 
 CSymtab::~CSymtab(void)
 {
-  map<string, CSymbol*>::const_iterator it = _symtab.begin();
-  while (it != _symtab.end()) delete (*it++).second;
+  for (size_t i=0; i<_decl.size(); i++) delete _decl[i];
+  _decl.clear();
   _symtab.clear();
 }
 
@@ -354,6 +366,14 @@ CSymtab* CSymtab::GetParent(void) const
   return _parent;
 }
 
+void CSymtab::SetConcurrent(bool concurrent)
+{
+  _concurrent = concurrent;
+
+  // rebuild the sorted list while no other thread uses the symbol table
+  if (!concurrent) GetSymbols();
+}
+
 bool CSymtab::AddSymbol(CSymbol *s)
 {
   assert(s != NULL);
@@ -363,9 +383,13 @@ bool CSymtab::AddSymbol(CSymbol *s)
     return _parent->AddSymbol(s);
   }
 
-  if (!FindSymbol(s->GetName(), sLocal)) {
-    _symtab[s->GetName()] = s;
+  unique_lock<mutex> guard(_lock, defer_lock);
+  if (_concurrent) guard.lock();
+
+  if (_symtab.insert(make_pair(s->GetNameId(), s)).second) {
     s->SetSymbolTable(this);
+    s->_decl = _decl.size();
+    _decl.push_back(s);
     return true;
   } else {
     return false;
@@ -374,26 +398,51 @@ bool CSymtab::AddSymbol(CSymbol *s)
 
 const CSymbol* CSymtab::FindSymbol(const string name, EScope scope) const
 {
-  map<string, CSymbol*>::const_iterator it = _symtab.find(name);
+  // a name that has never been interned cannot be bound to any symbol
+  int nameid = CInterner::Get()->Find(name);
+  if (nameid == -1) return NULL;
 
-  if (it != _symtab.end()) return (*it).second;
-  else {
-    if ((scope == sLocal) || (_parent == NULL)) return NULL;
-    else return _parent->FindSymbol(name, scope);
+  return FindSymbol(nameid, scope);
+}
+
+const CSymbol* CSymtab::FindSymbol(int nameid, EScope scope) const
+{
+  {
+    unique_lock<mutex> guard(_lock, defer_lock);
+    if (_concurrent) guard.lock();
+
+    unordered_map<int, CSymbol*>::const_iterator it = _symtab.find(nameid);
+    if (it != _symtab.end()) return (*it).second;
   }
+
+  if ((scope == sLocal) || (_parent == NULL)) return NULL;
+
+  const CSymbol *s = _parent->FindSymbol(nameid, scope);
+  if (_limit && (s != NULL) && (s->GetSymbolTable() == _parent) && (s->_decl >= _parent_decls)) {
+    return NULL;
+  }
+  return s;
+}
+
+/// @brief order symbols by name
+static bool SymbolNameLess(const CSymbol *a, const CSymbol *b)
+{
+  return a->GetName() < b->GetName();
 }
 
-vector<CSymbol*> CSymtab::GetSymbols(void) const
+const vector<CSymbol*>& CSymtab::GetSymbols(void) const
 {
-  vector<CSymbol*> _res;
+  assert(!_concurrent);
 
-  map<string, CSymbol*>::const_iterator it = _symtab.begin();
-  while (it != _symtab.end()) {
-    _res.push_back(it->second);
-    it++;
+  // symbols are never removed, so the cache is stale iff symbols have been added since
+  if (_sorted.size() != _decl.size()) {
+    // sort by name to keep the symbol order (and thus stack layouts and listings) independent
+    // of the declaration order
+    _sorted = _decl;
+    sort(_sorted.begin(), _sorted.end(), SymbolNameLess);
   }
 
-  return _res;
+  return _sorted;
 }
 
 ostream& CSymtab::print(ostream &out, int indent) const
@@ -401,11 +450,11 @@ ostream& CSymtab::print(ostream &out, int indent) const
   string ind(indent, ' ');
 
   out << ind << "[[";
-  map<string, CSymbol*>::const_iterator it = _symtab.begin();
-  while (it != _symtab.end()) {
+  const vector<CSymbol*> &symbols = GetSymbols();
+  for (size_t i=0; i<symbols.size(); i++) {
     out << endl;
 
-    const CSymbol *s = (*it++).second;
+    const CSymbol *s = symbols[i];
     s->print(out, indent+2);
 
     const CDataInitializer *di = s->GetData();
@@ -35,10 +35,12 @@
 #define __SnuPL_SYMTAB_H__
 
 #include <iostream>
-#include <map>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "data.h"
+#include "intern.h"
 #include "type.h"
 using namespace std;
 
@@ -166,7 +168,21 @@ class CSymbol {
 
     /// @brief return the symbol's identifier
     /// @retval string name
-    string GetName(void) const;
+    const string& GetName(void) const;
+
+    /// @brief return the interned id of the symbol's identifier
+    ///
+    /// Two symbols have the same name iff their name ids are equal.
+    ///
+    /// @retval int name id
+    int GetNameId(void) const;
+
+    /// @brief return the symbol's slot in its symbol table
+    ///
+    /// Slots number the symbols of a symbol table in declaration order.
+    ///
+    /// @retval int slot
+    int GetSlot(void) const { return _decl; };
 
     /// @brief return the symbol's type
     /// @retval ESymbolType symbol type
@@ -227,7 +243,8 @@ class CSymbol {
     /// @}
 
     CSymtab       *_symtab;       ///< symbol table owning this symbol
-    string         _name;         ///< name
+    int            _decl;         ///< declaration number in the owning symbol table
+    int            _name;         ///< name (interned id)
     ESymbolType    _symboltype;   ///< symbol type
     const CType   *_datatype;     ///< data type
     CStorage      *_location;     ///< storage location
@@ -489,6 +506,22 @@ class CSymtab {
     /// @retval NULL if this instance is the global symbol table
     CSymtab* GetParent(void) const;
 
+    /// @brief restrict lookups in the parent symbol table to declarations preceding this one
+    ///
+    /// With the restriction enabled, FindSymbol() only returns symbols of the parent that had
+    /// been declared when this symbol table was created. This keeps declare-before-use intact
+    /// when a subroutine body is parsed after the declarations that follow it.
+    ///
+    /// @param limit true: hide later declarations of the parent
+    void SetParentLimit(bool limit) { _limit = limit; };
+
+    /// @brief enable/disable locking for concurrent access
+    ///
+    /// Leaving concurrent mode rebuilds the cache of GetSymbols().
+    ///
+    /// @param concurrent true: AddSymbol() and FindSymbol() may be called from several threads
+    void SetConcurrent(bool concurrent);
+
     /// @}
 
 
@@ -506,8 +539,24 @@ class CSymtab {
     /// @retval CSymbol matching symbol or NULL if not found
     const CSymbol* FindSymbol(const string name, EScope scope=sGlobal) const;
 
-    /// @brief return a list of all symbols
-    vector<CSymbol*> GetSymbols(void) const;
+    /// @brief return a symbol with a given interned name
+    /// @param nameid interned symbol name (identifier)
+    /// @param scope search scope (default: sGlobal)
+    /// @retval CSymbol matching symbol or NULL if not found
+    const CSymbol* FindSymbol(int nameid, EScope scope=sGlobal) const;
+
+    /// @brief return the number of symbols
+    size_t GetNumSymbols(void) const { return _decl.size(); };
+
+    /// @brief return all symbols in declaration order (indexed by slot)
+    const vector<CSymbol*>& GetDeclarations(void) const { return _decl; };
+
+    /// @brief return all symbols sorted by name
+    ///
+    /// The sorted list is cached and only rebuilt after symbols have been added. Must not be
+    /// called in concurrent mode (see SetConcurrent()): a rebuild would replace the list while
+    /// other threads may iterate over it.
+    const vector<CSymbol*>& GetSymbols(void) const;
 
     /// @}
 
@@ -519,8 +568,14 @@ class CSymtab {
     ostream&  print(ostream &out, int indent=0) const;
 
   private:
-    map<string, CSymbol*> _symtab;///< local symbol table
+    unordered_map<int, CSymbol*> _symtab; ///< local symbol table (keyed by interned name)
+    vector<CSymbol*> _decl;       ///< symbols in declaration order
+    mutable vector<CSymbol*> _sorted; ///< symbols sorted by name (cache for GetSymbols())
     CSymtab       *_parent;       ///< parent
+    int            _parent_decls; ///< number of declarations in the parent at creation time
+    bool           _limit;        ///< hide later declarations of the parent
+    bool           _concurrent;   ///< lock in AddSymbol()/FindSymbol()
+    mutable mutex  _lock;         ///< lock for concurrent access
 };
 
 /// @name CSymtab output operators
@@ -0,0 +1,689 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL TAC reader
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+#include <unordered_set>
+
+#include "scanner.h"
+#include "tacparser.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// CTacParser
+//
+CTacParser::CTacParser(istream *in)
+  : _cur(0), _pos(0), _abort(false), _error_line(0)
+{
+  assert(in != NULL);
+
+  // keep the non-empty lines without indentation and trailing blanks
+  string l;
+  int lineno = 0;
+  while (getline(*in, l)) {
+    lineno++;
+    size_t b = l.find_first_not_of(" \t\r");
+    if (b == string::npos) continue;
+    size_t e = l.find_last_not_of(" \t\r");
+    _lines.push_back(l.substr(b, e-b+1));
+    _lineno.push_back(lineno);
+  }
+
+  for (int op=opAdd; op<=opNop; op++) {
+    ostringstream name;
+    name << (EOperation)op;
+    _ops[name.str()] = (EOperation)op;
+  }
+}
+
+CModule* CTacParser::Parse(void)
+{
+  _cur = _pos = 0;
+  _abort = false;
+  _error_line = 0;
+  _message = "";
+
+  CModule *m = module();
+  _procs.clear();
+
+  if (_abort) {
+    delete m;
+    m = NULL;
+  }
+
+  return m;
+}
+
+void CTacParser::SetError(const string message)
+{
+  if (_abort) return;
+
+  _error_line = More() ? _lineno[_cur] : (_lineno.empty() ? 0 : _lineno.back());
+  _message = message;
+  _abort = true;
+}
+
+void CTacParser::Next(void)
+{
+  if (More()) _cur++;
+  _pos = 0;
+}
+
+bool CTacParser::Is(const string text) const
+{
+  return More() && (_lines[_cur] == text);
+}
+
+bool CTacParser::StartsWith(const string text) const
+{
+  return More() && (_lines[_cur].compare(0, text.size(), text) == 0);
+}
+
+bool CTacParser::Accept(const string text)
+{
+  if (_abort || !More() || (_lines[_cur].compare(_pos, text.size(), text) != 0)) return false;
+
+  _pos += text.size();
+  return true;
+}
+
+bool CTacParser::Consume(const string text)
+{
+  if (Accept(text)) return true;
+
+  SetError("'" + text + "' expected");
+  return false;
+}
+
+void CTacParser::Skip(void)
+{
+  while (More() && !AtEnd() && (_lines[_cur][_pos] == ' ')) _pos++;
+}
+
+string CTacParser::Word(const string stop)
+{
+  if (!More()) return "";
+
+  const string &l = _lines[_cur];
+  size_t e = l.find_first_of(stop, _pos);
+  if (e == string::npos) e = l.size();
+
+  string w = l.substr(_pos, e-_pos);
+  _pos = e;
+  return w;
+}
+
+CModule* CTacParser::module(void)
+{
+  //
+  // module ::= "[[ module:" name typemanager symtab [temporaries] codeblock { procedure } "]]".
+  //
+
+  // skip the file name
+  while (More() && !StartsWith("[[ module:")) Next();
+  if (!More()) {
+    SetError("module expected");
+    return NULL;
+  }
+  _pos = 10;
+  Skip();
+  string name = Word("");
+  Next();
+
+  // types are recreated in the order listed (further ones on demand); the array types come
+  // first since the pointer types listed before them refer to them
+  if (Is("[[ type manager")) {
+    Next();
+    size_t begin = _cur;
+    bool arrays = false;
+    while (!_abort && More() && !Is("]]")) {
+      if (_lines[_cur][_lines[_cur].size()-1] == ':') arrays = Is("array types:");
+      else if (arrays) type();
+      Next();
+    }
+    size_t end = _cur;
+    for (_cur=begin; !_abort && (_cur<end); Next()) {
+      if (_lines[_cur][_lines[_cur].size()-1] != ':') type();
+    }
+    if (!Is("]]")) SetError("end of type manager expected");
+    Next();
+  }
+
+  CSymtab *st = new CSymtab();
+  symtab(st);
+  CModule *m = new CModule(name, st);
+  if (_abort) return m;
+
+  temporaries(m);
+  codeblock(m);
+  while (!_abort && StartsWith("[[ procedure:")) procedure(m);
+  if (!Is("]]")) SetError("end of module expected");
+  if (_abort) return m;
+  Next();
+
+  // procedures without a scope are external
+  map<string, pair<CSymProc*, vector<const CType*> > >::iterator it;
+  for (it=_procs.begin(); it!=_procs.end(); it++) {
+    CSymProc *p = it->second.first;
+    const vector<const CType*> &types = it->second.second;
+
+    p->SetExternal(true);
+    for (size_t i=0; i<types.size(); i++) {
+      ostringstream pn;
+      pn << "p" << i;
+      p->AddParam(new CSymParam(i, pn.str(), types[i]));
+    }
+  }
+  _procs.clear();
+
+  return m;
+}
+
+CProcedure* CTacParser::procedure(CScope *parent)
+{
+  //
+  // procedure ::= "[[ procedure:" name ["(" [param { "," param }] ")"] symtab [temporaries]
+  //               codeblock { procedure } "]]".
+  //
+  _pos = 13;
+  Skip();
+  string name = Word("(");
+
+  // parameter names in declaration order
+  vector<string> names;
+  if (Accept("(") && !Accept(")")) {
+    do {
+      names.push_back(Word(",)"));
+    } while (Accept(","));
+    Consume(")");
+  }
+  if (_abort) return NULL;
+
+  map<string, pair<CSymProc*, vector<const CType*> > >::iterator it = _procs.find(name);
+  if (it == _procs.end()) {
+    SetError("procedure '" + name + "' is not declared");
+    return NULL;
+  }
+  Next();
+
+  CSymtab *st = new CSymtab(parent->GetSymbolTable());
+  symtab(st, names);
+  CSymProc *decl = it->second.first;
+  CProcedure *p = new CProcedure(decl, parent, st);
+  if (_abort) return p;
+
+  // the parameters of the declaration are those of the scope, ordered by index
+  vector<CSymParam*> params;
+  const vector<CSymbol*> &symbols = st->GetSymbols();
+  for (size_t i=0; i<symbols.size(); i++) {
+    if (symbols[i]->GetSymbolType() == stParam) {
+      params.push_back(dynamic_cast<CSymParam*>(symbols[i]));
+    }
+  }
+  sort(params.begin(), params.end(),
+       [](const CSymParam *a, const CSymParam *b) { return a->GetIndex() < b->GetIndex(); });
+
+  const vector<const CType*> &types = it->second.second;
+  bool match = params.size() == types.size();
+  for (size_t i=0; match && (i<params.size()); i++) {
+    match = (params[i]->GetIndex() == (int)i) && (params[i]->GetDataType() == types[i]);
+  }
+  if (!match) {
+    SetError("parameters of '" + name + "' do not match its declaration");
+    return p;
+  }
+  for (size_t i=0; i<params.size(); i++) decl->AddParam(params[i]);
+  _procs.erase(it);
+
+  temporaries(p);
+  codeblock(p);
+  while (!_abort && StartsWith("[[ procedure:")) procedure(p);
+  if (!Is("]]")) SetError("end of procedure expected");
+  Next();
+
+  return p;
+}
+
+void CTacParser::symtab(CSymtab *st, const vector<string> &names)
+{
+  //
+  // symtab ::= "[[" { symbol [ "[ data:" data "]" ] } "]]".
+  // symbol ::= "[" ("@"|"$"|"%"|"=") name type [location] "]"
+  //          | "[" "*" name "(" [type { "," type }] ")" "-->" type "]".
+  //
+  if (!Is("[[")) {
+    SetError("symbol table expected");
+    return;
+  }
+  Next();
+
+  int nparams = 0;
+  while (!_abort && More() && !Is("]]")) {
+    const string &l = _lines[_cur];
+    if (!StartsWith("[ ") || (l.size() < 5) || (l.compare(l.size()-2, 2, " ]") != 0)) {
+      SetError("symbol expected");
+      return;
+    }
+
+    _pos = 2;
+    char kind = l[_pos++];
+    CSymbol *s = NULL;
+    vector<const CType*> params;
+
+    if (kind == '*') {
+      string name = Word(" ,(");
+      Consume("(");
+      if (!Accept(")")) {
+        do {
+          params.push_back(type());
+        } while (Accept(","));
+        Consume(")");
+      }
+      Consume(" --> ");
+      const CType *rt = type();
+      if (_abort) return;
+
+      s = new CSymProc(name, rt, false);
+      Next();
+    } else if ((kind == '@') || (kind == '$') || (kind == '%') || (kind == '=')) {
+      string name = Word(" ");
+      Skip();
+      const CType *t = type();
+      if (_abort) return;
+
+      // the location is assigned anew; parameters not listed in the procedure header are
+      // numbered in the order they appear
+      int index = nparams;
+      vector<string>::const_iterator pi = find(names.begin(), names.end(), name);
+      if (pi != names.end()) index = pi - names.begin();
+      Next();
+
+      CDataInitializer *di = NULL;
+      if (StartsWith("[ data: ")) {
+        di = data(t);
+        if (_abort) return;
+        Next();
+      }
+
+      switch (kind) {
+        case '@': s = new CSymGlobal(name, t); break;
+        case '$': s = new CSymLocal(name, t); break;
+        case '%': s = new CSymParam(index, name, t); nparams++; break;
+        case '=':
+          if (di == NULL) {
+            SetError("constant '" + name + "' without data");
+            return;
+          }
+          s = new CSymConstant(name, t, di);
+          di = NULL;
+          break;
+      }
+      if (di != NULL) s->SetData(di);
+    } else {
+      SetError("unknown symbol kind");
+      return;
+    }
+
+    if (!st->AddSymbol(s)) {
+      SetError("duplicate symbol '" + s->GetName() + "'");
+      delete s;
+      return;
+    }
+
+    if (kind == '*') _procs[s->GetName()] = make_pair(dynamic_cast<CSymProc*>(s), params);
+  }
+
+  if (!Is("]]")) SetError("end of symbol table expected");
+  Next();
+}
+
+CDataInitializer* CTacParser::data(const CType *type)
+{
+  //
+  // data ::= number | "true" | "false" | "'" character "'" | '"' string '"'.
+  //
+  const string &l = _lines[_cur];
+  string d = l.substr(8, l.size()-10);
+
+  if ((d.size() >= 2) && (d[0] == '"') && (d[d.size()-1] == '"')) {
+    // strings are kept in escaped form
+    return new CDataInitString(d.substr(1, d.size()-2));
+  } else if ((d.size() >= 3) && (d[0] == '\'') && (d[d.size()-1] == '\'')) {
+    string c = CToken::unescape(d.substr(1, d.size()-2));
+    return new CDataInitChar(c.empty() ? '\0' : c[0]);
+  } else if ((d == "true") || (d == "false")) {
+    return new CDataInitBoolean(d == "true");
+  } else if (!d.empty() && (isdigit(d[0]) || (d[0] == '-'))) {
+    long long v = strtoll(d.c_str(), NULL, 10);
+    if (type->IsLongint()) return new CDataInitLongint(v);
+    else return new CDataInitInteger(v);
+  }
+
+  SetError("invalid data '" + d + "'");
+  return NULL;
+}
+
+void CTacParser::temporaries(CScope *s)
+{
+  //
+  // temporaries ::= "[[ temporaries" { "[" "$t" id type "]" } "]]".
+  //
+  // (a code block of a scope named 'temporaries' starts with an instruction instead)
+  if (!Is("[[ temporaries") || (_cur+1 >= _lines.size()) ||
+      (_lines[_cur+1].compare(0, 4, "[ $t") != 0)) {
+    return;
+  }
+  Next();
+
+  CTacArena *prev = CTacArena::SetCurrent(s->GetCodeBlock()->GetArena());
+  while (!_abort && More() && !Is("]]")) {
+    Consume("[ $t");
+    unsigned int id = strtoul(Word(" ").c_str(), NULL, 10);
+    Skip();
+    const CType *t = type();
+    Skip();
+    Consume("]");
+    if (_abort) break;
+
+    if (id != s->GetTemps().size()) {
+      SetError("temporaries out of order");
+      break;
+    }
+    s->CreateTemp(t);
+    Next();
+  }
+  CTacArena::SetCurrent(prev);
+
+  if (!Is("]]")) SetError("end of temporaries expected");
+  Next();
+}
+
+void CTacParser::codeblock(CScope *s)
+{
+  //
+  // codeblock ::= "[[" [name] { instruction } "]]".
+  //
+  if (!StartsWith("[[")) {
+    SetError("code block expected");
+    return;
+  }
+  Next();
+
+  CCodeBlock *cb = s->GetCodeBlock();
+  CTacArena *prev = CTacArena::SetCurrent(cb->GetArena());
+  _labels.clear();
+
+  unordered_set<CTacLabel*> defined;
+  while (!_abort && More() && !Is("]]")) {
+    CTacInstr *i = instruction(s);
+    if (_abort) break;
+
+    CTacLabel *l = dyn_cast<CTacLabel>(i);
+    if ((l != NULL) && !defined.insert(l).second) {
+      SetError("duplicate label '" + l->GetLabel() + "'");
+      break;
+    }
+    cb->AddInstr(i);
+    Next();
+  }
+
+  if (!_abort) {
+    if (!Is("]]")) SetError("end of code block expected");
+    Next();
+  }
+
+  // every label must be defined; new labels must not clash with the existing ones
+  unordered_map<string, CTacLabel*>::const_iterator it;
+  for (it=_labels.begin(); !_abort && (it!=_labels.end()); it++) {
+    if (defined.count(it->second) == 0) {
+      SetError("undefined label '" + it->first + "'");
+    }
+    if (isdigit(it->first[0])) {
+      unsigned int id = strtoul(it->first.c_str(), NULL, 10);
+      if (id >= s->_label_id) s->_label_id = id+1;
+    }
+  }
+
+  CTacArena::SetCurrent(prev);
+}
+
+CTacInstr* CTacParser::instruction(CScope *s)
+{
+  //
+  // instruction ::= id ":" ( label ":"
+  //                        | "if" operand relop operand "goto" label
+  //                        | "goto" label
+  //                        | "phi" operand "<-" phiarg { "," phiarg }
+  //                        | op [ [operand "<-"] operand ["," operand] ] ).
+  // phiarg      ::= ("?" | operand) "(" (label | "entry") ")".
+  //
+  const string &l = _lines[_cur];
+
+  // the instruction ids are reassigned
+  _pos = 0;
+  while (!AtEnd() && isdigit(l[_pos])) _pos++;
+  if (!Consume(":")) return NULL;
+  Skip();
+
+  string w = Word(" ");
+  Skip();
+
+  if (AtEnd() && (w.size() > 1) && (w[w.size()-1] == ':')) {
+    return label(w.substr(0, w.size()-1));
+  }
+
+  if (w == "if") {
+    CTacAddr *src1 = operand(s);
+    Skip();
+    string rel = Word(" ");
+    Skip();
+    CTacAddr *src2 = operand(s);
+    Skip();
+    Consume("goto ");
+    string target = Word(" ");
+    if (_abort) return NULL;
+
+    unordered_map<string, EOperation>::const_iterator op = _ops.find(rel);
+    if ((op == _ops.end()) || !IsRelOp(op->second)) {
+      SetError("relational operator expected");
+      return NULL;
+    }
+
+    return new CTacInstr(op->second, label(target), src1, src2);
+  }
+
+  unordered_map<string, EOperation>::const_iterator op = _ops.find(w);
+  if ((op == _ops.end()) || (op->second == opLabel) || IsRelOp(op->second)) {
+    SetError("unknown operation '" + w + "'");
+    return NULL;
+  }
+
+  if (op->second == opGoto) {
+    string target = Word(" ");
+    if (!AtEnd()) SetError("end of instruction expected");
+    if (_abort) return NULL;
+
+    return new CTacInstr(opGoto, label(target));
+  }
+
+  if (op->second == opPhi) {
+    CTacAddr *dst = operand(s);
+    Skip();
+    Consume("<-");
+
+    vector<CTacAddr*> args;
+    vector<CTacLabel*> preds;
+    do {
+      Skip();
+      args.push_back(Accept("?") ? NULL : operand(s));
+      Skip();
+      Consume("(");
+      string pred = Word(")");
+      Consume(")");
+      preds.push_back(pred == "entry" ? NULL : label(pred));
+    } while (Accept(","));
+    if (!_abort && !AtEnd()) SetError("end of instruction expected");
+    if (_abort) return NULL;
+
+    CTacPhi *phi = new CTacPhi(dst, args.size());
+    for (size_t i=0; i<args.size(); i++) {
+      phi->SetArg(i, args[i]);
+      phi->SetPred(i, preds[i]);
+    }
+    return phi;
+  }
+
+  CTacAddr *dst = NULL, *src1 = NULL, *src2 = NULL;
+  if (!AtEnd()) {
+    src1 = operand(s);
+    Skip();
+    if (Accept("<-")) {
+      Skip();
+      dst = src1;
+      src1 = operand(s);
+      Skip();
+    }
+    if (Accept(",")) {
+      Skip();
+      src2 = operand(s);
+    }
+  }
+  if (!_abort && !AtEnd()) SetError("end of instruction expected");
+  if (_abort) return NULL;
+
+  return new CTacInstr(op->second, dst, src1, src2);
+}
+
+CTacAddr* CTacParser::operand(CScope *s)
+{
+  //
+  // operand ::= number type | "@" temp | temp | name.
+  //
+  if (_abort) return NULL;
+  if (AtEnd()) {
+    SetError("operand expected");
+    return NULL;
+  }
+
+  const string &l = _lines[_cur];
+  size_t b = _pos;
+
+  if (isdigit(l[b]) || ((l[b] == '-') && (b+1 < l.size()) && isdigit(l[b+1]))) {
+    string num = Word(" ");
+    long long v = strtoll(num.c_str(), NULL, 10);
+    Skip();
+    const CType *t = type();
+    if (_abort) return NULL;
+
+    return s->GetCodeBlock()->CreateConst(v, t);
+  }
+
+  bool ref = Accept("@");
+  string name = Word(" ,");
+  if (name.empty()) {
+    SetError("operand expected");
+    return NULL;
+  }
+
+  // a temporary hides a symbol of the same name
+  if ((name.size() > 1) && (name[0] == 't') &&
+      (name.find_first_not_of("0123456789", 1) == string::npos)) {
+    unsigned long id = strtoul(name.c_str()+1, NULL, 10);
+    if (id < s->GetTemps().size()) {
+      CTacTemp *t = s->GetTemps()[id];
+      if (ref) return new CTacReference(t, NULL);
+      else return t;
+    }
+  }
+
+  if (ref) {
+    SetError("temporary expected");
+    return NULL;
+  }
+
+  const CSymbol *sym = s->GetSymbolTable()->FindSymbol(name, sGlobal);
+  if (sym == NULL) {
+    SetError("undefined symbol '" + name + "'");
+    return NULL;
+  }
+
+  return new CTacName(sym);
+}
+
+CTacLabel* CTacParser::label(const string name)
+{
+  CTacLabel *&l = _labels[name];
+  if (l == NULL) l = new CTacLabel(name);
+
+  return l;
+}
+
+const CType* CTacParser::type(void)
+{
+  //
+  // type ::= "<" ("NULL" | "boolean" | "char" | "integer" | "longint") ">"
+  //        | "<" "ptr(" size ") to " ("void" | type) ">"
+  //        | "array" [" " nelem " "] "of " type ">".
+  //
+  CTypeManager *tm = CTypeManager::Get();
+
+  if (Accept("<")) {
+    if (Accept("NULL>")) return tm->GetNull();
+    if (Accept("boolean>")) return tm->GetBool();
+    if (Accept("char>")) return tm->GetChar();
+    if (Accept("integer>")) return tm->GetInteger();
+    if (Accept("longint>")) return tm->GetLongint();
+
+    if (Accept("ptr(")) {
+      Word(")");
+      Consume(") to ");
+      const CType *base = Accept("void") ? tm->GetNull() : type();
+      Consume(">");
+      if (_abort) return NULL;
+
+      return tm->GetPointer(base);
+    }
+  } else if (Accept("array")) {
+    unsigned int nelem = CArrayType::OPEN;
+    if (!Accept("of ")) {
+      Consume(" ");
+      nelem = strtoul(Word(" ").c_str(), NULL, 10);
+      Consume(" of ");
+    }
+    const CType *inner = type();
+    Consume(">");
+    if (_abort) return NULL;
+
+    return tm->GetArray(nelem, inner);
+  }
+
+  SetError("type expected");
+  return NULL;
+}
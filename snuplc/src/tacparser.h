@@ -0,0 +1,156 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL TAC reader
+///
+/// rebuilds a module from the textual form of its three-address code (.tac files)
+///
+/// @section license_section License
+/// Copyright (c) 2012-2020, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING,  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+
+#ifndef __SnuPL_TACPARSER_H__
+#define __SnuPL_TACPARSER_H__
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ir.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief TAC reader
+///
+/// parses a module in the format of CModule::print() (as written by snuplc --tac) and rebuilds
+/// its scopes, symbol tables, temporaries and code blocks, so that passes and the backend can be
+/// run on captured IR without the front end. Lines before the module (the file name) are skipped
+/// and the instruction ids are reassigned.
+///
+/// The format does not record everything; the reader resolves the gaps as follows:
+///   - procedures without a subscope are external. Their parameters are unnamed.
+///   - parameters are ordered as in the procedure header ("[[ procedure: f(a,b)"). Parameters
+///     missing there are numbered in the order they are listed in the symbol table.
+///   - an operand "tN" denotes the temporary tN if the scope has one, and the symbol tN otherwise.
+///   - branch targets and phi predecessors are labels; "(entry)" is the entry of the block.
+///   - locations other than those of globals are not restored (the backend assigns them).
+///
+
+class CTacParser {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor
+    /// @param in input stream
+    CTacParser(istream *in);
+
+    /// @}
+
+    /// @brief parse a module
+    /// @retval CModule module (owned by the caller), or NULL on error
+    CModule* Parse(void);
+
+    /// @name error handling
+    ///@{
+
+    /// @brief indicates whether there was an error while parsing the input
+    bool HasError(void) const { return _abort; };
+
+    /// @brief returns the line number of the error
+    int GetErrorLine(void) const { return _error_line; };
+
+    /// @brief returns a human-readable error message
+    string GetErrorMessage(void) const { return _message; };
+
+    ///@}
+
+  private:
+    /// @brief sets the current line as the location of an error along with a message
+    /// @param message human-readable error message
+    void SetError(const string message);
+
+    /// @name line cursor
+    /// @{
+
+    /// @brief returns true if there is a current line
+    bool More(void) const { return _cur < _lines.size(); };
+
+    /// @brief advance to the next line
+    void Next(void);
+
+    /// @brief returns true if the current line equals @a text
+    bool Is(const string text) const;
+
+    /// @brief returns true if the current line starts with @a text
+    bool StartsWith(const string text) const;
+
+    /// @brief consume @a text at the cursor
+    /// @retval true if @a text has been consumed
+    bool Accept(const string text);
+
+    /// @brief consume @a text at the cursor or set an error
+    bool Consume(const string text);
+
+    /// @brief consume blanks at the cursor
+    void Skip(void);
+
+    /// @brief consume and return the text at the cursor up to one of the characters in @a stop
+    string Word(const string stop);
+
+    /// @brief returns true if the cursor is at the end of the current line
+    bool AtEnd(void) const { return _pos >= _lines[_cur].size(); };
+
+    /// @}
+
+    /// @name methods for recursive-descent parsing
+    /// @{
+
+    CModule*          module(void);
+    CProcedure*       procedure(CScope *parent);
+    void              symtab(CSymtab *st, const vector<string> &names=vector<string>());
+    CDataInitializer* data(const CType *type);
+    void              temporaries(CScope *s);
+    void              codeblock(CScope *s);
+    CTacInstr*        instruction(CScope *s);
+    CTacAddr*         operand(CScope *s);
+    CTacLabel*        label(const string name);
+    const CType*      type(void);
+
+    /// @}
+
+    vector<string> _lines;           ///< non-empty lines of the input (without indentation)
+    vector<int>    _lineno;          ///< line numbers of _lines
+    size_t         _cur;             ///< current line
+    size_t         _pos;             ///< cursor in the current line
+    bool           _abort;           ///< error flag
+    int            _error_line;      ///< line of the error
+    string         _message;         ///< error message
+
+    unordered_map<string, EOperation> _ops;  ///< operations by name
+    unordered_map<string, CTacLabel*> _labels; ///< labels of the current code block
+    map<string, pair<CSymProc*, vector<const CType*> > > _procs; ///< declared procedures
+                                     ///< without a scope (yet) and their parameter types
+};
+
+#endif // __SnuPL_TACPARSER_H__
@@ -37,6 +37,10 @@
 #include "scanner.h"
 #include "parser.h"
 #include "ir.h"
+#include "cfg.h"
+#include "dataflow.h"
+#include "ssa.h"
+#include "pass.h"
 using namespace std;
 
 int main(int argc, char *argv[])
@@ -92,6 +96,36 @@ int main(int argc, char *argv[])
         cout << m << endl;
         cout << endl;
 
+        // print control flow graphs and data-flow analyses to console
+        vector<CScope*> scopes(1, m);
+        scopes.insert(scopes.end(), m->GetSubscopes().begin(), m->GetSubscopes().end());
+        for (size_t p=0; p<scopes.size(); p++) {
+          CCfg cfg(scopes[p]->GetCodeBlock());
+          cout << cfg << endl
+               << CLiveness(&cfg) << CReachingDefs(&cfg) << CAvailableExprs(&cfg) << endl;
+        }
+        cout << endl;
+
+        // convert each code block into SSA form and back
+        for (size_t p=0; p<scopes.size(); p++) {
+          CCodeBlock *cb = scopes[p]->GetCodeBlock();
+
+          ConstructSSA(cb);
+          cout << "SSA form:" << endl << cb << endl;
+          DestructSSA(cb);
+          cout << "out of SSA form:" << endl << cb << endl;
+        }
+        cout << endl;
+
+        // run the -O2 pipeline on all code blocks
+        CPassManager pm;
+        pm.AddPasses(2);
+        pm.Run(m);
+        for (size_t p=0; p<scopes.size(); p++) {
+          cout << "optimized (-O2):" << endl << scopes[p]->GetCodeBlock() << endl;
+        }
+        cout << endl;
+
         // output TAC as .dot and generate a PDF file from it
         ofstream out(string(fn) + ".dot");
         out << "digraph IR {" << endl
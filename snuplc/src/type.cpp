@@ -42,7 +42,7 @@ using namespace std;
 // CType
 //
 CType::CType(const string name)
-  : _name(name)
+  : _name(name), _id(0)
 {
 }
 
@@ -55,11 +55,6 @@ unsigned int CType::GetDataSize(void) const
   return GetSize();
 }
 
-bool CType::Compare(const CType *t) const
-{
-  return Match(t);
-}
-
 ostream& operator<<(ostream &out, const CType &t)
 {
   return t.print(out);
@@ -222,27 +217,6 @@ bool CPointerType::Match(const CType *t) const
 	return match;
 }
 
-bool CPointerType::Compare(const CType *t) const
-{
-	// Check if t is a pointer or not
-	if (t->IsNull())
-		return false;
-	if (!t->IsPointer())
-		return false;
-
-	bool match = false;
-	const CPointerType *pointer = dynamic_cast<const CPointerType*>(t);
-
-	if (pointer->IsNull())
-		return false;
-
-	if (GetBaseType()->IsNull())
-		match = true;
-	if (GetBaseType()->Compare(pointer))
-		match = true;
-	return match;
-}
-
 ostream& CPointerType::print(ostream &out, int indent) const
 {
   string ind(indent, ' ');
@@ -262,6 +236,17 @@ CArrayType::CArrayType(int nelem, const CType *innertype)
 {
   assert((_nelem > 0) || (_nelem == OPEN));
   assert(_innertype != NULL);
+
+  // types are immutable; compute the recursive properties once
+  if (_innertype->IsArray()) {
+    const CArrayType *a = dynamic_cast<const CArrayType*>(_innertype);
+    _basetype = a->GetBaseType();
+    _ndim = a->GetNDim() + 1;
+  } else {
+    _basetype = _innertype;
+    _ndim = 1;
+  }
+  _datasize = _nelem == OPEN ? 0 : _nelem*_innertype->GetDataSize();
 }
 
 CArrayType::~CArrayType(void)
@@ -277,8 +262,7 @@ unsigned int CArrayType::GetSize(void) const
 
 unsigned int CArrayType::GetDataSize(void) const
 {
-  unsigned int n = GetNElem();
-  return n == OPEN ? 0 : n*GetInnerType()->GetDataSize();
+  return _datasize;
 }
 
 unsigned int CArrayType::GetAlign(void) const
@@ -287,24 +271,6 @@ unsigned int CArrayType::GetAlign(void) const
   return 4;
 }
 
-const CType* CArrayType::GetBaseType(void) const
-{
-  const CType *t = GetInnerType();
-  assert(t != NULL);
-
-  if (t->IsArray()) return dynamic_cast<const CArrayType*>(t)->GetBaseType();
-  else return t;
-}
-
-unsigned int CArrayType::GetNDim(void) const
-{
-  const CType *t = GetInnerType();
-  assert(t != NULL);
-
-  if (t->IsArray()) return dynamic_cast<const CArrayType*>(t)->GetNDim() + 1;
-  else return 1;
-}
-
 bool CArrayType::Match(const CType *t) const
 {
 	// TODO: Recursivity
@@ -322,20 +288,6 @@ bool CArrayType::Match(const CType *t) const
 	return false;
 }
 
-bool CArrayType::Compare(const CType *t) const
-{
-	// TODO: Recursivity
-	if (!t->IsArray())
-		return false;
-	const CArrayType *array = dynamic_cast<const CArrayType*>(t);
-	if (array->IsNull())
-		return false;
-
-	if (GetNElem()==array->GetNElem())
-		return true;
-	return false;
-}
-
 ostream& CArrayType::print(ostream &out, int indent) const
 {
   string ind(indent, ' ');
@@ -356,6 +308,7 @@ ostream& CArrayType::print(ostream &out, int indent) const
 CTypeManager* CTypeManager::_global_tm = NULL;
 
 CTypeManager::CTypeManager(void)
+  : _concurrent(false)
 {
   _null = new CNullType();
   _boolean = new CBoolType();
@@ -365,6 +318,14 @@ CTypeManager::CTypeManager(void)
   _voidptr = new CPointerType(_null);
   _ptr.push_back(_voidptr);
 
+  AddType(_null);
+  AddType(_boolean);
+  AddType(_char);
+  AddType(_integer);
+  AddType(_longint);
+  AddType(_voidptr);
+  _ptr_map[_null->GetID()] = _voidptr;
+
   unsigned int bits = 8*CEnvironment::Get()->GetTarget()->GetMachineWordSize();
   if (bits == 32) _register = _integer;
   else if (bits == 64) _register = _longint;
@@ -426,16 +387,28 @@ const CPointerType* CTypeManager::GetVoidPtr(void) const
   return _voidptr;
 }
 
+const CType* CTypeManager::GetType(unsigned int id) const
+{
+  return id < _types.size() ? _types[id] : NULL;
+}
+
+void CTypeManager::AddType(CType *t)
+{
+  t->_id = _types.size();
+  _types.push_back(t);
+}
+
 const CPointerType* CTypeManager::GetPointer(const CType *basetype)
 {
-  for (size_t i=0; i<_ptr.size(); i++) {
-    if ((_ptr[i]->GetBaseType()->Compare(basetype))) {
-      return _ptr[i];
-    }
-  }
+  unique_lock<mutex> guard(_lock, defer_lock);
+  if (_concurrent) guard.lock();
 
-  CPointerType *p = new CPointerType(basetype);
-  _ptr.push_back(p);
+  CPointerType *&p = _ptr_map[basetype->GetID()];
+  if (p == NULL) {
+    p = new CPointerType(basetype);
+    _ptr.push_back(p);
+    AddType(p);
+  }
 
   return p;
 }
@@ -445,12 +418,12 @@ const CArrayType* CTypeManager::GetArray(unsigned int nelem,
 {
   if (innertype == NULL) return NULL;
 
-  for (size_t i=0; i<_array.size(); i++) {
-    if ((_array[i]->GetNElem() == nelem) &&
-        (_array[i]->GetInnerType()->Compare(innertype))) {
-      return _array[i];
-    }
-  }
+  unique_lock<mutex> guard(_lock, defer_lock);
+  if (_concurrent) guard.lock();
+
+  unsigned long long key = ((unsigned long long)innertype->GetID() << 32) | nelem;
+  unordered_map<unsigned long long, CArrayType*>::const_iterator it = _array_map.find(key);
+  if (it != _array_map.end()) return it->second;
 
   unsigned long long size = innertype->GetDataSize();
   if (nelem != CArrayType::OPEN) size = size * nelem + 8;
@@ -459,6 +432,8 @@ const CArrayType* CTypeManager::GetArray(unsigned int nelem,
 
   CArrayType *a = new CArrayType(nelem, innertype);
   _array.push_back(a);
+  _array_map[key] = a;
+  AddType(a);
 
   return a;
 }
@@ -35,6 +35,8 @@
 
 #include <climits>
 #include <iostream>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 using namespace std;
 
@@ -46,6 +48,7 @@ using namespace std;
 ///
 class CType {
   friend class CArrayType;
+  friend class CTypeManager;
 
   protected:
     /// @brief constructor
@@ -60,6 +63,15 @@ class CType {
     /// @retval string name of type
     virtual string GetName(void) const { return _name; };
 
+    /// @brief get the type id
+    ///
+    /// Types are hash-consed by the type manager: every distinct type exists exactly once and
+    /// is numbered consecutively in the order of creation. Two types are identical if and only
+    /// if their ids (or addresses) are equal.
+    ///
+    /// @retval unsigned int type id
+    unsigned int GetID(void) const { return _id; };
+
     /// @brief return @a true for the NULL type, @a false otherwise
     virtual bool IsNull(void) const { return false; };
 
@@ -126,10 +138,13 @@ class CType {
     virtual bool Match(const CType *t) const = 0;
 
     /// @brief compare two types. Returns true if the types are identical
+    ///
+    /// Since types are hash-consed, identical types are the same object.
+    ///
     /// @param t type to compare this type to
     /// @retval true if the types are identical
     /// @retval false if the types are not identical
-    virtual bool Compare(const CType *t) const;
+    bool Compare(const CType *t) const { return t == this; };
 
     /// @}
 
@@ -141,6 +156,7 @@ class CType {
 
   private:
     string         _name;         ///< name
+    unsigned int   _id;           ///< type id (assigned by the type manager)
 
 };
 
@@ -468,16 +484,6 @@ class CPointerType : public CScalarType {
     /// @retval false if the types do not match (are not compatible)
     virtual bool Match(const CType *t) const;
 
-    /// @brief compare two pointer types
-    ///
-    /// CPointerType::Compare() is identical to Match() but does not support
-    /// pointers to open arrays.
-    ///
-    /// @param t type to compare this type to
-    /// @retval true if the types are equal
-    /// @retval false if the types are not equal
-    virtual bool Compare(const CType *t) const;
-
     /// @}
 
     /// @brief print the type to an output stream
@@ -539,7 +545,7 @@ class CArrayType : public CType {
 
     /// @brief return the base type
     /// @retval CType* base type
-    const CType* GetBaseType(void) const;
+    const CType* GetBaseType(void) const { return _basetype; };
 
     /// @brief return the element count
     /// @retval int element count
@@ -547,7 +553,7 @@ class CArrayType : public CType {
 
     /// @brief return the dimensions of this array
     /// @retval int number of dimensions
-    unsigned int GetNDim(void) const;
+    unsigned int GetNDim(void) const { return _ndim; };
 
     /// @}
 
@@ -568,16 +574,6 @@ class CArrayType : public CType {
     /// @retval false if the types do not match (are not compatible)
     virtual bool Match(const CType *t) const;
 
-    /// @brief compare two array types
-    ///
-    /// CArrayType::Compare() is identical to Match() but does not support
-    /// open arrays.
-    ///
-    /// @param t type to compare this type to
-    /// @retval true if the types are equal
-    /// @retval false if the types are not equal
-    virtual bool Compare(const CType *t) const;
-
     /// @}
 
     /// @brief print the type to an output stream
@@ -589,19 +585,29 @@ class CArrayType : public CType {
   private:
     unsigned int   _nelem;        ///< element count or OPEN for open arrays
     const CType   *_innertype;    ///< inner type
+    const CType   *_basetype;     ///< base type (innermost element type)
+    unsigned int   _ndim;         ///< number of dimensions
+    unsigned int   _datasize;     ///< data size (types are immutable)
 };
 
 
 //--------------------------------------------------------------------------------------------------
 /// @brief type manager
 ///
-/// manages all types in a module
+/// manages all types in a module. Composite types are hash-consed by their structure (kind,
+/// element count, id of the inner type), so GetPointer() and GetArray() run in constant time
+/// and return the same object for structurally identical types.
 ///
 class CTypeManager {
   public:
     /// @brief return the global type manager
     static CTypeManager* Get(void);
 
+    /// @brief enable/disable locking for concurrent creation of composite types
+    ///
+    /// @param concurrent true: GetPointer() and GetArray() may be called from several threads
+    void SetConcurrent(bool concurrent) { _concurrent = concurrent; };
+
     /// @name base types
     /// @{
 
@@ -631,6 +637,20 @@ class CTypeManager {
 
     /// @}
 
+    /// @name type ids
+    /// @{
+
+    /// @brief return the number of types
+    unsigned int GetNumTypes(void) const { return _types.size(); };
+
+    /// @brief return the type with id @a id
+    ///
+    /// @param id type id
+    /// @retval CType* type or NULL if no such type exists
+    const CType* GetType(unsigned int id) const;
+
+    /// @}
+
     /// @brief print all types to an output stream
     ///
     /// @param out output stream
@@ -646,6 +666,9 @@ class CTypeManager {
 
     /// @}
 
+    /// @brief register a new type and assign its id
+    void AddType(CType *t);
+
     CNullType     *_null;         ///< null base type
     CBoolType     *_boolean;      ///< boolean base type
     CCharType     *_char;         ///< char base type
@@ -656,6 +679,15 @@ class CTypeManager {
 
     vector<CPointerType*> _ptr;   ///< pointer types
     vector<CArrayType*> _array;   ///< array types
+    vector<const CType*> _types;  ///< all types by id
+
+    /// pointer types by id of the base type
+    unordered_map<unsigned int, CPointerType*> _ptr_map;
+    /// array types by id of the inner type (upper 32 bits) and element count (lower 32 bits)
+    unordered_map<unsigned long long, CArrayType*> _array_map;
+
+    bool           _concurrent;   ///< lock in GetPointer()/GetArray()
+    mutex          _lock;         ///< lock for concurrent type creation
 
     static CTypeManager *_global_tm; ///< global type manager instance
 };
@@ -0,0 +1,34 @@
+//
+// test10
+//
+// control flow graph: nested loops
+//
+
+module test10;
+
+var i, j, s: integer;
+
+begin
+  i := 0;
+  s := 0;
+  while (i < 10) do
+    j := 0;
+    while (j < i) do
+      if (j > 5) then
+        s := s + j
+      else
+        s := s - 1
+      end;
+      j := j + 1;
+      i := i
+    end;
+    i := i + 1;
+    s := s
+  end;
+
+  if (s > 0) then
+    s := 0
+  end;
+
+  i := 0
+end test10.
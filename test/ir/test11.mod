@@ -0,0 +1,51 @@
+//
+// test11
+//
+// SSA form: local variables and parameters in loops and conditionals
+//
+
+module test11;
+
+var r: integer;
+
+function gcd(a, b: integer): integer;
+begin
+  while (a # b) do
+    if (a > b) then
+      a := a - b
+    else
+      b := b - a;
+      r := b
+    end;
+    r := a
+  end;
+  return a;
+  r := 0
+end gcd;
+
+function sum(n: integer): integer;
+var i, j, s, t: integer;
+begin
+  i := 0;
+  s := 0;
+  t := 1;
+  while (i < n) do
+    j := 0;
+    while (j < i) do
+      s := s + j;
+      t := s;
+      s := t;
+      j := j + 1;
+      r := j
+    end;
+    i := i + 1;
+    r := i
+  end;
+  return s + t;
+  r := 0
+end sum;
+
+begin
+  r := gcd(12, 18) + sum(5);
+  r := 0
+end test11.
@@ -0,0 +1,37 @@
+//
+// test12
+//
+// optimization: constant expressions, copies, dead code and constant branches
+//
+
+module test12;
+
+const
+    K: integer = 4;
+
+var r: integer;
+    b: boolean;
+
+function f(a: integer): integer;
+var x, y, z: integer;
+begin
+  x := 2 * K + 1;
+  y := x;
+  z := y * 1 + 0;
+  if (x > 3) then
+    a := a + z
+  else
+    a := a - z
+  end;
+  y := a * 0;
+  return a;
+  r := 0
+end f;
+
+begin
+  b := (1 + 2 = 3) && (K > 2);
+  if (b) then
+    r := f(10 / 2 - K)
+  end;
+  r := 0
+end test12.